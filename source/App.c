@@ -14,29 +14,130 @@
 
 #include <stdio.h>
 //#include <stdlib.h>
-//#include <string.h>
+#include <string.h>
 
 #include "adc.h"
 #include "board.h"
+#include "dac.h"
 #include "debug.h"
 #include "macros.h"
+#include "modem.h"
+#include "pdb.h"
+#include "prof.h"
+#include "protocol.h"
+#include "scheduler.h"
+#include "scope.h"
 #include "serial.h"
+#include "stream.h"
 #include "timer.h"
+#include "trace.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
 
+#define CAPTURE_LEVEL	100														// Carrier envelope, LSB
+#define CAPTURE_PRE		512
+#define CAPTURE_POST	1536
+
+#define BRIDGE_MS		10														// UART polled for bytes to send
+#define BRIDGE_CHUNK	64
+#define BRIDGE_TAG		0xE0													// Modem bytes, framed like the stream and scope ones
+#define BRIDGE_FRAME	(PROTOCOL_COBS_SIZE(1 + BRIDGE_CHUNK + PROTOCOL_CRC_SIZE) + 1)
+
+#define COMMAND_PREFIX	'!'														// Frames starting with it are for the board, not the modem
+#define DUMP_SIZE		(sizeof(trace_header_t) + TRACE_RECORDS * sizeof(trace_record_t))	// The whole trace, or the profiling text
+#define IS_COMMAND(msg, len, text)	(((len) == sizeof(text) - 1) && !memcmp((msg), (text), sizeof(text) - 1))
+
+_Static_assert(PDB_FREQUENCY_HZ == MODEM_SAMPLE_HZ, "The modem runs on every ADC conversion");
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+enum {																			// Task priorities, higher runs first
+	TASK_SCOPE,
+	TASK_STREAM,
+	TASK_TIMER,
+	TASK_MODEM
+};
+
 /*******************************************************************************
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
-static ticks_t tim_adc;
+static wheel_timer_t bridge_timer;
+static uchar_t outgoing[BRIDGE_FRAME];											// Modem bytes for the host, one frame at a time
+static size_t outgoing_len;														// Packed, not taken by the UART yet
+static volatile bool outgoing_busy;												// outgoing is being sent
+static const uchar_t* incoming;													// Frame from the host, held until the modem took it all
+static uint32_t incoming_len, incoming_sent;
+static bool incoming_held;
+static char dump[DUMP_SIZE];
+static volatile bool dumping;													// dump is being sent
 
 /*******************************************************************************
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
+/**
+ * @brief ADC conversion complete, from the ADC interrupt
+ */
+static void sampleReady (void);
+
+/**
+ * @brief The stream has blocks or free frames, from the ADC or serial interrupts
+ */
+static void streamReady (void);
+
+/**
+ * @brief The snapshot is complete or a frame is out, from the ADC or serial interrupts
+ */
+static void scopeReady (void);
+
+/**
+ * @brief The modem has events to run, from the ADC interrupt or the main loop
+ */
+static void modemReady (void);
+
+/**
+ * @brief Timers expired, from the tick interrupt
+ */
+static void timerReady (void);
+
+/**
+ * @brief Move bytes between the UART and the modem, every BRIDGE_MS
+ * @param arg Unused
+ */
+static void bridge (void* arg);
+
+/**
+ * @brief Modem bytes are out, from the serial interrupt
+ * @param data Frame sent
+ */
+static void bridged (const uchar_t* data);
+
+/**
+ * @brief Run a command from the serial port: "!prof" dumps the profiling zones, "!trace" the event
+ *        trace (binary, see trace.h), "!prof reset" and "!trace reset" clear them
+ * @param msg Command, not NUL terminated
+ * @param len Command length
+ */
+static void command (const uchar_t* msg, uint8_t len);
+
+/**
+ * @brief A dump is out, from the serial interrupt
+ * @param data Dump sent
+ */
+static void dumped (const uchar_t* data);
+
+/**
+ * @brief Send the trace out on a fault, polled
+ * @param data Bytes
+ * @param len Number of bytes
+ */
+static void faultWrite (const uint8_t* data, uint32_t len);
+
 /*******************************************************************************
  *******************************************************************************
                         GLOBAL FUNCTION DEFINITIONS
@@ -49,15 +150,30 @@ static ticks_t tim_adc;
  */
 void App_Init (void)
 {
+	profInit();																	// Before anything that runs a zone
+	traceInit(faultWrite);
+
 	ADC_Init(ADC0_ID, (adc_cfg_t){ ADC_TRIGG_PDB, ADC_PSC_x1, ADC_BITS_12, true, ADC_CYCLES_24, ADC_TAPS_8, false });
-	ADC_Start(ADC0_ID, (adc_cfg_ch_t){ ADC_MUX_A, true, false, 0, NULL });
+
+	schedInit();
+	schedRegister(TASK_STREAM, streamUpdate);
+	schedRegister(TASK_SCOPE, scopeUpdate);
+	schedRegister(TASK_TIMER, timerUpdate);
+	schedRegister(TASK_MODEM, modemUpdate);
 
 	serialInit();
+	DAC_Init();
+	modemInit(&(modem_cfg_t){ 20, 10, 5, 150, 75, 1000 }, modemReady);	// Preamble, turnaround, qualify (ms), carrier on, off (LSB), amplitude
+	streamInit(STREAM_AUTO, streamReady);
+	scopeInit(scopeReady);
+	scopeArm(&(scope_cfg_t){ SCOPE_TRIGG_CARRIER, CAPTURE_LEVEL, 0, CAPTURE_PRE, CAPTURE_POST, false });	// First burst on the line
+
+	ADC_Start(ADC0_ID, (adc_cfg_ch_t){ ADC_MUX_A, true, false, 0, sampleReady });	// Every conversion goes to the stream
 
 //	debugInit();
 
-	timerInit();
-	tim_adc = timerStart(TIMER_MS2TICKS(1000));
+	timerInit(timerReady);
+	timerEvery(&bridge_timer, TIMER_MS2TICKS(BRIDGE_MS), bridge, NULL);
 }
 
 //void ADC_PISR (void);
@@ -68,33 +184,132 @@ void App_Init (void)
  */
 void App_Run (void)
 {
-	static adc_mux_t mux = ADC_MUX_A;
-	char raw[30];
-	adc_data_t data = 0;
-	uint8_t len = 0;
+	schedDispatch();															// One task, or sleep until an interrupt posts one
+}
 
-	// ADC_Start(ADC0_ID, ADC_MUX_A, true, false, 0, NULL);
+/*******************************************************************************
+ *******************************************************************************
+                        LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void sampleReady (void)
+{
+	adc_data_t sample = ADC_GetData(ADC0_ID, ADC_MUX_A);
+
+	modemSample(sample);
+	DAC_SetData(DAC0, modemOutput());
+	streamPush(sample);
+	scopePush(sample);
+}
+
+static void streamReady (void)
+{
+	schedPost(TASK_STREAM);
+}
+
+static void scopeReady (void)
+{
+	schedPost(TASK_SCOPE);
+}
+
+static void modemReady (void)
+{
+	schedPost(TASK_MODEM);
+}
+
+static void timerReady (void)
+{
+	schedPost(TASK_TIMER);
+}
+
+static void bridge (void* arg)
+{
+	static const uchar_t delim = SERIAL_FRAME_DELIM;
+	uchar_t payload[1 + BRIDGE_CHUNK];
+	uint16_t count;
+
+	(void)arg;
+
+	/* Modem to host: read only what the next frame can carry, once the last one is out */
+	if (!outgoing_busy && !outgoing_len && (count = modemRead(payload + 1, BRIDGE_CHUNK)))
+	{
+		payload[0] = BRIDGE_TAG;
+		outgoing_len = protocolPackBytes(payload, 1 + count, outgoing);
+	}
+	if (outgoing_len)
+	{
+		outgoing_busy = true;
+		if (serialWriteFrame(outgoing, outgoing_len, bridged))
+			outgoing_len = 0;
+		else
+			outgoing_busy = false;												// No descriptor free, tried again next time
+	}
 
-	if(timerExpired(tim_adc) && ADC_IsReady(ADC0_ID, mux))
+	/* Host to modem: the frame stays in the ring until the modem queued all of it */
+	if (!incoming_held && serialReadFrame(&incoming, &incoming_len))
+	{
+		if (incoming_len && (incoming[0] == COMMAND_PREFIX))
+		{
+			command(incoming, incoming_len);
+			serialReleaseFrame();
+		}
+		else
+		{
+			incoming_sent = 0;
+			incoming_held = true;
+		}
+	}
+	if (incoming_held)
 	{
-		data = ADC_GetData(ADC0_ID, mux);
-		len = sprintf(raw, "%d\n", data);
+		incoming_sent += modemWrite(incoming + incoming_sent, incoming_len - incoming_sent);	// Sent once the line is free
+		if ((incoming_sent == incoming_len) && ((incoming_len == SERIAL_FRAME_MAX) || modemWrite(&delim, 1)))	// Shorter ones ended with the delimiter
+		{
+			serialReleaseFrame();
+			incoming_held = false;
+		}
+	}
+}
 
-		// serialWriteData((uchar_t*)&raw, sizeof(raw));
-		serialWriteDataBlocking((uchar_t*)&raw, len);
+static void bridged (const uchar_t* data)
+{
+	(void)data;
+	outgoing_busy = false;
+}
 
-		tim_adc = timerStart(TIMER_MS2TICKS(1));
+static void command (const uchar_t* msg, uint8_t len)
+{
+	size_t size = 0;
 
-		mux = (mux + 1) % ADC_CANT_MUXS;
-		ADC_Start(ADC0_ID, (adc_cfg_ch_t){ mux, true, false, 0, NULL });
+	if (IS_COMMAND(msg, len, "!prof reset"))
+		profReset();
+	else if (IS_COMMAND(msg, len, "!trace reset"))
+		traceReset();
+	else if (!dumping)
+	{
+		if (IS_COMMAND(msg, len, "!prof"))
+			size = profDump(dump, sizeof(dump));
+		else if (IS_COMMAND(msg, len, "!trace"))
+			size = traceDump(dump, sizeof(dump));
+		if (size)
+		{
+			dumping = true;
+			if (!serialWriteFrame((const uchar_t*)dump, size, dumped))
+				dumping = false;
+		}
 	}
 }
 
-/*******************************************************************************
- *******************************************************************************
-                        LOCAL FUNCTION DEFINITIONS
- *******************************************************************************
- ******************************************************************************/
+static void dumped (const uchar_t* data)
+{
+	(void)data;
+	dumping = false;
+}
+
+static void faultWrite (const uint8_t* data, uint32_t len)
+{
+	serialWritePolled(data, len);
+}
 
 void updateOutgoing (void)														// Send data to the serial port
 {
@@ -19,6 +19,9 @@
 #include "macros.h"
 #include "pdb.h"
 #include "pit.h"
+#include "prof.h"
+#include "timer.h"
+#include "trace.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -28,6 +31,12 @@
 
 #define TWO_POW_NUM_OF_CAL	(1 << 4)
 
+#if TIMER_TICKLESS
+#define TRIGG_FREE(trigg)	(((trigg) < ADC_TRIGG_PIT0) || ((trigg) > ADC_TRIGG_PIT2))	// clock.c runs PIT0 to PIT2
+#else
+#define TRIGG_FREE(trigg)	true
+#endif
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
@@ -91,7 +100,7 @@ static adc_t adc[ADC_CANT_IDS];
 
 bool ADC_Init (adc_id_t id, adc_cfg_t cfg)
 {
-	if (id < ADC_CANT_IDS && adc[id].init == false)
+	if (id < ADC_CANT_IDS && adc[id].init == false && TRIGG_FREE(cfg.trigg))
 	{
 		*ADC_Clks[id].clk |= ADC_Clks[id].mask;
 		NVIC_EnableIRQ(ADC_IRQn[id]);
@@ -213,6 +222,8 @@ static void handler (adc_id_t id)
 #if DEBUG_ADC
 P_DEBUG_TP_SET
 #endif
+	PROF_BEGIN(PROF_ADC_ISR);
+	TRACE_BEGIN(TRACE_ADC, TRACE_ADC_ISR, id);
 //	adc_mux_t mux = adc[id].ch_cfg.mux;
 
 	for (adc_mux_t mux = ADC_MUX_A; mux < ADC_CANT_MUXS; mux++)
@@ -226,6 +237,8 @@ P_DEBUG_TP_SET
 
 			// PDB_SetChannelMux(PDB0_ID, (pdb_cfg_mux_t){ PDB_Channels[id], mux });
 		}
+	TRACE_END(TRACE_ADC, TRACE_ADC_ISR, id);
+	PROF_END(PROF_ADC_ISR);
 #if DEBUG_ADC
 P_DEBUG_TP_CLR
 #endif
@@ -120,6 +120,7 @@ typedef struct {
  * @brief Initialize the ADC peripheral
  * @param id ADC peripheral to be initialized
  * @param cfg Configuration for the ADC peripheral
+ * @return Initialized, false for PIT0 to PIT2 triggers while the tickless timer owns them
  */
 bool ADC_Init (adc_id_t id, adc_cfg_t cfg);
 
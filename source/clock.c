@@ -0,0 +1,135 @@
+/***************************************************************************//**
+  @file     clock.c
+  @brief    System clock: free-running 64-bit time base, and deadlines on a
+            single one-shot compare
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "clock.h"
+#include "debug.h"
+#include "hardware.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define CLOCK_MIN_COUNTS	(CLOCK_HZ / 1000000U)								// 1 us: what is closer is late already by the time it is set
+#define CLOCK_MAX_COUNTS	0xFFFFFFFFULL										// Further away wakes up early, only to set the rest
+
+_Static_assert(CLOCK_HZ % 1000000U == 0, "Whole counts per microsecond");
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Set the compare to the earliest deadline, or stop it
+ */
+static void program (void);
+
+/**
+ * @brief Compare interrupt: run what is due, set the next one
+ */
+static void clock_isr (void);
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static deadline_queue_t queue;													// Touched with interrupts masked, or from the compare one
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void clockInit (void)
+{
+	static bool init = false;
+
+	if (init)
+		return;
+
+	deadlineInit(&queue);
+	PIT_InitLifetime();
+
+	init = true;
+}
+
+uint64_t clockNow (void)
+{
+	return PIT_GetLifetime();
+}
+
+bool clockAt (deadline_t* deadline, uint64_t when, deadline_callback_t callback, void* arg)
+{
+	uint32_t primask = __get_PRIMASK();
+	bool set;
+
+	__disable_irq();
+	set = deadlineStart(&queue, deadline, when, callback, arg);
+	program();
+	__set_PRIMASK(primask);
+
+	return set;
+}
+
+bool clockCancel (deadline_t* deadline)
+{
+	uint32_t primask = __get_PRIMASK();
+	bool set;
+
+	__disable_irq();
+	set = deadlineCancel(&queue, deadline);
+	program();																	// Later, or none: at worst one early wake-up
+	__set_PRIMASK(primask);
+
+	return set;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void program (void)
+{
+	uint64_t next = deadlineNext(&queue), now, counts;
+
+	if (next == DEADLINE_NEVER)
+	{
+		PIT_Stop(CLOCK_COMPARE);
+		return;
+	}
+
+	now = clockNow();
+	counts = (next > now) ? next - now : 0;
+	if (counts < CLOCK_MIN_COUNTS)
+		counts = CLOCK_MIN_COUNTS;
+	else if (counts > CLOCK_MAX_COUNTS)
+		counts = CLOCK_MAX_COUNTS;
+	PIT_OneShot(CLOCK_COMPARE, (uint32_t)counts, clock_isr);
+}
+
+static void clock_isr (void)
+{
+#if DEBUG_CLOCK
+P_DEBUG_TP_SET
+#endif
+	deadlineExpire(&queue, clockNow());											// Callbacks may set deadlines, the ones already due run here too
+	program();
+#if DEBUG_CLOCK
+P_DEBUG_TP_CLR
+#endif
+}
+
+/******************************************************************************/
@@ -0,0 +1,74 @@
+/***************************************************************************//**
+  @file     clock.h
+  @brief    System clock: free-running 64-bit time base, and deadlines on a
+            single one-shot compare
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     Time is counted by two chained PIT channels at the bus clock and
+            never wraps. Only the earliest deadline is programmed, the core
+            is not interrupted while nothing is due.
+ ******************************************************************************/
+
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "deadline.h"
+#include "pit.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define CLOCK_HZ			PIT_CLOCK_HZ
+#define CLOCK_US2COUNTS(us)	((uint64_t)(us) * (CLOCK_HZ / 1000000U))
+#define CLOCK_COUNTS2US(c)	((c) / (CLOCK_HZ / 1000000U))
+#define CLOCK_COMPARE		PIT2_ID												// One-shot channel for the earliest deadline
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Start the time base, from 0
+ */
+void clockInit (void);
+
+/**
+ * @brief Read the time
+ * @return Counts since clockInit, CLOCK_HZ a second
+ * @note Any context
+ */
+uint64_t clockNow (void);
+
+/**
+ * @brief Call back at a time, moving the deadline if already set
+ * @param deadline Deadline, zeroed (static) before its first use
+ * @param when Time, as clockNow, right away if already past
+ * @param callback Called from the compare interrupt
+ * @param arg Callback argument
+ * @return Set, false when DEADLINE_MAX are already
+ * @note Any context
+ */
+bool clockAt (deadline_t* deadline, uint64_t when, deadline_callback_t callback, void* arg);
+
+/**
+ * @brief Drop a deadline
+ * @param deadline Deadline
+ * @return It was set
+ * @note Any context
+ */
+bool clockCancel (deadline_t* deadline);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _CLOCK_H_
@@ -13,9 +13,12 @@
  ******************************************************************************/
 
 #include <stdlib.h>
-#include <stdio.h>
+#include <string.h>
 
 #include "cqueue.h"
+#include "macros.h"
+#include "prof.h"
+#include "trace.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -23,23 +26,114 @@
 
 #define DEVELOPMENT_MODE	1
 
+// Index accesses shared between ISR and main (ldr/str + dmb on the Cortex-M4) /
+
+#define LOAD_ACQUIRE(x)			__atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(x, v)		__atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+// Statistics hooks, empty when disabled ///////////////////////////////////////
+
+#if QUEUE_STATS
+#define STATS_PUSH(id, n, req)	statsPush(id, n, req)
+#define STATS_POP(id, n, req)	statsPop(id, n, req)
+#else
+#define STATS_PUSH(id, n, req)	((void)0)
+#define STATS_POP(id, n, req)	((void)0)
+#endif
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
 /**
- * @brief Queue structure
- * @param items Data, QUEUE_MAX_SIZE elements + 1 for overflow detection
- * @param front First element, equal to rear if empty
- * @param Rear Last element, points to next empty slot or QUEUE_OVERFLOW if full
+ * @brief Queue structure (bip-buffer layout)
+ * @param items Data, size elements + 1 for overflow detection
+ * @param front First element, equal to rear if empty. Written by the consumer
+ * @param rear Next empty slot. Written by the producer
+ * @param last End of valid data while rear has wrapped behind front (watermark).
+ *        Written by the producer, before publishing the wrap
+ * @param slots Number of slots in items (size + 1)
+ * @param reserved Start of the pending reservation, producer only
+ * @param data_size Size of the data type
+ * @param heap Storage was allocated by queueInit
+ * @param stats Statistics, see queue_stats_t
+ * @param sample_seq Push count of the timestamped element
+ * @param sample_ts Timestamp of the sampled element
+ * @param sampling An element is being timestamped. Set by the producer, cleared
+ *        by the consumer, which hands sample_seq/sample_ts over between them
  */
 typedef struct {
-	data_t	items;
-	count_t	front;
-	count_t	rear;
-	count_t size;
-	uint8_t	data_size;
-} queue_t; // TODO: Use void* for data_t and count_t
+	uint8_t*			items;
+	volatile count_t	front;
+	volatile count_t	rear;
+	volatile count_t	last;
+	count_t				slots;
+	count_t				reserved;
+	uint8_t				data_size;
+	bool				heap;
+#if QUEUE_STATS
+	queue_stats_t		stats;
+	uint32_t			sample_seq;
+	uint32_t			sample_ts;
+	volatile bool		sampling;
+#endif
+} queue_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Address of a slot
+ * @param q Queue
+ * @param index Slot index
+ * @return Pointer to the slot
+ */
+static inline uint8_t* slot (queue_t* q, count_t index);
+
+/**
+ * @brief Contiguous free space at the write position, without skipping slots
+ * @param q Queue
+ * @param start Where the free region begins
+ * @return Number of free contiguous slots
+ */
+static count_t writable (queue_t* q, count_t* start);
+
+/**
+ * @brief Contiguous data at the read position
+ * @param q Queue
+ * @param start Where the data begins
+ * @return Number of contiguous elements
+ */
+static count_t readable (queue_t* q, count_t* start);
+
+/**
+ * @brief Publish n elements written from start
+ * @param q Queue
+ * @param start Start of the written region (rear or 0 if wrapped)
+ * @param n Number of elements
+ */
+static void publish (queue_t* q, count_t start, count_t n);
+
+#if QUEUE_STATS
+
+/**
+ * @brief Account a push (producer side)
+ * @param id Queue ID
+ * @param n Elements inserted
+ * @param req Elements requested
+ */
+static void statsPush (queue_id_t id, count_t n, count_t req);
+
+/**
+ * @brief Account a pop (consumer side)
+ * @param id Queue ID
+ * @param n Elements removed
+ * @param req Elements requested
+ */
+static void statsPop (queue_id_t id, count_t n, count_t req);
+
+#endif
 
 /*******************************************************************************
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
@@ -48,6 +142,10 @@ typedef struct {
 static queue_t queues[QUEUES_MAX_CANT];
 static queue_id_t ids;
 
+#if QUEUE_STATS
+static queue_clock_t stats_clock;
+#endif
+
 /*******************************************************************************
  *******************************************************************************
 						GLOBAL FUNCTION DEFINITIONS
@@ -57,98 +155,219 @@ static queue_id_t ids;
 queue_id_t queueInit (count_t size, uint8_t data_size)
 {
 	queue_id_t id = QUEUE_INVALID_ID;
+	void* storage;
 
-	printf("IDS: %d\n", ids);
-	if (ids < QUEUES_MAX_CANT)
+	if ((ids < QUEUES_MAX_CANT) && size && data_size)
 	{
-       	queues[ids].items = (data_t*)malloc(size * data_size);
-        if (queues[ids].items != NULL)
+		storage = malloc((size + 1) * data_size);
+		if (storage != NULL)
 		{
-			queueClear(ids);
-			queues[ids].size = size;
-			queues[ids].data_size = data_size;
-			printf("Size: %d\n", queues[id].data_size);
-			id = ids++;
+			id = queueInitStatic(storage, size, data_size);
+			queues[id].heap = true;
 		}
 	}
-	printf("IDS: %d\n", ids);
-	printf("ID: %d\n", id);
+
+	return id;
+}
+
+queue_id_t queueInitStatic (void* storage, count_t size, uint8_t data_size)
+{
+	queue_id_t id = QUEUE_INVALID_ID;
+
+	if ((ids < QUEUES_MAX_CANT) && (storage != NULL) && size && data_size)
+	{
+		queues[ids].items = (uint8_t*)storage;
+		queues[ids].slots = size + 1;
+		queues[ids].data_size = data_size;
+		queues[ids].heap = false;
+		queueClear(ids);
+		id = ids++;
+	}
 
 	return id;
 }
 
 void queueDelete (queue_id_t id)
 {
-    if (id < QUEUES_MAX_CANT)
+	if (id < QUEUES_MAX_CANT)
 	{
-        free(queues[id].items);
+		if (queues[id].heap)
+			free(queues[id].items);
 		ids--;
-    }
+	}
 }
 
 count_t queuePush (queue_id_t id, data_t data) // Enqueue
 {
-	count_t count = queueSize(id);
+	count_t count = QUEUE_OVERFLOW, start;
+	PROF_BEGIN(PROF_QUEUE_PUSH);
 
-	printf("Id: %d, Size: %d\n", id, queues[id].data_size);
-	if ((id < ids) && !queueIsFull(id))
+	if ((id < ids) && writable(&queues[id], &start))
 	{
-		printf("A\n");
-		// printf("Data: %d\n", ((uint8_t*)queues[id].items[queues[id].rear * queues[id].size])[0]);
-		for (size_t i = 0; i * sizeof(uint8_t) < queues[id].data_size; i++)
-		{
-			printf("Hola\n");
-			printf("Rear: %d\n", queues[id].rear);
-			printf("C: %d\n", ((uint8_t*)data)[i]);
-			printf("D: %x\n", ((uint8_t*)queues[id].items)[queues[id].rear * queues[id].data_size]);
-			((uint8_t*)queues[id].items)[queues[id].rear++ * queues[id].data_size] = ((uint8_t*)data)[i];
-			printf("D: %d\n", ((uint8_t*)queues[id].items)[(queues[id].rear-1) * queues[id].data_size]);
-			printf("Rear: %d\n", queues[id].rear);
-			// queues[id].rear++;
-		}
-		printf("Data: %d\n", ((uint8_t*)queues[id].items)[(queues[id].rear-1) * queues[id].data_size]);
-		if (queues[id].rear >= queues[id].size)
-			queues[id].rear -= queues[id].size;
-		printf("Rear: %d\n", queues[id].rear);
-		printf("Size: %d\n", queues[id].data_size);
+		memcpy(slot(&queues[id], start), data, queues[id].data_size);
+		publish(&queues[id], start, 1);
+		count = queueSize(id);
+		STATS_PUSH(id, 1, 1);
 	}
+	else if (id < ids)
+	{
+		STATS_PUSH(id, 0, 1);
+		TRACE_MARK(TRACE_QUEUE, TRACE_QUEUE_FULL, id);
+	}
+	PROF_END(PROF_QUEUE_PUSH);
 
-	return count + 1;
+	return count;
 }
 
 data_t queuePop (queue_id_t id) // Dequeue
 {
 	data_t data = QUEUE_UNDERFLOW;
+	count_t start;
+	PROF_BEGIN(PROF_QUEUE_POP);
 
-	if ((id < ids) && !queueIsEmpty(id))
+	if ((id < ids) && readable(&queues[id], &start))
 	{
-		data = queues[id].items + queues[id].front++ * queues[id].data_size;
-		printf("Holaa\n");
-		printf("Data: %d\n", *(uint8_t*)data);
-		if (queues[id].front >= queues[id].size)
-			queues[id].front -= queues[id].size;
+		data = slot(&queues[id], start);
+		STORE_RELEASE(queues[id].front, start + 1);
+		STATS_POP(id, 1, 1);
 	}
+	else if (id < ids)
+		STATS_POP(id, 0, 1);
+	PROF_END(PROF_QUEUE_POP);
 
 	return data;
 }
 
+count_t queuePushN (queue_id_t id, const void* data, count_t n)
+{
+	count_t count = 0, start, chunk;
+	PROF_BEGIN(PROF_QUEUE_PUSH);
+
+	if (id < ids)
+	{
+		queue_t* q = &queues[id];
+
+		for (uint8_t segment = 0; (segment < 2) && (count < n); segment++)	// Before and after wrapping
+		{
+			chunk = MIN(n - count, writable(q, &start));
+			memcpy(slot(q, start), (const uint8_t*)data + count * q->data_size, chunk * q->data_size);
+			publish(q, start, chunk);
+			count += chunk;
+		}
+		STATS_PUSH(id, count, n);
+		if (count < n)
+			TRACE_MARK(TRACE_QUEUE, TRACE_QUEUE_FULL, id);
+	}
+	PROF_END(PROF_QUEUE_PUSH);
+
+	return count;
+}
+
+count_t queuePopN (queue_id_t id, void* data, count_t n)
+{
+	count_t count = 0, start, chunk;
+	PROF_BEGIN(PROF_QUEUE_POP);
+
+	if (id < ids)
+	{
+		queue_t* q = &queues[id];
+
+		for (uint8_t segment = 0; (segment < 2) && (count < n); segment++)
+		{
+			chunk = MIN(n - count, readable(q, &start));
+			memcpy((uint8_t*)data + count * q->data_size, slot(q, start), chunk * q->data_size);
+			STORE_RELEASE(q->front, start + chunk);
+			count += chunk;
+		}
+		STATS_POP(id, count, n);
+	}
+	PROF_END(PROF_QUEUE_POP);
+
+	return count;
+}
+
+bool queueReserve (queue_id_t id, count_t n, data_t* ptr)
+{
+	bool status = false;
+
+	if ((id < ids) && n)
+	{
+		queue_t* q = &queues[id];
+		count_t front = LOAD_ACQUIRE(q->front), rear = q->rear;
+
+		if (queueSize(id) + n < q->slots)										// Capacity is size, not slots
+		{
+			if (rear < front)													// Wrapped, free space is [rear, front - 1)
+				status = front - rear > n;
+			else if (q->slots - rear >= n)										// Fits before the end
+				status = true;
+			else if (front > n)													// Skip the tail, [0, front - 1)
+				status = true, rear = 0;
+		}
+
+		q->reserved = status ? rear : q->slots;
+		*ptr = status ? slot(q, rear) : QUEUE_UNDERFLOW;
+		if (!status)
+			STATS_PUSH(id, 0, n);
+	}
+
+	return status;
+}
+
+void queueCommit (queue_id_t id, count_t n)
+{
+	if ((id < ids) && (queues[id].reserved < queues[id].slots))
+	{
+		publish(&queues[id], queues[id].reserved, n);
+		queues[id].reserved = queues[id].slots;
+		STATS_PUSH(id, n, n);
+	}
+}
+
+count_t queuePeekContiguous (queue_id_t id, data_t* ptr)
+{
+	count_t count = 0, start;
+
+	if (id < ids)
+	{
+		count = readable(&queues[id], &start);
+		*ptr = count ? slot(&queues[id], start) : QUEUE_UNDERFLOW;
+	}
+
+	return count;
+}
+
+count_t queueConsume (queue_id_t id, count_t n)
+{
+	count_t count = 0, start;
+
+	if (id < ids)
+	{
+		count = MIN(n, readable(&queues[id], &start));
+		STORE_RELEASE(queues[id].front, start + count);
+		STATS_POP(id, count, n);
+	}
+
+	return count;
+}
+
 data_t queueAccess (queue_id_t id, count_t index, queue_access_t access, data_t data)
 {
 	data_t _data = QUEUE_UNDERFLOW;
-	count_t _index = queues[id].front + index;
 
 	if ((id < ids) && (index < queueSize(id)))
 	{
-		if (queues[id].front + index >= queues[id].size)
-			_index -= queues[id].size;
+		queue_t* q = &queues[id];
+		count_t rear = LOAD_ACQUIRE(q->rear), front = q->front, _index = front + index;
+
+		if ((rear < front) && (_index >= q->last))								// Continues at the start of the storage
+			_index -= q->last;
 
 		if (access == QUEUE_READ)
-			_data = queues[id].items + _index * queues[id].data_size;
+			_data = slot(q, _index);
 		else if (access == QUEUE_WRITE)
 		{
-			for (size_t i = 0; i * sizeof(uint8_t) < queues[id].data_size; i++)
-				((uint8_t*)queues[id].items)[_index * queues[id].data_size] = ((uint8_t*)data)[i];
-
+			memcpy(slot(q, _index), data, q->data_size);
 			_data = data;
 		}
 	}
@@ -156,19 +375,150 @@ data_t queueAccess (queue_id_t id, count_t index, queue_access_t access, data_t
 	return _data;
 }
 
-count_t	queueSize (queue_id_t id)
+count_t queueSize (queue_id_t id)
+{
+	count_t front = LOAD_ACQUIRE(queues[id].front), rear = LOAD_ACQUIRE(queues[id].rear);
+
+	return (rear >= front) ? rear - front : queues[id].last - front + rear;
+}
+
+data_t queueBack (queue_id_t id)
 {
-	count_t size = (queues[id].size + queues[id].rear) - queues[id].front;
-	if (size >= queues[id].size)
-		size -= queues[id].size;
+	data_t data = QUEUE_UNDERFLOW;
+
+	if (!queueIsEmpty(id))
+	{
+		count_t rear = queues[id].rear;
+		data = slot(&queues[id], (rear ? rear : queues[id].last) - 1);
+	}
 
-	return size;
+	return data;
 }
 
-data_t	queueFront		(queue_id_t id) { return !queueIsEmpty(id) ? queues[id].items + queues[id].front * queues[id].data_size : QUEUE_UNDERFLOW; }
-data_t	queueBack		(queue_id_t id) { return !queueIsEmpty(id) ? queues[id].items + (queues[id].rear - 1) * queues[id].data_size : QUEUE_UNDERFLOW; }
+data_t	queueFront		(queue_id_t id) { return queueAccess(id, 0, QUEUE_READ, NULL); }
 bool	queueIsEmpty	(queue_id_t id) { return !queueSize(id); }
-bool	queueIsFull		(queue_id_t id) { return queueSize(id) == queues[id].size; }
-void	queueClear		(queue_id_t id) { queues[id].front = queues[id].rear = 0; }
+bool	queueIsFull		(queue_id_t id) { return queueSize(id) >= queues[id].slots - 1; }
+void	queueClear		(queue_id_t id) { queues[id].front = queues[id].rear = 0; queues[id].last = queues[id].reserved = queues[id].slots; }
+
+#if QUEUE_STATS
+
+void queueStatsClock (queue_clock_t clock)
+{
+	stats_clock = clock;
+}
+
+bool queueStatsGet (queue_id_t id, queue_stats_t* stats)
+{
+	bool status = (id < ids) && (stats != NULL);
+
+	if (status)
+		*stats = queues[id].stats;												// Counters may move while copying, each one is a single word
+
+	return status;
+}
+
+void queueStatsReset (queue_id_t id)
+{
+	if (id < ids)
+	{
+		memset(&queues[id].stats, 0, sizeof(queue_stats_t));
+		queues[id].stats.peak = queueSize(id);
+		queues[id].sampling = false;
+	}
+}
+
+#endif // QUEUE_STATS
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static inline uint8_t* slot (queue_t* q, count_t index) { return q->items + index * q->data_size; }
+
+static count_t writable (queue_t* q, count_t* start)
+{
+	count_t front = LOAD_ACQUIRE(q->front), rear = q->rear, used, count;
+
+	used = (rear >= front) ? rear - front : q->last - front + rear;
+	*start = rear;
+
+	if (rear < front)															// Wrapped, up to one slot before front
+		count = front - rear - 1;
+	else if (rear < q->slots)													// Up to the end of the storage
+		count = q->slots - rear;
+	else																		// At the end, continue from the start
+	{
+		*start = 0;
+		count = front ? front - 1 : 0;
+	}
+
+	return MIN(count, q->slots - 1 - used);
+}
+
+static count_t readable (queue_t* q, count_t* start)
+{
+	count_t rear = LOAD_ACQUIRE(q->rear), front = q->front;
+
+	if ((rear < front) && (front >= q->last))									// Reached the watermark, continue from the start
+		STORE_RELEASE(q->front, front = 0);
+
+	*start = front;
+
+	return (rear >= front) ? rear - front : q->last - front;
+}
+
+#if QUEUE_STATS
+
+static void statsPush (queue_id_t id, count_t n, count_t req)
+{
+	queue_t* q = &queues[id];
+	count_t size = queueSize(id);
+
+	if (n && stats_clock && !LOAD_ACQUIRE(q->sampling))						// Hand a new sample over to the consumer
+	{
+		q->sample_seq = q->stats.pushes;
+		q->sample_ts = stats_clock();
+		STORE_RELEASE(q->sampling, true);
+	}
+
+	q->stats.pushes += n;
+	q->stats.drops += req - n;
+	if (size > q->stats.peak)
+		q->stats.peak = size;
+}
+
+static void statsPop (queue_id_t id, count_t n, count_t req)
+{
+	queue_t* q = &queues[id];
+	uint32_t latency;
+	uint8_t bucket;
+
+	q->stats.pops += n;
+	q->stats.underflows += (req && !n);
+
+	if (LOAD_ACQUIRE(q->sampling) && ((int32_t)(q->stats.pops - q->sample_seq) > 0))	// Sampled element just left
+	{
+		latency = stats_clock() - q->sample_ts;
+		bucket = latency ? (32 - __builtin_clz(latency) + 1) / 2 : 0;			// Smallest i with latency < 4^i
+		q->stats.latency[MIN(bucket, QUEUE_STATS_BUCKETS - 1)]++;
+		q->stats.latency_max = MAX(latency, q->stats.latency_max);
+		STORE_RELEASE(q->sampling, false);
+	}
+}
+
+#endif // QUEUE_STATS
+
+static void publish (queue_t* q, count_t start, count_t n)
+{
+	if (n)
+	{
+		if (start != q->rear)													// Wrapped: data ends where rear was
+			q->last = q->rear;
+
+		STORE_RELEASE(q->rear, start + n);										// Publish after the data is written
+	}
+}
 
 /******************************************************************************/
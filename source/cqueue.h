@@ -16,7 +16,9 @@
  ******************************************************************************/
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -25,7 +27,14 @@
 // Queues configuration ////////////////////////////////////////////////////////
 
 #define QUEUE_MAX_SIZE		24													// Complete with desired queue size
-#define QUEUES_MAX_CANT		2													// Complete with desired number of queues
+#define QUEUES_MAX_CANT		16													// Complete with desired number of queues (UARTs use 12)
+
+// Statistics //////////////////////////////////////////////////////////////////
+
+#ifndef QUEUE_STATS
+#define QUEUE_STATS			0													// 1 to keep per-queue statistics, 0 compiles them out
+#endif
+#define QUEUE_STATS_BUCKETS	8													// Latency histogram buckets
 
 // Invalid data for the queue //////////////////////////////////////////////////
 
@@ -35,6 +44,16 @@
 #define QUEUE_OVERFLOW		(QUEUE_MAX_SIZE + 1)
 #define QUEUE_UNDERFLOW		(INVALID_DATA)
 
+// Static storage //////////////////////////////////////////////////////////////
+
+/**
+ * @brief Declare the storage for a queue initialized with queueInitStatic
+ * @param name Storage name
+ * @param size Size of the queue
+ * @param type Data type
+ */
+#define QUEUE_STORAGE(name, size, type)		static type name[(size) + 1]
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
@@ -50,6 +69,30 @@ typedef enum {
 	QUEUE_WRITE
 } queue_access_t;
 
+typedef uint32_t (*queue_clock_t)(void);										// Free-running timestamp source
+
+/**
+ * @brief Queue statistics snapshot
+ * @param peak Highest occupancy seen (high-water mark)
+ * @param pushes Elements inserted
+ * @param pops Elements removed
+ * @param drops Elements refused because the queue was full (overflow)
+ * @param underflows Removals attempted on an empty queue
+ * @param latency Enqueue-to-dequeue latency histogram, in clock units. Bucket i
+ *        counts latencies below 2^(2i), the last one everything above
+ * @param latency_max Highest latency seen, in clock units
+ * @note Latency is sampled: one element in flight at a time is timestamped
+ */
+typedef struct {
+	count_t		peak;
+	uint32_t	pushes;
+	uint32_t	pops;
+	uint32_t	drops;
+	uint32_t	underflows;
+	uint32_t	latency[QUEUE_STATS_BUCKETS];
+	uint32_t	latency_max;
+} queue_stats_t;
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -62,9 +105,19 @@ typedef enum {
  */
 queue_id_t queueInit (count_t size, uint8_t data_size);
 
+/**
+ * @brief Request a queue over caller-provided storage (no heap)
+ * @param storage Buffer for size + 1 elements, see QUEUE_STORAGE
+ * @param size Size of the queue
+ * @param data_size Size of the data type
+ * @return ID of the queue to use
+ */
+queue_id_t queueInitStatic (void* storage, count_t size, uint8_t data_size);
+
 /**
  * @brief Delete a queue
  * @param id Queue ID
+ * @note Storage given to queueInitStatic is not released
  */
 void queueDelete(queue_id_t id);
 
@@ -85,6 +138,64 @@ count_t queuePush (queue_id_t id, data_t data);
  */
 data_t queuePop (queue_id_t id);
 
+/**
+ * @brief Inserts up to n elements at the back of the queue
+ * @param id Queue ID
+ * @param data Elements to be pushed, contiguous
+ * @param n Number of elements
+ * @return Number of elements pushed, less than n if the queue fills up
+ * @note Copies in at most two contiguous segments (before and after wrapping)
+ */
+count_t queuePushN (queue_id_t id, const void* data, count_t n);
+
+/**
+ * @brief Removes up to n elements from the front of the queue
+ * @param id Queue ID
+ * @param data Place to store the popped elements, contiguous
+ * @param n Number of elements
+ * @return Number of elements popped, less than n if the queue empties
+ * @note Copies in at most two contiguous segments (before and after wrapping)
+ */
+count_t queuePopN (queue_id_t id, void* data, count_t n);
+
+// Zero-copy access (bip-buffer) ///////////////////////////////////////////////
+
+/**
+ * @brief Reserve n contiguous slots at the back of the queue (producer side)
+ * @param id Queue ID
+ * @param n Number of elements to reserve
+ * @param ptr Place to store the address of the reserved region
+ * @return Reservation succeed, false if there is no contiguous room for n
+ * @note If the region does not fit before the end of the storage, it starts
+ *       over at the beginning and the unused tail is skipped by the consumer
+ *       (bip-buffer). Nothing is visible to the consumer until queueCommit
+ */
+bool queueReserve (queue_id_t id, count_t n, data_t* ptr);
+
+/**
+ * @brief Publish elements written into the last reservation (producer side)
+ * @param id Queue ID
+ * @param n Number of elements written, at most the reserved amount
+ */
+void queueCommit (queue_id_t id, count_t n);
+
+/**
+ * @brief Access the largest contiguous run of elements at the front (consumer side)
+ * @param id Queue ID
+ * @param ptr Place to store the address of the first element
+ * @return Number of contiguous elements, 0 if empty
+ * @note The region stays valid until it is released with queueConsume
+ */
+count_t queuePeekContiguous (queue_id_t id, data_t* ptr);
+
+/**
+ * @brief Release elements from the front after reading them in place (consumer side)
+ * @param id Queue ID
+ * @param n Number of elements to release
+ * @return Number of elements released, at most the contiguous run
+ */
+count_t queueConsume (queue_id_t id, count_t n);
+
 /**
  * @brief Access an element in the queue
  * @param id Queue ID
@@ -137,6 +248,107 @@ count_t queueSize (queue_id_t id);
  */
 void queueClear (queue_id_t id);
 
+// Statistics //////////////////////////////////////////////////////////////////
+
+#if QUEUE_STATS
+
+/**
+ * @brief Set the timestamp source used for latency statistics
+ * @param clock Free-running counter, NULL disables latency sampling
+ */
+void queueStatsClock (queue_clock_t clock);
+
+/**
+ * @brief Take a snapshot of the queue statistics
+ * @param id Queue ID
+ * @param stats Place to store the snapshot
+ * @return Snapshot was taken
+ */
+bool queueStatsGet (queue_id_t id, queue_stats_t* stats);
+
+/**
+ * @brief Reset the queue statistics (peak restarts from the current occupancy)
+ * @param id Queue ID
+ */
+void queueStatsReset (queue_id_t id);
+
+#else
+
+static inline void queueStatsClock (queue_clock_t clock) { (void)clock; }
+static inline bool queueStatsGet (queue_id_t id, queue_stats_t* stats) { (void)id; (void)stats; return false; }
+static inline void queueStatsReset (queue_id_t id) { (void)id; }
+
+#endif // QUEUE_STATS
+
+// Compile-time sized queues ///////////////////////////////////////////////////
+
+/**
+ * @brief Define a queue type with its size and data type fixed at compile time
+ * @param name Prefix of the generated type (name##_t) and accessors
+ * @param type Data type, copied by assignment
+ * @param size Size of the queue
+ * @note Accessors are static inline, so element copies and index wrapping are
+ *       resolved by the compiler. A zero-initialized (static) instance is an
+ *       empty queue, no init call or heap is needed. Same single-producer,
+ *       single-consumer rules as the ID based queues
+ * @example QUEUE_STATIC_DEFINE(sample_queue, uint16_t, 64);
+ *          static sample_queue_t samples;
+ *          sample_queuePush(&samples, data);
+ */
+#define QUEUE_STATIC_DEFINE(name, type, size)																		\
+	typedef struct {																								\
+		type				items[(size) + 1];																		\
+		volatile count_t	front;																					\
+		volatile count_t	rear;																					\
+	} name##_t;																										\
+																													\
+	static inline count_t name##Size (const name##_t* q)															\
+	{																												\
+		count_t front = q->front, rear = q->rear;																	\
+		return (rear >= front) ? rear - front : (size) + 1 - front + rear;											\
+	}																												\
+	static inline bool name##IsEmpty (const name##_t* q)	{ return q->front == q->rear; }							\
+	static inline bool name##IsFull (const name##_t* q)		{ return name##Size(q) == (size); }						\
+	static inline void name##Clear (name##_t* q)			{ q->front = q->rear = 0; }								\
+	static inline type* name##Front (name##_t* q)			{ return &q->items[q->front]; }							\
+																													\
+	static inline bool name##Push (name##_t* q, type data)															\
+	{																												\
+		count_t rear = q->rear, next = (rear == (size)) ? 0 : rear + 1;												\
+		bool status = next != q->front;																				\
+		if (status) { q->items[rear] = data; q->rear = next; }														\
+		return status;																								\
+	}																												\
+	static inline bool name##Pop (name##_t* q, type* data)															\
+	{																												\
+		count_t front = q->front;																					\
+		bool status = front != q->rear;																				\
+		if (status) { *data = q->items[front]; q->front = (front == (size)) ? 0 : front + 1; }						\
+		return status;																								\
+	}																												\
+																													\
+	static inline count_t name##PushN (name##_t* q, const type* data, count_t n)									\
+	{																												\
+		count_t rear = q->rear, free = (size) - name##Size(q), count = (n < free) ? n : free;						\
+		count_t first = (count < (size) + 1 - rear) ? count : (size) + 1 - rear;									\
+		memcpy(&q->items[rear], data, first * sizeof(type));														\
+		memcpy(q->items, data + first, (count - first) * sizeof(type));												\
+		rear += count;																								\
+		q->rear = (rear > (size)) ? rear - ((size) + 1) : rear;														\
+		return count;																								\
+	}																												\
+	static inline count_t name##PopN (name##_t* q, type* data, count_t n)											\
+	{																												\
+		count_t front = q->front, used = name##Size(q), count = (n < used) ? n : used;								\
+		count_t first = (count < (size) + 1 - front) ? count : (size) + 1 - front;									\
+		memcpy(data, &q->items[front], first * sizeof(type));														\
+		memcpy(data + first, q->items, (count - first) * sizeof(type));												\
+		front += count;																								\
+		q->front = (front > (size)) ? front - ((size) + 1) : front;													\
+		return count;																								\
+	}																												\
+	typedef int name##_defined_t
+
 /*******************************************************************************
  ******************************************************************************/
 
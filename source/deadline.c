@@ -0,0 +1,161 @@
+/***************************************************************************//**
+  @file     deadline.c
+  @brief    Deadline queue: the earliest of many absolute deadlines, for a
+            single one-shot compare to wait on
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "deadline.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define PARENT(i)			(((i) - 1) / 2)
+#define CHILD(i)			(2 * (i) + 1)										// Left one, the right one follows
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Put a deadline at a heap index
+ * @param queue Queue
+ * @param i Index
+ * @param deadline Deadline
+ */
+static void place (deadline_queue_t* queue, uint16_t i, deadline_t* deadline);
+
+/**
+ * @brief Move a deadline up or down to where it belongs
+ * @param queue Queue
+ * @param i Index it is at
+ */
+static void sift (deadline_queue_t* queue, uint16_t i);
+
+/**
+ * @brief Take a deadline out, the last one fills its place
+ * @param queue Queue
+ * @param deadline Deadline, queued
+ */
+static void unqueue (deadline_queue_t* queue, deadline_t* deadline);
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void deadlineInit (deadline_queue_t* queue)
+{
+	queue->count = 0;
+}
+
+bool deadlineStart (deadline_queue_t* queue, deadline_t* deadline, uint64_t when, deadline_callback_t callback, void* arg)
+{
+	if (!deadline->slot)
+	{
+		if (queue->count >= DEADLINE_MAX)
+			return false;
+		place(queue, queue->count++, deadline);
+	}
+
+	deadline->when = when;
+	deadline->callback = callback;
+	deadline->arg = arg;
+	sift(queue, deadline->slot - 1);												// Up if new or sooner, down if later
+
+	return true;
+}
+
+bool deadlineCancel (deadline_queue_t* queue, deadline_t* deadline)
+{
+	if (!deadline->slot)
+		return false;
+
+	unqueue(queue, deadline);
+
+	return true;
+}
+
+bool deadlineQueued (const deadline_t* deadline)
+{
+	return deadline->slot != 0;
+}
+
+uint64_t deadlineNext (const deadline_queue_t* queue)
+{
+	return queue->count ? queue->heap[0]->when : DEADLINE_NEVER;
+}
+
+uint32_t deadlineExpire (deadline_queue_t* queue, uint64_t now)
+{
+	uint32_t count = 0;
+
+	while (queue->count && (queue->heap[0]->when <= now))
+	{
+		deadline_t* due = queue->heap[0];
+
+		unqueue(queue, due);
+		due->callback(due->arg);													// Off the queue first: it may start itself again
+		count++;
+	}
+
+	return count;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void place (deadline_queue_t* queue, uint16_t i, deadline_t* deadline)
+{
+	queue->heap[i] = deadline;
+	deadline->slot = i + 1;
+}
+
+static void sift (deadline_queue_t* queue, uint16_t i)
+{
+	deadline_t* moving = queue->heap[i];
+	uint16_t child;
+
+	while (i && (queue->heap[PARENT(i)]->when > moving->when))					// Up
+	{
+		place(queue, i, queue->heap[PARENT(i)]);
+		i = PARENT(i);
+	}
+	while ((child = CHILD(i)) < queue->count)									// Down, a no-op if it went up
+	{
+		if ((child + 1 < queue->count) && (queue->heap[child + 1]->when < queue->heap[child]->when))
+			child++;
+		if (queue->heap[child]->when >= moving->when)
+			break;
+		place(queue, i, queue->heap[child]);
+		i = child;
+	}
+	place(queue, i, moving);
+}
+
+static void unqueue (deadline_queue_t* queue, deadline_t* deadline)
+{
+	uint16_t i = deadline->slot - 1;
+	deadline_t* last = queue->heap[--queue->count];
+
+	deadline->slot = 0;
+	if (last != deadline)
+	{
+		place(queue, i, last);
+		sift(queue, i);
+	}
+}
+
+/******************************************************************************/
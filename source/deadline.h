@@ -0,0 +1,119 @@
+/***************************************************************************//**
+  @file     deadline.h
+  @brief    Deadline queue: the earliest of many absolute deadlines, for a
+            single one-shot compare to wait on
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     Binary min-heap of caller-owned deadlines: O(log n) start and
+            cancel, O(1) peek. Times are 64-bit counts that never wrap.
+            No hardware here, the clock driver feeds it the time.
+ ******************************************************************************/
+
+#ifndef _DEADLINE_H_
+#define _DEADLINE_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#ifndef DEADLINE_MAX
+#define DEADLINE_MAX		32													// Deadlines queued at once
+#endif
+
+#define DEADLINE_NEVER		UINT64_MAX											// Empty queue
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef void (* deadline_callback_t)(void* arg);
+
+/**
+ * @brief Deadline, zeroed (static) before its first start
+ * @param when Time it is due at
+ * @param callback Called once due, may start or cancel any deadline
+ * @param arg Callback argument
+ * @param slot Heap index plus one, 0 when not queued
+ */
+typedef struct {
+	uint64_t			when;
+	deadline_callback_t	callback;
+	void*				arg;
+	uint16_t			slot;
+} deadline_t;
+
+/**
+ * @brief Queue
+ * @param heap Deadlines queued, earliest first
+ * @param count Deadlines queued
+ */
+typedef struct {
+	deadline_t*	heap[DEADLINE_MAX];
+	uint16_t	count;
+} deadline_queue_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Initialize a queue, empty
+ * @param queue Queue
+ */
+void deadlineInit (deadline_queue_t* queue);
+
+/**
+ * @brief Queue a deadline, moving it if already queued
+ * @param queue Queue
+ * @param deadline Deadline
+ * @param when Time it is due at, the next expiry if already past
+ * @param callback Called once due
+ * @param arg Callback argument
+ * @return Queued, false when the queue is full
+ */
+bool deadlineStart (deadline_queue_t* queue, deadline_t* deadline, uint64_t when, deadline_callback_t callback, void* arg);
+
+/**
+ * @brief Take a deadline off the queue
+ * @param queue Queue
+ * @param deadline Deadline
+ * @return It was queued
+ */
+bool deadlineCancel (deadline_queue_t* queue, deadline_t* deadline);
+
+/**
+ * @brief Check if a deadline is queued
+ * @param deadline Deadline
+ * @return Queued
+ */
+bool deadlineQueued (const deadline_t* deadline);
+
+/**
+ * @brief Get the earliest deadline, what the compare has to be set to
+ * @param queue Queue
+ * @return Time, DEADLINE_NEVER when empty
+ */
+uint64_t deadlineNext (const deadline_queue_t* queue);
+
+/**
+ * @brief Call back every deadline due by now, earliest first
+ * @param queue Queue
+ * @param now Current time
+ * @return Callbacks run
+ * @note Deadlines started from a callback for now or earlier run in the same call
+ */
+uint32_t deadlineExpire (deadline_queue_t* queue, uint64_t now);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _DEADLINE_H_
@@ -54,6 +54,8 @@
 
 enum {
 	DEBUG_ADC		= 0,
+	DEBUG_CLOCK		= 0,
+	DEBUG_DMA		= 0,
 	DEBUG_GPIO		= 0,
 	DEBUG_PDB		= 0,
 	DEBUG_PISR		= 0,
@@ -62,6 +64,20 @@ enum {
 	DEBUG_UART		= 0
 };
 
+// Trace events, see trace.h ///////////////////////////////////////////////////
+
+enum {
+	TRACE_ADC		= 0,														// Every sample: fills the ring in milliseconds
+	TRACE_DMA		= 1,
+	TRACE_FSM		= 1,
+	TRACE_GPIO		= 1,
+	TRACE_PDB		= 1,
+	TRACE_PISR		= 0,														// Every tick
+	TRACE_PIT		= 1,
+	TRACE_QUEUE		= 1,
+	TRACE_UART		= 1
+};
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -0,0 +1,157 @@
+/***************************************************************************//**
+  @file     dma.c
+  @brief    Enhanced Direct Memory Access (eDMA) driver for K64F
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stddef.h>
+
+#include "debug.h"
+#include "dma.h"
+#include "hardware.h"
+#include "prof.h"
+#include "trace.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define DMA_REG(reg)		(DMA_Ptrs[0]->reg)
+#define DMA_TCD(ch, reg)	(DMA_Ptrs[0]->TCD[ch].reg)
+#define DMAMUX_REG(reg)		(DMAMUX_Ptrs[0]->reg)
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief DMA channel interrupt handler (major loop complete)
+ * @param ch Channel to handle
+ */
+static void handler (dma_channel_t ch);
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static DMA_Type*	const DMA_Ptrs[]	=   DMA_BASE_PTRS;
+static DMAMUX_Type*	const DMAMUX_Ptrs[]	=   DMAMUX_BASE_PTRS;
+static uint8_t		const DMA_IRQn[][DMA_CANT_CHS] = DMA_CHN_IRQS;
+
+static dma_callback_t callbacks[DMA_CANT_CHS];
+static bool init;
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+bool DMA_Init (dma_channel_t ch, dma_cfg_t cfg)
+{
+	bool status = (ch < DMA_CANT_CHS) && cfg.count && (cfg.count <= DMA_MAX_COUNT);
+
+	if (status)
+	{
+		if (!init)
+		{
+			SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;								// Clock Gating for DMAMUX and eDMA
+			SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+			DMA_REG(CR) = 0;													// Fixed priority, no minor loop mapping
+			init = true;
+		}
+
+		DMA_REG(CERQ) = DMA_CERQ_CERQ(ch);										// Stop the channel while it is changed
+		DMAMUX_REG(CHCFG[ch]) = 0;
+
+		DMA_TCD(ch, SADDR)			= cfg.saddr;
+		DMA_TCD(ch, DADDR)			= cfg.daddr;
+		DMA_TCD(ch, SOFF)			= cfg.soff;
+		DMA_TCD(ch, DOFF)			= cfg.doff;
+		DMA_TCD(ch, ATTR)			= DMA_ATTR_SSIZE(cfg.size) | DMA_ATTR_DSIZE(cfg.size);
+		DMA_TCD(ch, NBYTES_MLNO)	= DMA_NBYTES_MLNO_NBYTES(cfg.nbytes);
+		DMA_TCD(ch, CITER_ELINKNO)	= DMA_CITER_ELINKNO_CITER(cfg.count);
+		DMA_TCD(ch, BITER_ELINKNO)	= DMA_BITER_ELINKNO_BITER(cfg.count);
+		DMA_TCD(ch, SLAST)			= cfg.slast;
+		DMA_TCD(ch, DLAST_SGA)		= cfg.dlast;
+		DMA_TCD(ch, CSR)			= DMA_CSR_INTMAJOR(cfg.cb != NULL)			// Interrupt when the major loop completes
+									| DMA_CSR_DREQ(!cfg.circular);				// One-shot transfers clear their request enable
+
+		callbacks[ch] = cfg.cb;
+		if (cfg.cb != NULL)
+			NVIC_EnableIRQ(DMA_IRQn[0][ch]);
+
+		if (cfg.source)
+			DMAMUX_REG(CHCFG[ch]) = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(cfg.source);
+	}
+
+	return status;
+}
+
+void DMA_SetTransfer (dma_channel_t ch, uint32_t saddr, uint32_t daddr, uint16_t count)
+{
+	if (ch < DMA_CANT_CHS)
+	{
+		DMA_TCD(ch, SADDR)			= saddr;
+		DMA_TCD(ch, DADDR)			= daddr;
+		DMA_TCD(ch, CITER_ELINKNO)	= DMA_CITER_ELINKNO_CITER(count);
+		DMA_TCD(ch, BITER_ELINKNO)	= DMA_BITER_ELINKNO_BITER(count);
+	}
+}
+
+void		DMA_Start		(dma_channel_t ch) { DMA_REG(SERQ) = DMA_SERQ_SERQ(ch); }
+void		DMA_Stop		(dma_channel_t ch) { DMA_REG(CERQ) = DMA_CERQ_CERQ(ch); }
+uint16_t	DMA_GetCount	(dma_channel_t ch) { return DMA_TCD(ch, CITER_ELINKNO) & DMA_CITER_ELINKNO_CITER_MASK; }
+bool		DMA_IsBusy		(dma_channel_t ch) { return DMA_REG(ERQ) & (1U << ch); }
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+// ISR Functions ///////////////////////////////////////////////////////////////
+
+__ISR__ DMA0_IRQHandler		(void) { handler(DMA_CH0); }
+__ISR__ DMA1_IRQHandler		(void) { handler(DMA_CH1); }
+__ISR__ DMA2_IRQHandler		(void) { handler(DMA_CH2); }
+__ISR__ DMA3_IRQHandler		(void) { handler(DMA_CH3); }
+__ISR__ DMA4_IRQHandler		(void) { handler(DMA_CH4); }
+__ISR__ DMA5_IRQHandler		(void) { handler(DMA_CH5); }
+__ISR__ DMA6_IRQHandler		(void) { handler(DMA_CH6); }
+__ISR__ DMA7_IRQHandler		(void) { handler(DMA_CH7); }
+__ISR__ DMA8_IRQHandler		(void) { handler(DMA_CH8); }
+__ISR__ DMA9_IRQHandler		(void) { handler(DMA_CH9); }
+__ISR__ DMA10_IRQHandler	(void) { handler(DMA_CH10); }
+__ISR__ DMA11_IRQHandler	(void) { handler(DMA_CH11); }
+__ISR__ DMA12_IRQHandler	(void) { handler(DMA_CH12); }
+__ISR__ DMA13_IRQHandler	(void) { handler(DMA_CH13); }
+__ISR__ DMA14_IRQHandler	(void) { handler(DMA_CH14); }
+__ISR__ DMA15_IRQHandler	(void) { handler(DMA_CH15); }
+
+static void handler (dma_channel_t ch)
+{
+#if DEBUG_DMA
+D_DEBUG_TP_SET
+#endif
+	PROF_BEGIN(PROF_DMA_ISR);
+	TRACE_BEGIN(TRACE_DMA, TRACE_DMA_ISR, ch);
+	DMA_REG(CINT) = DMA_CINT_CINT(ch);											// Clear interrupt flag
+
+	if (callbacks[ch] != NULL)
+		callbacks[ch](ch);
+	TRACE_END(TRACE_DMA, TRACE_DMA_ISR, ch);
+	PROF_END(PROF_DMA_ISR);
+#if DEBUG_DMA
+D_DEBUG_TP_CLR
+#endif
+}
+
+/******************************************************************************/
@@ -0,0 +1,139 @@
+/***************************************************************************//**
+  @file     dma.h
+  @brief    Enhanced Direct Memory Access (eDMA) driver for K64F
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+#ifndef _DMA_H_
+#define _DMA_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define DMA_MAX_COUNT		0x7FFF												// Major loop count (channel linking disabled)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef enum {
+	DMA_CH0,
+	DMA_CH1,
+	DMA_CH2,
+	DMA_CH3,
+	DMA_CH4,
+	DMA_CH5,
+	DMA_CH6,
+	DMA_CH7,
+	DMA_CH8,
+	DMA_CH9,
+	DMA_CH10,
+	DMA_CH11,
+	DMA_CH12,
+	DMA_CH13,
+	DMA_CH14,
+	DMA_CH15,
+
+	DMA_CANT_CHS
+} dma_channel_t;
+
+typedef enum {
+	DMA_SIZE_8,
+	DMA_SIZE_16,
+	DMA_SIZE_32
+} dma_size_t;
+
+typedef void (*dma_callback_t)(dma_channel_t ch);
+
+/**
+ * @brief Channel configuration
+ * @param source DMAMUX request source (peripheral), 0 for software-started transfers
+ * @param saddr Source address
+ * @param daddr Destination address
+ * @param soff Source offset after each read
+ * @param doff Destination offset after each write
+ * @param size Transfer size, both sides
+ * @param nbytes Bytes moved per request (minor loop)
+ * @param count Requests per transfer (major loop)
+ * @param slast Source adjustment when the major loop completes
+ * @param dlast Destination adjustment when the major loop completes
+ * @param circular Keep serving requests after the major loop (ring buffers)
+ * @param cb Called from the ISR when the major loop completes, NULL for none
+ */
+typedef struct {
+	uint8_t			source;
+	uint32_t		saddr;
+	uint32_t		daddr;
+	int16_t			soff;
+	int16_t			doff;
+	dma_size_t		size;
+	uint32_t		nbytes;
+	uint16_t		count;
+	int32_t			slast;
+	int32_t			dlast;
+	bool			circular;
+	dma_callback_t	cb;
+} dma_cfg_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Configure a DMA channel, requests stay disabled until DMA_Start
+ * @param ch Channel
+ * @param cfg Channel configuration
+ * @return Configuration succeed
+ */
+bool DMA_Init (dma_channel_t ch, dma_cfg_t cfg);
+
+/**
+ * @brief Load a new linear transfer (addresses and count) on an idle channel
+ * @param ch Channel
+ * @param saddr Source address
+ * @param daddr Destination address
+ * @param count Requests per transfer (major loop)
+ */
+void DMA_SetTransfer (dma_channel_t ch, uint32_t saddr, uint32_t daddr, uint16_t count);
+
+/**
+ * @brief Enable the peripheral requests of a channel
+ * @param ch Channel
+ */
+void DMA_Start (dma_channel_t ch);
+
+/**
+ * @brief Disable the peripheral requests of a channel
+ * @param ch Channel
+ */
+void DMA_Stop (dma_channel_t ch);
+
+/**
+ * @brief Requests left in the current major loop
+ * @param ch Channel
+ * @return Current major loop count (CITER)
+ */
+uint16_t DMA_GetCount (dma_channel_t ch);
+
+/**
+ * @brief Check if a channel is serving requests
+ * @param ch Channel
+ * @return Requests are enabled
+ */
+bool DMA_IsBusy (dma_channel_t ch);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _DMA_H_
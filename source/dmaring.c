@@ -0,0 +1,82 @@
+/***************************************************************************//**
+  @file     dmaring.c
+  @brief    Consumer side of a circular buffer filled by a DMA channel
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "dmaring.h"
+#include "macros.h"
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void dmaRingInit (dma_ring_t* ring, uint8_t* buf, uint16_t size)
+{
+	ring->buf = buf;
+	ring->size = size;
+	ring->tail = 0;
+	ring->overruns = 0;
+}
+
+uint32_t dmaRingAvailable (dma_ring_t* ring, uint32_t head)
+{
+	uint32_t count = head - ring->tail;
+
+	if (count > ring->size)														// Lapped: the oldest bytes are gone
+	{
+		ring->overruns += count - ring->size;
+		ring->tail = head - ring->size;
+		count = ring->size;
+	}
+
+	return count;
+}
+
+uint32_t dmaRingRead (dma_ring_t* ring, uint32_t head, uint8_t* data, uint32_t n)
+{
+	uint8_t* ptr;
+	uint32_t count = 0, chunk;
+
+	for (uint8_t segment = 0; (segment < 2) && (count < n); segment++)			// Before and after wrapping
+	{
+		chunk = MIN(n - count, dmaRingPeek(ring, head, &ptr));
+		memcpy(data + count, ptr, chunk);
+		dmaRingConsume(ring, chunk);
+		count += chunk;
+	}
+
+	return count;
+}
+
+uint32_t dmaRingPeek (dma_ring_t* ring, uint32_t head, uint8_t** ptr)
+{
+	return dmaRingPeekAt(ring, head, 0, ptr);
+}
+
+uint32_t dmaRingPeekAt (dma_ring_t* ring, uint32_t head, uint32_t offset, uint8_t** ptr)
+{
+	uint32_t count = dmaRingAvailable(ring, head), index = (ring->tail + offset) % ring->size;
+
+	*ptr = ring->buf + index;
+
+	return (offset < count) ? MIN(count - offset, ring->size - index) : 0;
+}
+
+void dmaRingConsume (dma_ring_t* ring, uint32_t n)
+{
+	ring->tail += n;
+}
+
+/******************************************************************************/
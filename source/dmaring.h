@@ -0,0 +1,108 @@
+/***************************************************************************//**
+  @file     dmaring.h
+  @brief    Consumer side of a circular buffer filled by a DMA channel
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     Hardware independent: the producer position is passed in as a
+            free-running byte count (laps * size + offset), see dmaRingHead
+ ******************************************************************************/
+
+#ifndef _DMARING_H_
+#define _DMARING_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/**
+ * @brief Ring structure
+ * @param buf Buffer written by the DMA channel
+ * @param size Buffer size in bytes
+ * @param tail Free-running read position
+ * @param overruns Bytes overwritten by the DMA before they were read
+ */
+typedef struct {
+	uint8_t*	buf;
+	uint16_t	size;
+	uint32_t	tail;
+	uint32_t	overruns;
+} dma_ring_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Initialize a ring
+ * @param ring Ring to initialize
+ * @param buf Buffer the DMA channel writes circularly
+ * @param size Buffer size in bytes
+ */
+void dmaRingInit (dma_ring_t* ring, uint8_t* buf, uint16_t size);
+
+/**
+ * @brief Free-running write position of a circular DMA transfer
+ * @param laps Completed major loops
+ * @param size Buffer size in bytes (major loop count)
+ * @param remaining Current major loop count (CITER)
+ * @return Bytes written since the transfer started
+ */
+static inline uint32_t dmaRingHead (uint32_t laps, uint16_t size, uint16_t remaining) { return laps * size + (size - remaining); }
+
+/**
+ * @brief Get the number of unread bytes
+ * @param ring Ring
+ * @param head Free-running write position
+ * @return Unread bytes, drops the oldest ones if the DMA lapped the reader
+ */
+uint32_t dmaRingAvailable (dma_ring_t* ring, uint32_t head);
+
+/**
+ * @brief Copy out unread bytes
+ * @param ring Ring
+ * @param head Free-running write position
+ * @param data Place to store the bytes
+ * @param n Maximum number of bytes
+ * @return Number of bytes copied
+ */
+uint32_t dmaRingRead (dma_ring_t* ring, uint32_t head, uint8_t* data, uint32_t n);
+
+/**
+ * @brief Access the unread bytes in place, up to the end of the buffer
+ * @param ring Ring
+ * @param head Free-running write position
+ * @param ptr Place to store the address of the first unread byte
+ * @return Number of contiguous unread bytes
+ */
+uint32_t dmaRingPeek (dma_ring_t* ring, uint32_t head, uint8_t** ptr);
+
+/**
+ * @brief Access unread bytes in place, past the first ones, up to the end of the buffer
+ * @param ring Ring
+ * @param head Free-running write position
+ * @param offset Unread bytes to skip
+ * @param ptr Place to store the address of the byte at offset
+ * @return Number of contiguous unread bytes from offset, 0 if there are none
+ */
+uint32_t dmaRingPeekAt (dma_ring_t* ring, uint32_t head, uint32_t offset, uint8_t** ptr);
+
+/**
+ * @brief Release bytes read in place
+ * @param ring Ring
+ * @param n Number of bytes
+ */
+void dmaRingConsume (dma_ring_t* ring, uint32_t n);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _DMARING_H_
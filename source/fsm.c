@@ -13,59 +13,26 @@
  ******************************************************************************/
 
 #include "fsm.h"
+#include "trace.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
 
-#define DEVELOPMENT_MODE	1
+#define QUEUE_MASK			(FSM_QUEUE_SIZE - 1)
 
-#define TABLE_END			EVENTS_CANT
+#define LOAD_ACQUIRE(x)		__atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define LOAD_RELAXED(x)		__atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define STORE_RELEASE(x, v)	__atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#define CLAIM(x, old)		__atomic_compare_exchange_n(&(x), &(old), (old) + 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
 
-// Number of edges per state (transitions) /////////////////////////////////////
+#if FSM_STATS
+#define STATS(x)			((void)(x))
+#else
+#define STATS(x)			((void)0)
+#endif
 
-#define STATE_0_EDGES		3													// Extra space for default transition
-#define STATE_1_EDGES		2
-// Add more state edges here
-
-
-/*******************************************************************************
- * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
- ******************************************************************************/
-
-/*
- * @brief Do nothing
- */
-static void pass (void);
-
-/*
- * @brief Reset the FSM
- */
-static void reset (void);
-
-static void updateAngle (void);
-
-/*******************************************************************************
- * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
- ******************************************************************************/
-
-// State-transition tables /////////////////////////////////////////////////////
-
-static fsm_state_t READ_ORIENTATION[];
-static fsm_state_t TRANSMIT_CAN[];
-static fsm_state_t RECEIVE_CAN[];
-static fsm_state_t TRASMIT_UART[];
-static fsm_state_t CHECK_UPDATE[];
-static fsm_state_t WAIT[];
-static fsm_state_t ERROR[];
-static fsm_state_t END[];
-
-static fsm_state_t CHECK_UPDATE[] = { {I2C_MSG, READ_ORIENTATION, updateAngle},
-		   							  {TABLE_END, END, reset} };
-
-static fsm_state_t READ_ORIENTATION[] = { {TABLE_END, END, reset} };
-
-// Add more states here
+_Static_assert(!(FSM_QUEUE_SIZE & QUEUE_MASK), "FSM_QUEUE_SIZE must be a power of 2");
 
 /*******************************************************************************
  *******************************************************************************
@@ -73,9 +40,9 @@ static fsm_state_t READ_ORIENTATION[] = { {TABLE_END, END, reset} };
  *******************************************************************************
  ******************************************************************************/
 
-fsm_state_t* fsm (fsm_state_t* state, fsm_event_t event)
+fsm_state_t* fsm (fsm_state_t* state, fsm_id_t event)
 {
-   	while ((state->event != event) && (state->event != TABLE_END))
+   	while ((state->event != event) && (state->event != FSM_TABLE_END))
 		++state;
 	
 	(*state->callback)();
@@ -83,25 +50,116 @@ fsm_state_t* fsm (fsm_state_t* state, fsm_event_t event)
 	return state->next_state;
 }
 
-fsm_state_t* fsmInit (void)
+// Table form //////////////////////////////////////////////////////////////////
+
+bool fsmTableInit (fsm_machine_t* machine, const fsm_cell_t* table, fsm_id_t states, fsm_id_t events, fsm_id_t initial, void (* notify)(void))
 {
- 	return CHECK_UPDATE;
+	bool status = machine && table && (states <= FSM_MAX_STATES) && (events <= FSM_MAX_EVENTS) && (initial < states);
+
+	if (status)
+	{
+		machine->table = table;
+		machine->states = states;
+		machine->events = events;
+		machine->state = initial;
+		machine->notify = notify;
+		for (uint32_t i = 0; i < FSM_QUEUE_SIZE; i++)
+			machine->queue[i].seq = i;												// Free for the post number i
+		machine->head = machine->tail = 0;
+#if FSM_STATS
+		machine->stats = (fsm_stats_t){ { 0 }, { 0 }, 0, 0 };
+		machine->stats.entered[initial] = 1;
+#endif
+	}
+
+	return status;
 }
 
-/*******************************************************************************
- *******************************************************************************
-                        LOCAL FUNCTION DEFINITIONS
- *******************************************************************************
- ******************************************************************************/
+fsm_id_t fsmDispatch (fsm_machine_t* machine, fsm_id_t event)
+{
+	const fsm_cell_t* cell;
+
+	if (event >= machine->events)
+	{
+		STATS(machine->stats.ignored++);
+		return machine->state;
+	}
+
+	cell = &machine->table[machine->state * machine->events + event];			// No search, one cell per state and event
+	STATS(machine->stats.events[event]++);
+	if (!cell->next)
+	{
+		STATS(machine->stats.ignored++);
+		return machine->state;
+	}
+
+	machine->state = cell->next - 1;											// First: the callback sees the next state
+	STATS(machine->stats.entered[machine->state]++);
+	TRACE_MARK(TRACE_FSM, TRACE_FSM_STATE, ((uint32_t)event << 16) | machine->state);
+	if (cell->callback)
+		cell->callback();
+
+	return machine->state;
+}
 
-// Callback functions //////////////////////////////////////////////////////////
+bool fsmPost (fsm_machine_t* machine, fsm_id_t event)
+{
+	uint32_t pos = LOAD_RELAXED(machine->tail), seq;
+
+	for (;;)
+	{
+		seq = LOAD_ACQUIRE(machine->queue[pos & QUEUE_MASK].seq);
+		if (seq == pos)																// Free: claim it, or retry if someone else did
+		{
+			if (CLAIM(machine->tail, pos))
+				break;
+		}
+		else if ((int32_t)(seq - pos) < 0)											// Not run yet since the last lap: full
+		{
+			STATS(__atomic_fetch_add(&machine->stats.dropped, 1, __ATOMIC_RELAXED));
+			return false;
+		}
+		else
+			pos = LOAD_RELAXED(machine->tail);
+	}
+
+	machine->queue[pos & QUEUE_MASK].event = event;
+	STORE_RELEASE(machine->queue[pos & QUEUE_MASK].seq, pos + 1);				// Publish
+	if (machine->notify)
+		machine->notify();
+
+	return true;
+}
 
-static void pass (void) {}
-static void reset (void) {}
+uint32_t fsmRun (fsm_machine_t* machine)
+{
+	uint32_t count = 0;
+	fsm_id_t event;
+
+	while (LOAD_ACQUIRE(machine->queue[machine->head & QUEUE_MASK].seq) == machine->head + 1)	// Published
+	{
+		event = machine->queue[machine->head & QUEUE_MASK].event;
+		STORE_RELEASE(machine->queue[machine->head & QUEUE_MASK].seq, machine->head + FSM_QUEUE_SIZE);	// Free for the next lap
+		machine->head++;
+		fsmDispatch(machine, event);
+		count++;
+	}
+
+	return count;
+}
 
-static void updateAngle (void)
+fsm_id_t fsmGetState (const fsm_machine_t* machine)
 {
-	// Update angle
+	return machine->state;
 }
 
+#if FSM_STATS
+
+const fsm_stats_t* fsmGetStats (const fsm_machine_t* machine)
+{
+	return &machine->stats;
+}
+
+#endif // FSM_STATS
+
 /******************************************************************************/
@@ -11,56 +11,172 @@
 #ifndef _FSM_H_
 #define _FSM_H_
 
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define FSM_TABLE_END		0xFF												// Edge list: last edge of a state, any other event
+
+// Table form //////////////////////////////////////////////////////////////////
+
+#ifndef FSM_STATS
+#define FSM_STATS			1													// 1 to keep per-state and per-event counters, 0 compiles them out
+#endif
+#ifndef FSM_QUEUE_SIZE
+#define FSM_QUEUE_SIZE		16													// Events posted and not run yet, power of 2
+#endif
+#define FSM_MAX_STATES		16
+#define FSM_MAX_EVENTS		16
+
+/**
+ * @brief Table cell: go to a state running a callback (NULL for none)
+ * @note Cells left out (zero) ignore the event, the state does not change
+ */
+#define FSM_GOTO(state, cb)	{ (fsm_id_t)((state) + 1), (cb) }
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
-typedef enum {
-	UART_MSG,
-	I2C_MSG,
-	CAN_MSG,
-
-	EVENTS_CANT
-} fsm_event_t;
-
-//typedef enum {
-//	INIT,
-//	READ_ORIENTATION,
-//	TRANSMIT_CAN,
-//	RECEIVE_CAN,
-//	TRASMIT_UART,
-//	CHECK_UPDATE,
-//	WAIT,
-//	ERROR,
-//	END,
-//
-//	STATES_CANT
-//} fsm_state_id_t;
+typedef uint8_t fsm_id_t;														// State or event, per machine enums
 
 typedef struct transition_edge fsm_state_t;
 struct transition_edge {
-	fsm_event_t event;
+	fsm_id_t event;
 	fsm_state_t* next_state;
 	void (* callback)(void);
 };
 
+// Table form //////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Table cell, see FSM_GOTO
+ * @param next Next state + 1, 0 to ignore the event
+ * @param callback Transition action, NULL for none
+ */
+typedef struct {
+	fsm_id_t	next;
+	void		(* callback)(void);
+} fsm_cell_t;
+
+/**
+ * @brief Machine counters
+ * @param entered Transitions into each state, self transitions included
+ * @param events Events run, per event
+ * @param ignored Events with no transition from the state they arrived in
+ * @param dropped Events lost, queue full
+ */
+typedef struct {
+	uint32_t	entered[FSM_MAX_STATES];
+	uint32_t	events[FSM_MAX_EVENTS];
+	uint32_t	ignored;
+	uint32_t	dropped;
+} fsm_stats_t;
+
+/**
+ * @brief Table-driven machine with its event queue
+ * @param table Cells, [state][event] row by row
+ * @param states Number of states
+ * @param events Number of events
+ * @param state Current state
+ * @param notify Called after each post, e.g. to post a scheduler task, NULL for none
+ * @param queue Bounded multi-producer queue, a sequence number per cell
+ * @param head Next cell to run, only written by fsmRun
+ * @param tail Next cell to claim, claimed with compare-and-swap by fsmPost
+ * @param stats Counters
+ */
+typedef struct {
+	const fsm_cell_t*	table;
+	fsm_id_t			states;
+	fsm_id_t			events;
+	volatile fsm_id_t	state;
+	void				(* notify)(void);
+	struct {
+		volatile uint32_t	seq;
+		fsm_id_t			event;
+	}					queue[FSM_QUEUE_SIZE];
+	uint32_t			head;
+	volatile uint32_t	tail;
+#if FSM_STATS
+	fsm_stats_t			stats;
+#endif
+} fsm_machine_t;
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
 
 /**
- * @brief FSM initialization
- * @return Initial state
+ * @brief FSM interpreter
+ * @param state Current state, its edges ending in FSM_TABLE_END
+ * @param event Incoming event
+ * @return Next state
  */
-fsm_state_t* fsmInit (void);
+fsm_state_t* fsm (fsm_state_t* state, fsm_id_t event);
+
+// Table form //////////////////////////////////////////////////////////////////
 
 /**
- * @brief FSM interpreter
- * @param state Current state
- * @param event Incoming event
+ * @brief Initialize a table-driven machine, queue empty, counters cleared
+ * @param machine Machine
+ * @param table Cells, states * events, [state][event] row by row
+ * @param states Number of states, up to FSM_MAX_STATES
+ * @param events Number of events, up to FSM_MAX_EVENTS
+ * @param initial Initial state
+ * @param notify Called after each post, NULL for none
+ * @return Initialization succeed
+ */
+bool fsmTableInit (fsm_machine_t* machine, const fsm_cell_t* table, fsm_id_t states, fsm_id_t events, fsm_id_t initial, void (* notify)(void));
+
+/**
+ * @brief Run an event right away, constant time
+ * @param machine Machine
+ * @param event Event
  * @return Next state
+ * @note Main loop only, not to be mixed with fsmRun from an ISR
+ */
+fsm_id_t fsmDispatch (fsm_machine_t* machine, fsm_id_t event);
+
+/**
+ * @brief Queue an event, from an ISR or the main loop
+ * @param machine Machine
+ * @param event Event
+ * @return Event queued, false if the queue is full (counted as dropped)
+ * @note Lock-free, safe from ISRs of any priority
+ */
+bool fsmPost (fsm_machine_t* machine, fsm_id_t event);
+
+/**
+ * @brief Run the queued events to completion, in order, from the main loop
+ * @param machine Machine
+ * @return Events run, posts made by the callbacks included
+ */
+uint32_t fsmRun (fsm_machine_t* machine);
+
+/**
+ * @brief Get the current state
+ * @param machine Machine
+ * @return Current state
+ */
+fsm_id_t fsmGetState (const fsm_machine_t* machine);
+
+#if FSM_STATS
+
+/**
+ * @brief Get the counters
+ * @param machine Machine
+ * @return Counters since fsmTableInit
  */
-fsm_state_t* fsm (fsm_state_t* state, fsm_event_t event);
+const fsm_stats_t* fsmGetStats (const fsm_machine_t* machine);
+
+#endif // FSM_STATS
 
 /*******************************************************************************
  ******************************************************************************/
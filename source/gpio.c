@@ -20,6 +20,8 @@
 #include "gpio.h"
 #include "hardware.h"
 #include "macros.h"
+#include "prof.h"
+#include "trace.h"
 #include "MK64F12.h"
 
 /*******************************************************************************
@@ -143,6 +145,8 @@ __ISR__ PORTA_IRQHandler (void)
 #if DEBUG_GPIO
 D_DEBUG_TP_SET
 #endif
+	PROF_BEGIN(PROF_GPIO_ISR);
+	TRACE_BEGIN(TRACE_GPIO, TRACE_GPIO_ISR, PA);
 	for (uint8_t i = 0; i < 32; i++) // Very slow, there are better ways such as CLZ
 		if (BITGET(PORTA->ISFR, i))
 		{
@@ -150,6 +154,8 @@ D_DEBUG_TP_SET
 			if(irqFuns[PA][i] != NULL)
 				irqFuns[PA][i]();
 		}
+	TRACE_END(TRACE_GPIO, TRACE_GPIO_ISR, PA);
+	PROF_END(PROF_GPIO_ISR);
 #if DEBUG_GPIO
 D_DEBUG_TP_CLR
 #endif
@@ -160,6 +166,8 @@ __ISR__ PORTB_IRQHandler (void)
 #if DEBUG_GPIO
 D_DEBUG_TP_SET
 #endif
+	PROF_BEGIN(PROF_GPIO_ISR);
+	TRACE_BEGIN(TRACE_GPIO, TRACE_GPIO_ISR, PB);
 	for (uint8_t i = 0; i < 32; i++)
 		if (BITGET(PORTB->ISFR, i))
 		{
@@ -167,6 +175,8 @@ D_DEBUG_TP_SET
 			if(irqFuns[PB][i] != NULL)
 				irqFuns[PB][i]();
 		}
+	TRACE_END(TRACE_GPIO, TRACE_GPIO_ISR, PB);
+	PROF_END(PROF_GPIO_ISR);
 #if DEBUG_GPIO
 D_DEBUG_TP_CLR
 #endif
@@ -177,6 +187,8 @@ __ISR__ PORTC_IRQHandler (void)
 #if DEBUG_GPIO
 D_DEBUG_TP_SET
 #endif
+	PROF_BEGIN(PROF_GPIO_ISR);
+	TRACE_BEGIN(TRACE_GPIO, TRACE_GPIO_ISR, PC);
 	for (uint8_t i = 0; i < 32; i++)
 		if (BITGET(PORTC->ISFR, i))
 		{
@@ -184,6 +196,8 @@ D_DEBUG_TP_SET
 			if(irqFuns[PC][i] != NULL)
 				irqFuns[PC][i]();
 		}
+	TRACE_END(TRACE_GPIO, TRACE_GPIO_ISR, PC);
+	PROF_END(PROF_GPIO_ISR);
 #if DEBUG_GPIO
 D_DEBUG_TP_CLR
 #endif
@@ -194,6 +208,8 @@ __ISR__ PORTD_IRQHandler (void)
 #if DEBUG_GPIO
 D_DEBUG_TP_SET
 #endif
+	PROF_BEGIN(PROF_GPIO_ISR);
+	TRACE_BEGIN(TRACE_GPIO, TRACE_GPIO_ISR, PD);
 	for (uint8_t i = 0; i < 32; i++)
 		if (BITGET(PORTD->ISFR, i))
 		{
@@ -201,6 +217,8 @@ D_DEBUG_TP_SET
 			if(irqFuns[PD][i] != NULL)
 				irqFuns[PD][i]();
 		}
+	TRACE_END(TRACE_GPIO, TRACE_GPIO_ISR, PD);
+	PROF_END(PROF_GPIO_ISR);
 #if DEBUG_GPIO
 D_DEBUG_TP_CLR
 #endif
@@ -211,6 +229,8 @@ __ISR__ PORTE_IRQHandler (void)
 #if DEBUG_GPIO
 D_DEBUG_TP_SET
 #endif
+	PROF_BEGIN(PROF_GPIO_ISR);
+	TRACE_BEGIN(TRACE_GPIO, TRACE_GPIO_ISR, PE);
 	for (uint8_t i = 0; i < 32; i++)
 		if (BITGET(PORTE->ISFR, i))
 		{
@@ -218,6 +238,8 @@ D_DEBUG_TP_SET
 			if(irqFuns[PE][i] != NULL)
 				irqFuns[PE][i]();
 		}
+	TRACE_END(TRACE_GPIO, TRACE_GPIO_ISR, PE);
+	PROF_END(PROF_GPIO_ISR);
 #if DEBUG_GPIO
 D_DEBUG_TP_CLR
 #endif
@@ -50,6 +50,8 @@
 
 #define CAP(x, min, max)		(x = (x < (min) ? (min) : (x > (max) ? (max) : x)))
 #define ABS(x)					(((x) < 0) ? -(x) : (x))
+#define MIN(a, b)				(((a) < (b)) ? (a) : (b))
+#define MAX(a, b)				(((a) > (b)) ? (a) : (b))
 #define CMP_IN(min, val, max)	(((min) < (val)) && ((val) < (max)))			// In:  (min, max)
 #define CMP_OUT(min, val, max)	(((val) <= (min)) || ((max) <= (val)))			// Out: (-inf, min] U [max, +inf)
 
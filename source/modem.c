@@ -0,0 +1,434 @@
+/***************************************************************************//**
+  @file     modem.c
+  @brief    Half-duplex FSK modem (Bell 202): carrier detector, demodulator,
+            modulator and byte queues coordinated by a table-driven FSM
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "fsm.h"
+#include "modem.h"
+#include "prof.h"
+#include "spsc.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define SAMPLE_MASK			0x0FFF												// 12 bits
+#define SAMPLES_PER_BIT		(MODEM_SAMPLE_HZ / MODEM_BAUD)
+#define FRAME_BITS			10													// Start, 8 data, stop
+#define FRAME_STOP			(1U << (FRAME_BITS - 1))
+
+#define FRAC				8													// Fixed point, Q8
+#define DC_SHIFT			7													// Line level over ~128 samples
+#define ENV_SHIFT			4													// Envelope over ~16 samples
+#define LPF_SHIFT			2													// Discriminator low-pass, two poles at 3/4
+
+#define NCO_STEP(f)			((uint32_t)((((uint64_t)(f) << 32) + MODEM_SAMPLE_HZ / 2) / MODEM_SAMPLE_HZ))
+#define TIMER(ms)			(MODEM_MS2SAMPLES(ms) + 1)							// Samples, at least one: 0 stops it
+
+_Static_assert(!(MODEM_SAMPLE_HZ % MODEM_BAUD), "MODEM_SAMPLE_HZ must be a multiple of MODEM_BAUD");
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef enum {
+	EV_CARRIER_ON,																// Posted by the carrier detector
+	EV_CARRIER_OFF,
+	EV_TX_REQUEST,																// Posted by modemWrite and on return to idle
+	EV_TIMEOUT,																	// Posted by the sample timer
+	EV_TX_DONE,																	// Posted by the modulator, queue empty
+
+	MODEM_EVENTS
+} modem_event_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+// FSM callbacks, the state is already the next one ////////////////////////////
+
+/**
+ * @brief Carrier seen, time it
+ */
+static void qualify (void);
+
+/**
+ * @brief Carrier lasted, start demodulating
+ */
+static void receive (void);
+
+/**
+ * @brief Carrier lost while receiving, stop demodulating and wait
+ */
+static void receiveEnd (void);
+
+/**
+ * @brief Line free and bytes to send: receive DSP off, mark tone on
+ */
+static void preamble (void);
+
+/**
+ * @brief Preamble out, start sending bytes
+ */
+static void transmit (void);
+
+/**
+ * @brief Last byte out: tone off, receive DSP still off while the echo dies
+ */
+static void transmitEnd (void);
+
+/**
+ * @brief Back to idle: receive DSP on, send what was queued meanwhile
+ */
+static void idle (void);
+
+// Signal processing, from the ISRs ////////////////////////////////////////////
+
+/**
+ * @brief Carrier detector and, while receiving, demodulator
+ * @param sample 12-bit sample
+ */
+static void detect (int32_t sample);
+
+/**
+ * @brief Delay-and-multiply discriminator and 8N1 deframer
+ * @param x Sample, line level removed
+ */
+static void demodulate (int32_t x);
+
+/**
+ * @brief Modulator sine, quarter-wave table
+ * @param angle Phase, full turn 2^32
+ * @return Sine, Q15
+ */
+static int32_t sine (uint32_t angle);
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const fsm_cell_t table[MODEM_STATES][MODEM_EVENTS] = {					// Cells left out ignore the event
+	[MODEM_IDLE] = {
+		[EV_CARRIER_ON]		= FSM_GOTO(MODEM_CARRIER, qualify),
+		[EV_TX_REQUEST]		= FSM_GOTO(MODEM_PREAMBLE, preamble) },
+	[MODEM_CARRIER] = {
+		[EV_CARRIER_OFF]	= FSM_GOTO(MODEM_IDLE, idle),
+		[EV_TIMEOUT]		= FSM_GOTO(MODEM_RECEIVE, receive) },
+	[MODEM_RECEIVE] = {
+		[EV_CARRIER_OFF]	= FSM_GOTO(MODEM_TURNAROUND, receiveEnd) },
+	[MODEM_PREAMBLE] = {
+		[EV_TIMEOUT]		= FSM_GOTO(MODEM_TRANSMIT, transmit) },
+	[MODEM_TRANSMIT] = {
+		[EV_TX_DONE]		= FSM_GOTO(MODEM_TURNAROUND, transmitEnd) },
+	[MODEM_TURNAROUND] = {
+		[EV_CARRIER_ON]		= FSM_GOTO(MODEM_CARRIER, qualify),				// Only after receiving, the detector is off after sending
+		[EV_TIMEOUT]		= FSM_GOTO(MODEM_IDLE, idle) },
+};
+
+static const int16_t quarter[] = {												// sin(pi/2 * i / 64), Q15
+	    0,   804,  1608,  2410,  3212,  4011,  4808,  5602,
+	 6393,  7179,  7962,  8739,  9512, 10278, 11039, 11793,
+	12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+	18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+	23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+	27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+	30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+	32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+	32767
+};
+
+SPSC_STORAGE(tx_storage, MODEM_TX_SIZE, uchar_t);
+SPSC_STORAGE(rx_storage, MODEM_RX_SIZE, uchar_t);
+static spsc_t tx_ring, rx_ring;
+
+static fsm_machine_t machine;
+static modem_cfg_t cfg;
+static modem_stats_t stats;
+static volatile uint32_t timer;													// Samples to EV_TIMEOUT, 0 stopped
+
+static volatile bool rx_on;														// Carrier detector runs, written by the FSM only
+static volatile bool demod;														// Demodulator runs, written by the FSM only
+static volatile bool tx_on;														// Modulator runs, written by the FSM only
+static volatile bool sending;													// Modulator takes bytes, cleared by it when done
+
+static bool primed, carrier;													// Detector: line level seeded, carrier present
+static int32_t dc, env;
+static int32_t x1, x2, lpf1, lpf2;												// Discriminator: last two samples, low-pass
+static bool last;																// Deframer: previous bit
+static uint8_t rx_bits, rx_count, rx_byte;
+
+static uint32_t phase, step;													// Modulator: NCO
+static uint16_t tx_frame;
+static uint8_t tx_bits, tx_count;
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+bool modemInit (const modem_cfg_t* config, void (* notify)(void))
+{
+	if (!config || (config->carrier_off >= config->carrier_on) || (config->amplitude > SAMPLE_MASK / 2))
+		return false;
+
+	rx_on = demod = tx_on = sending = false;									// The ISRs leave everything alone
+	timer = 0;
+	cfg = *config;
+	stats = (modem_stats_t){ 0 };
+	spscInit(&tx_ring, tx_storage, MODEM_TX_SIZE, sizeof(uchar_t));
+	spscInit(&rx_ring, rx_storage, MODEM_RX_SIZE, sizeof(uchar_t));
+	fsmTableInit(&machine, &table[0][0], MODEM_STATES, MODEM_EVENTS, MODEM_IDLE, notify);
+
+	primed = false;
+	rx_on = true;																// Last, the ADC callback takes it from here
+
+	return true;
+}
+
+void modemSample (uint16_t sample)
+{
+	PROF_BEGIN(PROF_MODEM_RX);
+
+	if (timer && !--timer)
+		fsmPost(&machine, EV_TIMEOUT);
+	if (rx_on)
+		detect(sample & SAMPLE_MASK);
+	PROF_END(PROF_MODEM_RX);
+}
+
+uint16_t modemOutput (void)
+{
+	uchar_t byte;
+	uint16_t out;
+
+	if (!tx_on)
+		return MODEM_DAC_IDLE;
+
+	PROF_BEGIN(PROF_MODEM_TX);
+	stats.tx_samples++;
+	if (!tx_count)																// Next bit
+	{
+		tx_count = SAMPLES_PER_BIT;
+		if (!tx_bits && sending)
+		{
+			if (spscPop(&tx_ring, &byte))
+			{
+				tx_frame = FRAME_STOP | (byte << 1);							// LSB first, after a 0 start bit
+				tx_bits = FRAME_BITS;
+				stats.tx_bytes++;
+			}
+			else
+			{
+				sending = false;
+				fsmPost(&machine, EV_TX_DONE);
+			}
+		}
+		step = (!tx_bits || (tx_frame & 1)) ? NCO_STEP(MODEM_MARK_HZ) : NCO_STEP(MODEM_SPACE_HZ);	// Mark between bytes, phase continuous
+		if (tx_bits)
+		{
+			tx_frame >>= 1;
+			tx_bits--;
+		}
+	}
+	tx_count--;
+	PROF_BEGIN(PROF_FSK_MOD);													// NCO alone, framing left out
+	phase += step;
+	out = MODEM_DAC_IDLE + ((cfg.amplitude * sine(phase)) >> 15);
+	PROF_END(PROF_FSK_MOD);
+	PROF_END(PROF_MODEM_TX);
+
+	return out;
+}
+
+void modemUpdate (void)
+{
+	fsmRun(&machine);
+}
+
+uint16_t modemWrite (const uchar_t* data, uint16_t len)
+{
+	uint16_t n = 0;
+
+	while ((n < len) && spscPush(&tx_ring, &data[n]))
+		n++;
+	if (n)
+		fsmPost(&machine, EV_TX_REQUEST);										// Ignored unless idle, idle() asks again
+
+	return n;
+}
+
+uint16_t modemRead (uchar_t* data, uint16_t max)
+{
+	uint16_t n = 0;
+
+	while ((n < max) && spscPop(&rx_ring, &data[n]))
+		n++;
+
+	return n;
+}
+
+modem_state_t modemGetState (void)
+{
+	return (modem_state_t)fsmGetState(&machine);
+}
+
+modem_stats_t modemGetStats (void)
+{
+	return stats;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+// FSM callbacks ///////////////////////////////////////////////////////////////
+
+static void qualify (void)
+{
+	timer = TIMER(cfg.qualify_ms);
+}
+
+static void receive (void)
+{
+	x1 = x2 = lpf1 = lpf2 = 0;
+	last = false;																// The preamble, a mark, comes first
+	rx_bits = 0;
+	demod = true;																// Last, the ADC callback takes it from here
+}
+
+static void receiveEnd (void)
+{
+	demod = false;																// A byte halfway is lost
+	timer = TIMER(cfg.turnaround_ms);
+	stats.turnarounds++;
+}
+
+static void preamble (void)
+{
+	rx_on = false;
+	timer = TIMER(cfg.preamble_ms);
+	phase = 0;
+	tx_bits = tx_count = 0;														// Mark until sending
+	tx_on = true;
+}
+
+static void transmit (void)
+{
+	sending = true;
+}
+
+static void transmitEnd (void)
+{
+	tx_on = false;
+	timer = TIMER(cfg.turnaround_ms);
+	stats.turnarounds++;
+}
+
+static void idle (void)
+{
+	timer = 0;
+	if (!rx_on)
+	{
+		primed = false;
+		rx_on = true;
+	}
+	if (!spscIsEmpty(&tx_ring))
+		fsmPost(&machine, EV_TX_REQUEST);										// Queued while the line was busy
+}
+
+// Signal processing ///////////////////////////////////////////////////////////
+
+static void detect (int32_t sample)
+{
+	int32_t x = sample << FRAC, dev;
+
+	stats.rx_samples++;
+	if (!primed)
+	{
+		dc = x;
+		env = 0;
+		carrier = false;
+		primed = true;
+	}
+	dc += (x - dc) >> DC_SHIFT;
+	x = (x - dc) >> FRAC;
+	dev = (x < 0) ? -x : x;
+	env += ((dev << FRAC) - env) >> ENV_SHIFT;									// Mean deviation, Q8
+
+	if (carrier ? (env < (cfg.carrier_off << FRAC)) : (env >= (cfg.carrier_on << FRAC)))
+	{
+		carrier = !carrier;
+		fsmPost(&machine, carrier ? EV_CARRIER_ON : EV_CARRIER_OFF);
+	}
+	if (demod)
+		demodulate(x);
+}
+
+static void demodulate (int32_t x)
+{
+	int32_t product = x * x2;													// cos(2 pi f 2 / fs): positive on mark, negative on space
+	bool bit;
+	PROF_BEGIN(PROF_FSK_DEMOD);
+
+	x2 = x1;
+	x1 = x;
+	lpf1 += (product - lpf1) >> LPF_SHIFT;
+	lpf2 += (lpf1 - lpf2) >> LPF_SHIFT;
+	bit = lpf2 > 0;
+
+	if (!rx_bits)																// Hunting a start bit
+	{
+		if (last && !bit)
+		{
+			rx_bits = FRAME_BITS;
+			rx_count = SAMPLES_PER_BIT / 2;										// Sample mid-bit
+		}
+	}
+	else if (!--rx_count)
+	{
+		rx_count = SAMPLES_PER_BIT;
+		rx_bits--;
+		if (rx_bits == FRAME_BITS - 1)											// Start bit
+		{
+			if (bit)
+				rx_bits = 0;													// A glitch, hunt again
+		}
+		else if (rx_bits)
+			rx_byte = (rx_byte >> 1) | (bit << 7);
+		else if (!bit)
+			stats.framing++;
+		else if (spscPush(&rx_ring, &rx_byte))
+			stats.rx_bytes++;
+		else
+			stats.overruns++;
+	}
+	last = bit;
+	PROF_END(PROF_FSK_DEMOD);
+}
+
+static int32_t sine (uint32_t angle)
+{
+	uint8_t i = angle >> 24, j = i & 63;										// 256 steps a turn, 64 a quadrant
+
+	switch (i >> 6)
+	{
+		case 0:		return quarter[j];
+		case 1:		return quarter[64 - j];
+		case 2:		return -quarter[j];
+		default:	return -quarter[64 - j];
+	}
+}
+
+/******************************************************************************/
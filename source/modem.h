@@ -0,0 +1,165 @@
+/***************************************************************************//**
+  @file     modem.h
+  @brief    Half-duplex FSK modem (Bell 202): carrier detector, demodulator,
+            modulator and byte queues coordinated by a table-driven FSM
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     Samples in (ADC) and out (DAC) at MODEM_SAMPLE_HZ, bytes framed 8N1.
+            The receive DSP is skipped while transmitting and the modulator
+            while receiving: each path costs a flag check when it is off
+ ******************************************************************************/
+
+#ifndef _MODEM_H_
+#define _MODEM_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define MODEM_SAMPLE_HZ		13200U												// ADC and DAC rate, a multiple of the baud rate
+#define MODEM_BAUD			1200U
+#define MODEM_MARK_HZ		1200U												// '1', also the preamble
+#define MODEM_SPACE_HZ		2200U												// '0'
+
+#define MODEM_TX_SIZE		256U												// Bytes waiting to be sent, power of 2
+#define MODEM_RX_SIZE		256U												// Bytes received and not read yet, power of 2
+
+#define MODEM_DAC_IDLE		2048U												// Output when not transmitting, mid-scale
+
+#define MODEM_MS2SAMPLES(ms)	((uint32_t)(ms) * MODEM_SAMPLE_HZ / 1000U)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef unsigned char uchar_t;
+
+/**
+ * @brief Modem states
+ * @param MODEM_IDLE Line quiet, carrier detector on
+ * @param MODEM_CARRIER Carrier seen, waiting for it to last qualify_ms
+ * @param MODEM_RECEIVE Demodulating, modulator off
+ * @param MODEM_PREAMBLE Sending mark tone, receive DSP off
+ * @param MODEM_TRANSMIT Sending bytes, receive DSP off
+ * @param MODEM_TURNAROUND Line just went quiet, waiting turnaround_ms before anything else
+ */
+typedef enum {
+	MODEM_IDLE,
+	MODEM_CARRIER,
+	MODEM_RECEIVE,
+	MODEM_PREAMBLE,
+	MODEM_TRANSMIT,
+	MODEM_TURNAROUND,
+
+	MODEM_STATES
+} modem_state_t;
+
+/**
+ * @brief Modem configuration
+ * @param preamble_ms Mark tone before the first byte
+ * @param turnaround_ms Quiet time after either side stops, before transmitting or receiving again
+ * @param qualify_ms Time the carrier must last before demodulating
+ * @param carrier_on Envelope to detect the carrier (LSB, mean deviation)
+ * @param carrier_off Envelope to lose it, below carrier_on
+ * @param amplitude Output tone amplitude (DAC LSB, peak)
+ */
+typedef struct {
+	uint16_t	preamble_ms;
+	uint16_t	turnaround_ms;
+	uint16_t	qualify_ms;
+	uint16_t	carrier_on;
+	uint16_t	carrier_off;
+	uint16_t	amplitude;
+} modem_cfg_t;
+
+/**
+ * @brief Modem counters
+ * @param rx_bytes Bytes received
+ * @param tx_bytes Bytes sent
+ * @param framing Bytes received without a stop bit, discarded
+ * @param overruns Bytes received and lost, receive queue full
+ * @param rx_samples Samples through the receive DSP
+ * @param tx_samples Samples from the modulator
+ * @param turnarounds Times the line changed direction or went idle
+ */
+typedef struct {
+	uint32_t	rx_bytes;
+	uint32_t	tx_bytes;
+	uint32_t	framing;
+	uint32_t	overruns;
+	uint32_t	rx_samples;
+	uint32_t	tx_samples;
+	uint32_t	turnarounds;
+} modem_stats_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Initialize the modem, idle, queues empty
+ * @param cfg Configuration
+ * @param notify Called from the ISRs when modemUpdate has work, NULL for none
+ * @return Initialization succeed
+ */
+bool modemInit (const modem_cfg_t* cfg, void (* notify)(void));
+
+/**
+ * @brief Take an input sample, from the ADC callback
+ * @param sample 12-bit sample
+ * @note Also keeps the modem timers, in samples
+ */
+void modemSample (uint16_t sample);
+
+/**
+ * @brief Get the next output sample, from the DAC update at the same rate
+ * @return 12-bit sample, MODEM_DAC_IDLE when not transmitting
+ */
+uint16_t modemOutput (void);
+
+/**
+ * @brief Run the modem state machine, from the main loop
+ */
+void modemUpdate (void);
+
+/**
+ * @brief Queue bytes to send, sent once the line is free
+ * @param data Bytes
+ * @param len Number of bytes
+ * @return Bytes queued
+ */
+uint16_t modemWrite (const uchar_t* data, uint16_t len);
+
+/**
+ * @brief Take received bytes
+ * @param data Place to store them
+ * @param max Room in data
+ * @return Bytes taken
+ */
+uint16_t modemRead (uchar_t* data, uint16_t max);
+
+/**
+ * @brief Get the modem state
+ * @return Current state
+ */
+modem_state_t modemGetState (void);
+
+/**
+ * @brief Get the modem counters
+ * @return Counters since modemInit
+ */
+modem_stats_t modemGetStats (void);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _MODEM_H_
@@ -9,6 +9,8 @@
 
 #include "hardware.h"
 #include "pdb.h"
+#include "prof.h"
+#include "trace.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -165,6 +167,8 @@ __ISR__ PDB0_IRQHandler(void)
 #if DEBUG_PDB
 P_DEBUG_TP_SET
 #endif
+	PROF_BEGIN(PROF_PDB_ISR);
+	TRACE_BEGIN(TRACE_PDB, TRACE_PDB_ISR, 0);
 	/* Only for debugging purposes */
 	if (PDB_REG(PDB0_ID, SC) & PDB_SC_PDBIF_MASK)
 		PDB_REG(PDB0_ID, SC) &= ~PDB_SC_PDBIF_MASK;
@@ -172,6 +176,8 @@ P_DEBUG_TP_SET
 		if (PDB_REG(PDB0_ID, CH[i].S) & PDB_S_ERR_MASK)
 			PDB_REG(PDB0_ID, CH[i].S) &= ~PDB_S_CF_MASK & ~PDB_S_ERR_MASK;
 	/* Only for debugging purposes */
+	TRACE_END(TRACE_PDB, TRACE_PDB_ISR, 0);
+	PROF_END(PROF_PDB_ISR);
 #if DEBUG_PDB
 P_DEBUG_TP_CLR
 #endif
@@ -21,7 +21,7 @@
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
 
-#define PDB_FREQUENCY_HZ	1000
+#define PDB_FREQUENCY_HZ	13200												// ADC rate, the modem sample rate
 #define PDB_HZ2TICKS(f)		(PDB_FREQUENCY_HZ / (f))
 
 /*******************************************************************************
@@ -11,9 +11,13 @@
  * INCLUDE HEADER FILES
  ******************************************************************************/
 
+#include <stddef.h>
+
 #include "debug.h"
 #include "hardware.h"
 #include "pisr.h"
+#include "prof.h"
+#include "trace.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -25,19 +29,68 @@
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
-typedef struct {
+typedef struct funData {
+	struct funData* next;
 	pisr_callback_t funadrrs;
-	uint32_t time;
-	uint32_t counter;
+	uint32_t delta;		// Ticks after the previous one in the list
+	uint32_t time;		// Whole ticks between calls
+	uint32_t rest;		// Plus rest/rate of a tick, spread by the phase accumulator
+	uint32_t rate;
+	uint32_t phase;
+	bool linked;
+#if PISR_ACCOUNTING
+	pisr_stats_t stats;
+#endif
 } funData;
 
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Take a free entry and queue its first call
+ * @param fun PISR function
+ * @param time Whole ticks between calls, at least 1
+ * @param rest Fraction of a tick on top, over rate
+ * @param rate Denominator, at least 1
+ * @return Registration succeed
+ */
+static bool add (pisr_callback_t fun, uint32_t time, uint32_t rest, uint32_t rate);
+
+/**
+ * @brief Insert an entry in the delta-list, after those due at the same tick
+ * @param entry Entry, not linked
+ * @param ticks Ticks from now, at least 1
+ */
+static void link (funData* entry, uint32_t ticks);
+
+/**
+ * @brief Take an entry out of the delta-list, its successor keeps its time
+ * @param entry Entry, linked
+ */
+static void unlink (funData* entry);
+
+/**
+ * @brief Step the phase accumulator
+ * @param entry Entry
+ * @return Ticks until the next call
+ */
+static uint32_t advance (funData* entry);
+
+/**
+ * @brief Find a registered callback
+ * @param fun PISR function
+ * @return Entry, NULL if not registered
+ */
+static funData* find (pisr_callback_t fun);
+
 /*******************************************************************************
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
 static funData funArr[PISR_CANT];
+static funData* head;	// Next due, delta ticks from now
 static bool init_flag;
-static uint32_t count;
 
 /*******************************************************************************
  *******************************************************************************
@@ -47,6 +100,60 @@ static uint32_t count;
 
 bool pisrRegister (pisr_callback_t fun, unsigned int period)
 {
+	return fun && period && add(fun, period, 0, 1);
+}
+
+bool pisrRegisterHz (pisr_callback_t fun, uint32_t hz)
+{
+	return fun && hz && (hz <= PISR_FREQUENCY_HZ) && add(fun, PISR_FREQUENCY_HZ / hz, PISR_FREQUENCY_HZ % hz, hz);
+}
+
+bool pisrUnregister (pisr_callback_t fun)
+{
+	uint32_t primask = __get_PRIMASK();
+	funData* entry = NULL;
+
+	__disable_irq();
+	if (fun && (entry = find(fun)))
+	{
+		if (entry->linked) // Not if it is the one being called
+			unlink(entry);
+		entry->funadrrs = NULL;
+	}
+	__set_PRIMASK(primask);
+
+	return entry != NULL;
+}
+
+bool pisrGetStats (pisr_callback_t fun, pisr_stats_t* stats)
+{
+	uint32_t primask = __get_PRIMASK();
+	funData* entry = NULL;
+
+	__disable_irq();
+	if (fun && (entry = find(fun)))
+#if PISR_ACCOUNTING
+		*stats = entry->stats;
+#else
+		*stats = (pisr_stats_t){ 0 };
+#endif
+	__set_PRIMASK(primask);
+
+	return entry != NULL;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+                        LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static bool add (pisr_callback_t fun, uint32_t time, uint32_t rest, uint32_t rate)
+{
+	uint32_t primask = __get_PRIMASK();
+	funData* entry;
+
+	__disable_irq();
 	if(!init_flag) // Initialize SysTick
 	{
 		SysTick->CTRL = 0x00;
@@ -56,34 +163,104 @@ bool pisrRegister (pisr_callback_t fun, unsigned int period)
 
 		init_flag = true;
 	}
-	
-	if(count < PISR_CANT) // Load the function and its period
+
+	if((entry = find(NULL))) // Load the function and its period
 	{
-		funArr[count].funadrrs = fun;
-		funArr[count].time = period;
-		funArr[count++].counter = period;
+		*entry = (funData){ .funadrrs = fun, .time = time, .rest = rest, .rate = rate };
+		link(entry, advance(entry));
 	}
+	__set_PRIMASK(primask);
 
-	return !init_flag;
+	return entry != NULL;
 }
 
-/*******************************************************************************
- *******************************************************************************
-                        LOCAL FUNCTION DEFINITIONS
- *******************************************************************************
- ******************************************************************************/
+static void link (funData* entry, uint32_t ticks)
+{
+	funData** prev = &head;
+
+	while (*prev && ((*prev)->delta <= ticks))
+	{
+		ticks -= (*prev)->delta;
+		prev = &(*prev)->next;
+	}
+	entry->delta = ticks;
+	entry->next = *prev;
+	if (entry->next)
+		entry->next->delta -= ticks;
+	*prev = entry;
+	entry->linked = true;
+}
+
+static void unlink (funData* entry)
+{
+	funData** prev = &head;
+
+	while (*prev != entry)
+		prev = &(*prev)->next;
+	if (entry->next)
+		entry->next->delta += entry->delta;
+	*prev = entry->next;
+	entry->linked = false;
+}
+
+static uint32_t advance (funData* entry)
+{
+	uint32_t ticks = entry->time;
+
+	entry->phase += entry->rest;
+	if (entry->phase >= entry->rate) // Bresenham: the remainder adds up to a whole tick now and then
+	{
+		entry->phase -= entry->rate;
+		ticks++;
+	}
+
+	return ticks;
+}
+
+static funData* find (pisr_callback_t fun)
+{
+	for(int i = 0; i < PISR_CANT; i++)
+		if(funArr[i].funadrrs == fun)
+			return &funArr[i];
+
+	return NULL;
+}
 
 __ISR__ SysTick_Handler(void)
 {
 #if DEBUG_PISR
 P_DEBUG_TP_SET
 #endif
-	for(int i = 0; i < count ; i++)
-		if(--((funArr[i]).counter) == 0)
-		{
-			(funArr[i]).funadrrs();
-			(funArr[i]).counter = (funArr[i]).time;
-		}
+	PROF_BEGIN(PROF_SYSTICK_ISR);
+	TRACE_BEGIN(TRACE_PISR, TRACE_SYSTICK_ISR, 0);
+	if(head)
+		head->delta--;
+	while(head && !head->delta) // Only the ones due, in order
+	{
+		funData* entry = head;
+		pisr_callback_t fun = entry->funadrrs;
+#if PISR_ACCOUNTING
+		uint32_t before = SysTick->VAL, after;
+#endif
+
+		head = entry->next;
+		entry->linked = false;
+		fun();
+#if PISR_ACCOUNTING
+		after = SysTick->VAL;
+#endif
+		if(entry->funadrrs != fun || entry->linked) // Unregistered, or its entry taken again, while it ran
+			continue;
+#if PISR_ACCOUNTING
+		entry->stats.last = (before >= after) ? before - after : before + SYSTICK_LOAD_INIT + 1U - after; // Counts down, may reload once
+		entry->stats.max = (entry->stats.last > entry->stats.max) ? entry->stats.last : entry->stats.max;
+		entry->stats.total += entry->stats.last;
+		entry->stats.calls++;
+#endif
+		link(entry, advance(entry));
+	}
+	TRACE_END(TRACE_PISR, TRACE_SYSTICK_ISR, 0);
+	PROF_END(PROF_SYSTICK_ISR);
 #if DEBUG_PISR
 P_DEBUG_TP_CLR
 #endif
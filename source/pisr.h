@@ -2,6 +2,9 @@
   @file     pisr.h
   @brief    Periodic Interrupt (PISR) driver
   @author   Group 4
+  @note     Callbacks wait in a delta-list, each SysTick only touches the
+            ones due. Rates need not divide PISR_FREQUENCY_HZ: a phase
+            accumulator spreads the remainder, one tick of jitter at most.
  ******************************************************************************/
 
 #ifndef _PISR_H_
@@ -21,12 +24,30 @@
 #define PISR_FREQUENCY_HZ	2000U
 #define PISR_CANT			8
 
+#ifndef PISR_ACCOUNTING
+#define PISR_ACCOUNTING		0	// Time every callback, off SysTick's own counter
+#endif
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
 typedef void (*pisr_callback_t) (void);
 
+/**
+ * @brief Callback execution time, in core clock cycles
+ * @param calls Times called
+ * @param last Last call
+ * @param max Longest call
+ * @param total Every call
+ */
+typedef struct {
+	uint32_t	calls;
+	uint32_t	last;
+	uint32_t	max;
+	uint64_t	total;
+} pisr_stats_t;
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -39,6 +60,29 @@ typedef void (*pisr_callback_t) (void);
  */
 bool pisrRegister (pisr_callback_t fun, unsigned int period);
 
+/**
+ * @brief Register PISR callback at a rate
+ * @param fun PISR function to be call periodically
+ * @param hz Calls per second, up to PISR_FREQUENCY_HZ, exact on average
+ * @return Registration succeed
+ */
+bool pisrRegisterHz (pisr_callback_t fun, uint32_t hz);
+
+/**
+ * @brief Unregister PISR callback, may be called from any callback
+ * @param fun PISR function registered
+ * @return It was registered
+ */
+bool pisrUnregister (pisr_callback_t fun);
+
+/**
+ * @brief Get a callback's execution time
+ * @param fun PISR function registered
+ * @param stats Filled, zeros unless PISR_ACCOUNTING
+ * @return It is registered
+ */
+bool pisrGetStats (pisr_callback_t fun, pisr_stats_t* stats);
+
 /*******************************************************************************
  ******************************************************************************/
 
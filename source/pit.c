@@ -16,6 +16,8 @@
 
 #include "hardware.h"
 #include "pit.h"
+#include "prof.h"
+#include "trace.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -23,7 +25,7 @@
 
 #define DEVELOPMENT_MODE					1
 
-#define PIT_CLOCK							(__CORE_CLOCK__ / 2)
+#define PIT_CLOCK							PIT_CLOCK_HZ
 #define PIT_HZ_TO_TICKS(freq)				(PIT_CLOCK / (freq))
 #define PIT_REG(id, reg)					(PIT_Ptrs[id]->reg)
 
@@ -47,6 +49,11 @@ typedef struct {
  */
 static void handler (pit_id_t id);
 
+/**
+ * @brief Clock the PIT module and let it run
+ */
+static void enable (void);
+
 /*******************************************************************************
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
@@ -57,6 +64,7 @@ static uint8_t const PIT_IRQn[] = PIT_IRQS;
 static bool init_flags[PIT_CANT_IDS];
 static pit_t pit_callbacks[PIT_MAX_CALLBACKS][PIT_CANT_IDS];
 static uint8_t pit_count = 0;
+static callback_t pit_oneshot[PIT_CANT_IDS];									// Channels counting once
 
 /*******************************************************************************
  *******************************************************************************
@@ -74,10 +82,10 @@ bool PIT_Init (pit_id_t id, callback_t callback, uint32_t freq)
 
 		NVIC_EnableIRQ(PIT_IRQn[id]); // Enable PIT IRQ
 
-		PIT_REG(id, MCR) &= ~PIT_MCR_MDIS_MASK & ~PIT_MCR_FRZ_MASK; // PIT Module enable
-		PIT_REG(id, CHANNEL[id].LDVAL) = PIT_HZ_TO_TICKS(PIT_FREQUENCY_HZ) - 1;
-		// PIT_REG(id, CHANNEL[id].TCTRL) |= PIT_TCTRL_TIE_MASK; // PIT interrupt enable is not used
-		PIT_REG(id, CHANNEL[id].TCTRL) |= PIT_TCTRL_TEN_MASK;
+		PIT_REG(0, MCR) &= ~PIT_MCR_MDIS_MASK & ~PIT_MCR_FRZ_MASK; // PIT Module enable
+		PIT_REG(0, CHANNEL[id].LDVAL) = PIT_HZ_TO_TICKS(PIT_FREQUENCY_HZ) - 1;
+		// PIT_REG(0, CHANNEL[id].TCTRL) |= PIT_TCTRL_TIE_MASK; // PIT interrupt enable is not used
+		PIT_REG(0, CHANNEL[id].TCTRL) |= PIT_TCTRL_TEN_MASK;
 
 		init_flags[id] = true;
 	}
@@ -92,6 +100,49 @@ bool PIT_Init (pit_id_t id, callback_t callback, uint32_t freq)
 	return !(init_flags[id] && status);
 }
 
+void PIT_InitLifetime (void)
+{
+	enable();
+
+	PIT_REG(0, CHANNEL[PIT_LIFETIME_HIGH].TCTRL) = 0;
+	PIT_REG(0, CHANNEL[PIT_LIFETIME_LOW].TCTRL) = 0;
+	PIT_REG(0, CHANNEL[PIT_LIFETIME_HIGH].LDVAL) = 0xFFFFFFFF;
+	PIT_REG(0, CHANNEL[PIT_LIFETIME_LOW].LDVAL) = 0xFFFFFFFF;
+	PIT_REG(0, CHANNEL[PIT_LIFETIME_HIGH].TCTRL) = PIT_TCTRL_CHN_MASK | PIT_TCTRL_TEN_MASK;	// Counts the low one's wraps
+	PIT_REG(0, CHANNEL[PIT_LIFETIME_LOW].TCTRL) = PIT_TCTRL_TEN_MASK;
+}
+
+uint64_t PIT_GetLifetime (void)
+{
+	uint32_t high, low;
+
+	do {																		// The high half does not move while the low one is read
+		high = PIT_REG(0, CHANNEL[PIT_LIFETIME_HIGH].CVAL);
+		low = PIT_REG(0, CHANNEL[PIT_LIFETIME_LOW].CVAL);
+	} while (high != PIT_REG(0, CHANNEL[PIT_LIFETIME_HIGH].CVAL));
+
+	return ~(((uint64_t)high << 32) | low);										// Both count down from all ones
+}
+
+void PIT_OneShot (pit_id_t id, uint32_t counts, callback_t fun)
+{
+	enable();
+	NVIC_EnableIRQ(PIT_IRQn[id]);
+
+	pit_oneshot[id] = fun;
+	PIT_REG(0, CHANNEL[id].TCTRL) = 0;											// A new LDVAL only loads on (re)enable
+	PIT_REG(0, CHANNEL[id].TFLG) = PIT_TFLG_TIF_MASK;
+	PIT_REG(0, CHANNEL[id].LDVAL) = counts ? counts - 1 : 0;
+	PIT_REG(0, CHANNEL[id].TCTRL) = PIT_TCTRL_TIE_MASK | PIT_TCTRL_TEN_MASK;
+}
+
+void PIT_Stop (pit_id_t id)
+{
+	PIT_REG(0, CHANNEL[id].TCTRL) = 0;
+	PIT_REG(0, CHANNEL[id].TFLG) = PIT_TFLG_TIF_MASK;
+	pit_oneshot[id] = NULL;
+}
+
 /*******************************************************************************
  *******************************************************************************
 						LOCAL FUNCTION DEFINITIONS
@@ -110,9 +161,19 @@ static void handler (pit_id_t id)
 #if DEBUG_PIT
 P_DEBUG_TP_SET
 #endif
-	PIT_REG(id, CHANNEL[id].TFLG) = PIT_TFLG_TIF_MASK; // Clear interrupt flag
+	PROF_BEGIN(PROF_PIT_ISR);
+	TRACE_BEGIN(TRACE_PIT, TRACE_PIT_ISR, id);
+	PIT_REG(0, CHANNEL[id].TFLG) = PIT_TFLG_TIF_MASK; // Clear interrupt flag
 
-	if (id < PIT_CANT_IDS)
+	if (pit_oneshot[id])
+	{
+		callback_t fun = pit_oneshot[id];
+
+		PIT_REG(0, CHANNEL[id].TCTRL) = 0;										// Once: stopped before the callback, which may start it again
+		pit_oneshot[id] = NULL;
+		fun();
+	}
+	else if (id < PIT_CANT_IDS)
 	{
 		for(uint8_t i = 0; i < pit_count; i++)
 		{
@@ -125,6 +186,8 @@ P_DEBUG_TP_SET
 				pit_callbacks[i][id].counter--;
 		}
 	}
+	TRACE_END(TRACE_PIT, TRACE_PIT_ISR, id);
+	PROF_END(PROF_PIT_ISR);
 #if DEBUG_PIT
 P_DEBUG_TP_CLR
 #endif
@@ -132,4 +195,10 @@ P_DEBUG_TP_CLR
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static void enable (void)
+{
+	SIM->SCGC6 |= SIM_SCGC6_PIT_MASK; // Clock Gating for PIT
+	PIT_REG(0, MCR) &= ~PIT_MCR_MDIS_MASK & ~PIT_MCR_FRZ_MASK; // PIT Module enable
+}
+
 /******************************************************************************/
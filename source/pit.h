@@ -28,6 +28,10 @@
 #define PIT_HZ2TICKS(f)		(PIT_FREQUENCY_HZ / (f))
 #define PIT_MAX_CALLBACKS	8 // Per channel
 
+#define PIT_CLOCK_HZ		(__CORE_CLOCK__ / 2)								// Bus clock, what the channels count
+#define PIT_LIFETIME_LOW	PIT0_ID												// Chained, free-running 64-bit counter
+#define PIT_LIFETIME_HIGH	PIT1_ID
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
@@ -57,6 +61,32 @@ typedef enum {
  */
 bool PIT_Init(pit_id_t id, callback_t fun, uint32_t freq);
 
+/**
+ * @brief Start the lifetime counter: PIT_LIFETIME_LOW and PIT_LIFETIME_HIGH chained, no interrupts
+ */
+void PIT_InitLifetime(void);
+
+/**
+ * @brief Read the lifetime counter
+ * @return Bus clock cycles since PIT_InitLifetime
+ */
+uint64_t PIT_GetLifetime(void);
+
+/**
+ * @brief Call back once, after some bus clock cycles
+ * @param id PIT channel, not a lifetime one
+ * @param counts Cycles to wait, at least 1
+ * @param fun Function called from the interrupt, the channel is stopped by then
+ * @note Restarts the channel if it was already counting
+ */
+void PIT_OneShot(pit_id_t id, uint32_t counts, callback_t fun);
+
+/**
+ * @brief Stop a one-shot channel before it calls back
+ * @param id PIT channel
+ */
+void PIT_Stop(pit_id_t id);
+
 /*******************************************************************************
  ******************************************************************************/
 
@@ -0,0 +1,189 @@
+/***************************************************************************//**
+  @file     prof.c
+  @brief    Profiling zones: min, max, mean and a histogram of the time spent
+            in every ISR and DSP stage
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+
+#include "prof.h"
+
+#if PROF_ZONES
+
+#if PROF_HOST
+#include <time.h>
+#endif
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define CALIBRATION_RUNS	16
+
+#if PROF_HOST																	// Threads stand in for the ISRs
+#define LOCK()				while (__atomic_test_and_set(&lock, __ATOMIC_ACQUIRE)) {}
+#define UNLOCK()			__atomic_clear(&lock, __ATOMIC_RELEASE)
+#else
+#define LOCK()				uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define UNLOCK()			__set_PRIMASK(primask)
+#endif
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const char* const names[PROF_CANT] = {
+	[PROF_ADC_ISR]		= "adc_isr",
+	[PROF_DMA_ISR]		= "dma_isr",
+	[PROF_GPIO_ISR]		= "gpio_isr",
+	[PROF_PDB_ISR]		= "pdb_isr",
+	[PROF_PIT_ISR]		= "pit_isr",
+	[PROF_SYSTICK_ISR]	= "systick_isr",
+	[PROF_UART_UPDATE]	= "uart_update",
+	[PROF_FSK_MOD]		= "fsk_mod",
+	[PROF_FSK_DEMOD]	= "fsk_demod",
+	[PROF_MODEM_RX]		= "modem_rx",
+	[PROF_MODEM_TX]		= "modem_tx",
+	[PROF_QUEUE_PUSH]	= "queue_push",
+	[PROF_QUEUE_POP]	= "queue_pop",
+	[PROF_SPSC_PUSH]	= "spsc_push",
+	[PROF_SPSC_POP]		= "spsc_pop",
+};
+
+static prof_stats_t zones[PROF_CANT];
+static uint32_t bias;															// What an empty zone measures
+#if PROF_HOST
+static bool lock;
+#endif
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void profInit (void)
+{
+	uint32_t begin, least = UINT32_MAX;
+
+#if !PROF_HOST
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;								// Trace clocked, DWT registers alive
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+	for (uint8_t i = 0; i < CALIBRATION_RUNS; i++)
+	{
+		begin = profNow();
+		begin = profNow() - begin;
+		least = (begin < least) ? begin : least;
+	}
+	bias = least;
+	profReset();
+}
+
+#if PROF_HOST
+uint32_t profNow (void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint32_t)((uint64_t)now.tv_sec * 1000000000U + now.tv_nsec);
+}
+#endif
+
+void profRecord (prof_zone_t zone, uint32_t elapsed)
+{
+	prof_stats_t* stats = &zones[zone];
+	uint8_t bucket;
+
+	elapsed = (elapsed > bias) ? elapsed - bias : 0;
+	bucket = elapsed ? 32 - __builtin_clz(elapsed) : 0;							// Bits it takes
+	if (bucket >= PROF_BUCKETS)
+		bucket = PROF_BUCKETS - 1;
+
+	LOCK();
+	if (!stats->count || (elapsed < stats->min))
+		stats->min = elapsed;
+	if (elapsed > stats->max)
+		stats->max = elapsed;
+	stats->total += elapsed;
+	stats->histogram[bucket]++;
+	stats->count++;
+	UNLOCK();
+}
+
+bool profGet (prof_zone_t zone, prof_stats_t* stats)
+{
+	if (zone >= PROF_CANT)
+		return false;
+
+	LOCK();
+	*stats = zones[zone];
+	UNLOCK();
+
+	return true;
+}
+
+void profReset (void)
+{
+	LOCK();
+	for (uint8_t i = 0; i < PROF_CANT; i++)
+		zones[i] = (prof_stats_t){ 0 };
+	UNLOCK();
+}
+
+size_t profDump (char* buffer, size_t size)
+{
+	prof_stats_t stats;
+	size_t len = 0, line;
+	int n;
+
+	if (!size)
+		return 0;
+	*buffer = '\0';
+
+	n = snprintf(buffer, size, "zone count min mean max (%s) histogram (log2)\n", PROF_UNIT);
+	if ((n < 0) || ((size_t)n >= size))
+	{
+		*buffer = '\0';
+		return 0;
+	}
+	len = n;
+
+	for (uint8_t i = 0; i < PROF_CANT; i++)
+	{
+		if (!profGet(i, &stats) || !stats.count)
+			continue;
+
+		line = len;
+		n = snprintf(buffer + line, size - line, "%s %lu %lu %lu %lu", names[i], (unsigned long)stats.count,
+					 (unsigned long)stats.min, (unsigned long)(stats.total / stats.count), (unsigned long)stats.max);
+		for (uint8_t b = 0; (n >= 0) && (line + n < size) && (b < PROF_BUCKETS); b++)
+		{
+			line += n;
+			n = snprintf(buffer + line, size - line, (b < PROF_BUCKETS - 1) ? " %lu" : " %lu\n", (unsigned long)stats.histogram[b]);
+		}
+		if ((n < 0) || (line + n >= size))										// Whole lines only
+		{
+			buffer[len] = '\0';
+			break;
+		}
+		len = line + n;
+	}
+
+	return len;
+}
+
+#endif // PROF_ZONES
+
+/******************************************************************************/
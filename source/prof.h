@@ -0,0 +1,159 @@
+/***************************************************************************//**
+  @file     prof.h
+  @brief    Profiling zones: min, max, mean and a histogram of the time spent
+            in every ISR and DSP stage
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     On the K64F zones count core cycles off the DWT cycle counter,
+            on the host nanoseconds off a monotonic clock, so benchmarks
+            and the board share the same instrumentation. A zone is a
+            PROF_BEGIN / PROF_END pair in the same block. On by default on
+            the board, opt-in on the host (-DPROF_ZONES=1), where reading
+            the clock costs more than a queue op.
+ ******************************************************************************/
+
+#ifndef _PROF_H_
+#define _PROF_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#ifndef PROF_HOST
+#ifdef __arm__
+#define PROF_HOST			0
+#else
+#define PROF_HOST			1													// Off the board: a monotonic clock stands in for the cycle counter
+#endif
+#endif
+
+#ifndef PROF_ZONES
+#define PROF_ZONES			(!PROF_HOST)										// 1 to time the zones, 0 compiles them out
+#endif
+
+#if !PROF_HOST
+#include "hardware.h"
+#endif
+
+#define PROF_BUCKETS		16													// Histogram, bucket i > 0 counts [2^(i-1), 2^i), the last one everything above
+#define PROF_UNIT			(PROF_HOST ? "ns" : "cycles")
+
+#if PROF_ZONES
+#define PROF_BEGIN(zone)	uint32_t prof_begin_##zone = profNow()
+#define PROF_END(zone)		profRecord((zone), profNow() - prof_begin_##zone)
+#else
+#define PROF_BEGIN(zone)	((void)0)
+#define PROF_END(zone)		((void)0)
+#endif
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef enum {
+	PROF_ADC_ISR,
+	PROF_DMA_ISR,
+	PROF_GPIO_ISR,
+	PROF_PDB_ISR,
+	PROF_PIT_ISR,
+	PROF_SYSTICK_ISR,
+	PROF_UART_UPDATE,															// UART interrupts, and the PISR polling
+	PROF_FSK_MOD,																// Modem NCO, per DAC sample
+	PROF_FSK_DEMOD,																// Modem discriminator and bit slicer, per ADC sample with carrier
+	PROF_MODEM_RX,																// Modem sample in, carrier detection included
+	PROF_MODEM_TX,																// Modem sample out, bit framing included
+	PROF_QUEUE_PUSH,
+	PROF_QUEUE_POP,
+	PROF_SPSC_PUSH,
+	PROF_SPSC_POP,
+	PROF_CANT
+} prof_zone_t;
+
+/**
+ * @brief Zone statistics, in PROF_UNIT
+ * @param count Times run
+ * @param min Shortest run
+ * @param max Longest run
+ * @param total Every run, for the mean
+ * @param histogram Runs by duration, log2 buckets
+ */
+typedef struct {
+	uint32_t	count;
+	uint32_t	min;
+	uint32_t	max;
+	uint64_t	total;
+	uint32_t	histogram[PROF_BUCKETS];
+} prof_stats_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+#if PROF_ZONES
+
+/**
+ * @brief Start the cycle counter and measure what a zone costs empty, subtracted from every run
+ */
+void profInit (void);
+
+/**
+ * @brief Read the free-running time base
+ * @return Cycles, or nanoseconds on the host, wrapping
+ */
+#if PROF_HOST
+uint32_t profNow (void);
+#else
+static inline uint32_t profNow (void) { return DWT->CYCCNT; }
+#endif
+
+/**
+ * @brief Add a run to a zone, from any context
+ * @param zone Zone
+ * @param elapsed Time spent, as profNow counts
+ */
+void profRecord (prof_zone_t zone, uint32_t elapsed);
+
+/**
+ * @brief Take a snapshot of a zone
+ * @param zone Zone
+ * @param stats Place to store the snapshot
+ * @return Snapshot was taken
+ */
+bool profGet (prof_zone_t zone, prof_stats_t* stats);
+
+/**
+ * @brief Clear every zone
+ */
+void profReset (void);
+
+/**
+ * @brief Print every zone run at least once, one line each
+ * @param buffer Text, NUL terminated
+ * @param size Buffer size, lines that do not fit are left out
+ * @return Length written
+ */
+size_t profDump (char* buffer, size_t size);
+
+#else
+
+static inline void profInit (void) {}
+static inline bool profGet (prof_zone_t zone, prof_stats_t* stats) { (void)zone; (void)stats; return false; }
+static inline void profReset (void) {}
+static inline size_t profDump (char* buffer, size_t size) { if (size) *buffer = '\0'; return 0; }
+
+#endif // PROF_ZONES
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _PROF_H_
@@ -1,6 +1,7 @@
 /***************************************************************************//**
   @file     protocol.c
   @brief    Data frame packer and unpacker, using angle protocol 'R+123'
+            or COBS-stuffed binary frames
   @author   Group 4: - Oms, Mariano
                      - Solari Raigoso, Agustín
                      - Wickham, Tomás
@@ -22,25 +23,234 @@
 
 #define DEVELOPMENT_MODE			1
 
+#define CRC16_INIT					0xFFFF
+#define CRC16_UPDATE(crc, byte)		((uint16_t)((crc) << 8) ^ crc16_table[((crc) >> 8) ^ (uint8_t)(byte)])
+
+#define ZIGZAG_ENCODE(d)			(((uint32_t)(d) << 1) ^ (uint32_t)-((uint32_t)(d) >> 31))	// Small |d|, few bytes
+#define ZIGZAG_DECODE(z)			(((z) >> 1) ^ (uint32_t)-((z) & 1))
+
+#define DIGIT(c)					((uint32_t)ASCII2NUM(c))					// Above 9 if c is not a digit
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/**
+ * @brief COBS encoder state, bytes go straight to the frame
+ * @param out Frame
+ * @param len Bytes written
+ * @param code Position of the pending code byte
+ * @param crc CRC of the payload so far
+ */
+typedef struct {
+	uchar_t*	out;
+	size_t		len;
+	size_t		code;
+	uint16_t	crc;
+} cobs_t;
+
+/**
+ * @brief COBS decoder state, bytes come straight from the frame
+ * @param in Frame
+ * @param len Frame length
+ * @param pos Next byte to read
+ * @param left Data bytes left in the current block
+ * @param zero The current block ends in a stuffed zero
+ * @param error The frame ended inside a block
+ * @param crc CRC of the payload so far, 0 after a good CRC
+ */
+typedef struct {
+	const uchar_t*	in;
+	size_t			len;
+	size_t			pos;
+	uint8_t			left;
+	bool			zero;
+	bool			error;
+	uint16_t		crc;
+} cobs_reader_t;
+
+/**
+ * @brief Streaming parser states
+ */
+typedef enum {
+	PARSE_ID,																	// ASCII
+	PARSE_SIGN,
+	PARSE_DIGITS,
+	PARSE_START,																// Binary, before the first code byte
+	PARSE_TAG,
+	PARSE_SEQ,
+	PARSE_COUNT,
+	PARSE_RECORD,
+	PARSE_VAL,
+	PARSE_CRC,
+	PARSE_SKIP																	// Malformed, wait for the next delimiter
+} parse_state_t;
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
 /**
- * @brief Convert a number to a string (no terminator)
+ * @brief Convert a number to a string (no terminator), two digits at a time
  * @param num Number to convert
- * @param chars String to store the number
+ * @param chars String to store the number, MAX_DIGS bytes
  * @return Number of digits in the number (string length)
  */
-uint8_t __Num2Chars__ (const uint16_t num, uchar_t* chars);
+uint8_t __Num2Chars__ (uint32_t num, uchar_t* chars);
 
 /**
  * @brief Convert a string (no terminator) to a number
  * @param chars String to convert
  * @param len Length of the string (number of digits)
- * @return Number converted
+ * @param num Place to store the number converted
+ * @return False if empty, too long, a byte is not a digit or num overflows
+ */
+bool __Chars2Num__ (const uchar_t* chars, uint8_t len, uint32_t* num);
+
+/**
+ * @brief Stuff one byte into a COBS frame
+ * @param cobs Encoder state
+ * @param byte Byte to add
+ */
+static void cobsPut (cobs_t* cobs, uchar_t byte);
+
+/**
+ * @brief Add one payload byte to a frame
+ * @param cobs Encoder state
+ * @param byte Byte to add
+ */
+static void framePut (cobs_t* cobs, uchar_t byte);
+
+/**
+ * @brief Add a value to a frame, little-endian
+ * @param cobs Encoder state
+ * @param val Value to add
+ */
+static void putVal (cobs_t* cobs, protocol_val_t val);
+
+/**
+ * @brief Append the CRC and the delimiter
+ * @param cobs Encoder state
+ * @return Frame length, delimiter included
+ */
+static size_t frameClose (cobs_t* cobs);
+
+/**
+ * @brief Take one payload byte from a frame
+ * @param reader Decoder state
+ * @param byte Place to store the byte
+ * @return False at the end of the frame, or on error
  */
-int16_t __Chars2Num__ (uchar_t* const chars, const int8_t len);
+static bool frameGet (cobs_reader_t* reader, uchar_t* byte);
+
+/**
+ * @brief Forget every last value, the sequence number carries on
+ * @param ctx Delta context
+ */
+static void deltaClear (protocol_delta_t* ctx);
+
+/**
+ * @brief Value a delta applies to: the same id earlier in the frame, or in the context
+ * @param ctx Delta context
+ * @param data Records of the frame so far
+ * @param i Record being decoded
+ * @return Base value
+ */
+static protocol_val_t deltaBase (const protocol_delta_t* ctx, const protocol_t* data, uint8_t i);
+
+/**
+ * @brief Move a context past a frame that checked out
+ * @param ctx Delta context
+ * @param data Records of the frame
+ * @param count Number of records
+ * @param delta False for a key frame
+ * @param seq Frame sequence number
+ */
+static void deltaCommit (protocol_delta_t* ctx, const protocol_t* data, uint8_t count, bool delta, uchar_t seq);
+
+/**
+ * @brief Streaming parser, one ASCII byte
+ * @param p Parser state
+ * @param byte Byte received
+ * @return Number of records delivered
+ */
+static uint32_t parseAscii (protocol_parser_t* p, uchar_t byte);
+
+/**
+ * @brief Streaming parser, one binary byte: unstuff, then parse the payload
+ * @param p Parser state
+ * @param byte Byte received
+ * @return Number of records delivered
+ */
+static uint32_t parseBinary (protocol_parser_t* p, uchar_t byte);
+
+/**
+ * @brief Streaming parser, one unstuffed payload byte
+ * @param p Parser state
+ * @param byte Payload byte
+ */
+static void parsePayload (protocol_parser_t* p, uchar_t byte);
+
+/**
+ * @brief Streaming parser, delimiter: check the frame and deliver its records
+ * @param p Parser state
+ * @return Number of records delivered
+ */
+static uint32_t parseEnd (protocol_parser_t* p);
+
+/**
+ * @brief Streaming parser, get ready for the next frame
+ * @param p Parser state
+ */
+static void parseReset (protocol_parser_t* p);
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const char digit_pairs[200] =											// "00" to "99"
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+static const uint32_t pow10[MAX_DIGS] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+static const uint16_t crc16_table[256] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+	0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+	0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+	0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+	0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+	0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+	0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+	0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+	0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+	0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+	0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+	0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+	0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+	0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+	0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+	0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+	0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+	0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+	0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+	0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+	0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+	0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+	0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+	0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+	0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+	0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+	0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+	0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+	0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+	0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
 
 /*******************************************************************************
  *******************************************************************************
@@ -50,7 +260,8 @@ int16_t __Chars2Num__ (uchar_t* const chars, const int8_t len);
 
 uint8_t protocolPack (protocol_t* const data, uchar_t chars[PROTOCOL_DIGS])
 {
-	uint8_t len, index = 1;
+	uint8_t index = 1;
+	uint32_t num = (uint32_t)data->val;
 
 	chars[0] = data->id;
 
@@ -58,75 +269,598 @@ uint8_t protocolPack (protocol_t* const data, uchar_t chars[PROTOCOL_DIGS])
 	{
 		chars[1] = '-';
 		index = 2;
+		num = 0U - num;															// INT32_MIN too
 	}
 
-	len = __Num2Chars__(ABS(data->val), chars + index);
-	if(!len) { index = 0; }
-
-	return len + index;
+	return index + __Num2Chars__(num, chars + index);
 }
 
 protocol_t* protocolUnpack (uchar_t* const msg, const uint8_t len)
 {
 	static protocol_t data;
 	uint8_t index = 1;
+	bool neg = false;
+	uint32_t num;
 
 	data = (protocol_t){ 0, 0 };
 	if (len > 1)
 	{
-		if (msg[1] == '+' || msg[1] == '-') { index = 2; }
-		if (len - index <= MAX_DIGS)
+		if (msg[1] == '+' || msg[1] == '-') { index = 2; neg = msg[1] == '-'; }
+		if (__Chars2Num__(msg + index, len - index, &num) && (num <= (uint32_t)INT32_MAX + neg))
 		{
 			data.id = msg[0];
-			data.val = __Chars2Num__(msg + index, len - index) * ((msg[1] == '-') ? -1 : 1);
+			data.val = (protocol_val_t)(neg ? 0U - num : num);
 		}
 	}
 
 	return &data;
 }
 
+size_t protocolPackFrame (const protocol_t* data, uint8_t count, uchar_t* frame)
+{
+	cobs_t cobs = { frame, 1, 0, CRC16_INIT };
+
+	for (uint8_t i = 0; i < MIN(count, PROTOCOL_MAX_RECORDS); i++)
+	{
+		framePut(&cobs, data[i].id);
+		putVal(&cobs, data[i].val);
+	}
+
+	return frameClose(&cobs);
+}
+
+int16_t protocolUnpackFrame (const uchar_t* frame, size_t len, protocol_t* data, uint8_t max)
+{
+	cobs_reader_t reader = { frame, len, 0, 0, false, false, CRC16_INIT };
+	uchar_t window[PROTOCOL_RECORD_SIZE + PROTOCOL_CRC_SIZE];					// The last 2 bytes may turn out to be the CRC
+	uint8_t fill = 0, count = 0;
+	bool valid = true;
+
+	while (valid && frameGet(&reader, &window[fill]))
+		if (++fill == sizeof(window))
+		{
+			if ((valid = count < max))
+			{
+				data[count].id = window[0];
+				data[count].val = 0;
+				for (uint8_t k = sizeof(protocol_val_t); k; k--)				// Little-endian
+					data[count].val = (protocol_val_t)(((uint32_t)data[count].val << 8) | window[k]);
+				count++;
+			}
+			for (fill = 0; fill < PROTOCOL_CRC_SIZE; fill++)
+				window[fill] = window[PROTOCOL_RECORD_SIZE + fill];
+		}
+
+	return (valid && !reader.error && !reader.crc && (fill == PROTOCOL_CRC_SIZE)) ? (int16_t)count : -1;
+}
+
+void protocolDeltaInit (protocol_delta_t* ctx)
+{
+	deltaClear(ctx);
+	ctx->seq = 0;
+	ctx->synced = false;
+}
+
+void protocolDeltaKey (protocol_delta_t* ctx)
+{
+	ctx->synced = false;
+}
+
+size_t protocolPackBatch (const protocol_t* data, uint8_t count, protocol_delta_t* ctx, uchar_t* frame)
+{
+	cobs_t cobs = { frame, 1, 0, CRC16_INIT };
+	bool delta = ctx && ctx->synced;
+	uint32_t zigzag;
+
+	if (ctx && !delta)
+		deltaClear(ctx);														// Key frame: both ends restart from 0
+	count = MIN(count, PROTOCOL_MAX_RECORDS);
+	framePut(&cobs, PROTOCOL_BATCH_TAG | (delta ? PROTOCOL_BATCH_DELTA : 0));
+	framePut(&cobs, ctx ? ++ctx->seq : 0);
+	framePut(&cobs, count);
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		framePut(&cobs, data[i].id);
+		if (delta)
+		{
+			zigzag = ZIGZAG_ENCODE((uint32_t)data[i].val - (uint32_t)ctx->last[data[i].id]);	// Wraps, never overflows
+			do {																// Varint: 7 bits per byte, LSB first
+				framePut(&cobs, (zigzag & 0x7F) | ((zigzag >> 7) ? 0x80 : 0));
+				zigzag >>= 7;
+			} while (zigzag);
+		}
+		else
+			putVal(&cobs, data[i].val);
+		if (ctx)
+			ctx->last[data[i].id] = data[i].val;
+	}
+	if (ctx)
+		ctx->synced = true;
+
+	return frameClose(&cobs);
+}
+
+int16_t protocolUnpackBatch (const uchar_t* frame, size_t len, protocol_t* data, uint8_t max, protocol_delta_t* ctx)
+{
+	cobs_reader_t reader = { frame, len, 0, 0, false, false, CRC16_INIT };
+	uchar_t tag = 0, seq = 0, count = 0, byte;
+	uint32_t val;
+	bool valid, delta;
+	protocol_val_t base;
+
+	valid = frameGet(&reader, &tag) && frameGet(&reader, &seq) && frameGet(&reader, &count);
+	delta = tag & PROTOCOL_BATCH_DELTA;
+	valid = valid && ((tag & ~PROTOCOL_BATCH_DELTA) == PROTOCOL_BATCH_TAG) && (count <= max);
+	valid = valid && (!delta || (ctx && ctx->synced && (seq == (uchar_t)(ctx->seq + 1))));	// Lost frame: wait for a key frame
+
+	for (uint8_t i = 0; valid && (i < count); i++)
+	{
+		valid = frameGet(&reader, &data[i].id);
+		val = 0;
+		if (delta)
+		{
+			for (uint8_t shift = 0; valid; shift += 7)
+			{
+				valid = frameGet(&reader, &byte) && (shift < 8 * sizeof(protocol_val_t));
+				val |= (uint32_t)(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+					break;
+			}
+			base = deltaBase(ctx, data, i);
+			data[i].val = (protocol_val_t)((uint32_t)base + ZIGZAG_DECODE(val));
+		}
+		else
+		{
+			for (uint8_t k = 0; valid && (k < sizeof(protocol_val_t)); k++)	// Little-endian
+			{
+				valid = frameGet(&reader, &byte);
+				val |= (uint32_t)byte << (8 * k);
+			}
+			data[i].val = (protocol_val_t)val;
+		}
+	}
+
+	valid = valid && frameGet(&reader, &byte) && frameGet(&reader, &byte) && !frameGet(&reader, &byte);
+	valid = valid && !reader.error && !reader.crc;
+
+	if (ctx && valid)															// Only trusted frames move the context
+		deltaCommit(ctx, data, count, delta, seq);
+
+	return valid ? count : -1;
+}
+
+size_t protocolPackBytes (const uchar_t* payload, size_t len, uchar_t* frame)
+{
+	cobs_t cobs = { frame, 1, 0, CRC16_INIT };
+
+	while (len--)
+		framePut(&cobs, *payload++);
+
+	return frameClose(&cobs);
+}
+
+int32_t protocolUnpackBytes (const uchar_t* frame, size_t len, uchar_t* payload, size_t max)
+{
+	cobs_reader_t reader = { frame, len, 0, 0, false, false, CRC16_INIT };
+	size_t count = 0;
+	uchar_t byte;
+
+	while (frameGet(&reader, &byte))
+	{
+		if (count == max + PROTOCOL_CRC_SIZE)
+			return -1;
+		if (count < max)
+			payload[count] = byte;
+		count++;
+	}
+
+	return (!reader.error && !reader.crc && (count >= PROTOCOL_CRC_SIZE)) ? (int32_t)(count - PROTOCOL_CRC_SIZE) : -1;
+}
+
+void protocolParserInit (protocol_parser_t* parser, protocol_stream_t mode, protocol_callback_t callback, void* arg,
+						 protocol_delta_t* delta)
+{
+	parser->mode = mode;
+	parser->callback = callback;
+	parser->arg = arg;
+	parser->delta = delta;
+	parser->errors = 0;
+	parseReset(parser);
+	if (mode == PROTOCOL_STREAM_ASCII)
+		parser->state = PARSE_ID;
+}
+
+uint32_t protocolParse (protocol_parser_t* parser, const uchar_t* data, size_t len)
+{
+	uint32_t done = 0;
+
+	if (parser->mode == PROTOCOL_STREAM_ASCII)
+		while (len--)
+			done += parseAscii(parser, *data++);
+	else
+		while (len--)
+			done += parseBinary(parser, *data++);
+
+	return done;
+}
+
+uint16_t protocolCRC16 (uint16_t crc, const uchar_t* data, size_t len)
+{
+	while (len--)
+		crc = CRC16_UPDATE(crc, *data++);
+
+	return crc;
+}
+
 /*******************************************************************************
  *******************************************************************************
 						LOCAL FUNCTION DEFINITIONS
  *******************************************************************************
  ******************************************************************************/
 
-uint8_t __Num2Chars__ (const uint16_t num, uchar_t* chars)
+uint8_t __Num2Chars__ (uint32_t num, uchar_t* chars)
+{
+	uint8_t len = 1, i;
+	uint32_t pair;
+
+	while ((len < MAX_DIGS) && (num >= pow10[len]))								// Compares only, no divisions
+		len++;
+
+	for (i = len; i >= 2; i -= 2)												// Two digits per division, from the right
+	{
+		pair = 2 * (num % 100);
+		num /= 100;
+		chars[i - 2] = digit_pairs[pair];
+		chars[i - 1] = digit_pairs[pair + 1];
+	}
+	if (i)
+		chars[0] = NUM2ASCII(num);
+
+	return len;
+}
+
+bool __Chars2Num__ (const uchar_t* chars, uint8_t len, uint32_t* num)
 {
-	int16_t aux = num;
-	uint8_t len = 0;
+	uint32_t acc = 0, lead = 0, bad = 0, d0, d1;
+	uint8_t i;
 
-	do { aux /= 10; }
-	while ((++len < MAX_DIGS) && aux);
+	if (!len || (len > MAX_DIGS))
+		return false;
 
-	for (uint8_t i = 0; i < len; i++)
-		chars[i] = 0;
+	if (len == MAX_DIGS)														// Only 10 digits can overflow: keep the first apart
+	{
+		lead = DIGIT(*chars++);
+		len--;
+	}
+	if ((i = len & 1))
+	{
+		acc = DIGIT(chars[0]);
+		bad = acc > 9;
+	}
+	for (; i < len; i += 2)														// Two digits per multiply, no branches on the data
+	{
+		d0 = DIGIT(chars[i]);
+		d1 = DIGIT(chars[i + 1]);
+		bad |= (d0 > 9) | (d1 > 9);
+		acc = acc * 100 + d0 * 10 + d1;
+	}
+	bad |= (lead > 4) | ((lead == 4) & (acc > UINT32_MAX - 4 * pow10[MAX_DIGS - 1]));
+	*num = lead * pow10[MAX_DIGS - 1] + acc;
+
+	return !bad;
+}
+
+static void cobsPut (cobs_t* cobs, uchar_t byte)
+{
+	if (byte)
+		cobs->out[cobs->len++] = byte;
 
-	if (!aux)
+	if (!byte || (cobs->len - cobs->code == 0xFF))								// Close the block: a zero or 254 data bytes
 	{
-		aux = num;
-		for (uint8_t i = 0; i < len; i++)
+		cobs->out[cobs->code] = cobs->len - cobs->code;
+		cobs->code = cobs->len++;
+	}
+}
+
+static void framePut (cobs_t* cobs, uchar_t byte)
+{
+	cobs->crc = CRC16_UPDATE(cobs->crc, byte);
+	cobsPut(cobs, byte);
+}
+
+static void putVal (cobs_t* cobs, protocol_val_t val)
+{
+	for (uint8_t i = 0; i < sizeof(protocol_val_t); i++)
+		framePut(cobs, (uchar_t)((uint32_t)val >> (8 * i)));
+}
+
+static size_t frameClose (cobs_t* cobs)
+{
+	uint16_t crc = cobs->crc;
+
+	cobsPut(cobs, crc >> 8);													// Big-endian: the CRC of the whole payload is 0
+	cobsPut(cobs, crc & 0xFF);
+
+	cobs->out[cobs->code] = cobs->len - cobs->code;
+	cobs->out[cobs->len++] = PROTOCOL_DELIM;
+
+	return cobs->len;
+}
+
+static bool frameGet (cobs_reader_t* reader, uchar_t* byte)
+{
+	bool next;
+
+	while (!reader->left)
+	{
+		next = (reader->pos < reader->len) && (reader->in[reader->pos] != PROTOCOL_DELIM);
+		if (reader->zero && next)												// Stuffed zero, except at the end of the frame
 		{
-			chars[len - 1 - i] = NUM2ASCII(aux % 10);
-			aux /= 10;
+			reader->zero = false;
+			*byte = 0;
+			reader->crc = CRC16_UPDATE(reader->crc, 0);
+			return true;
 		}
+		if (!next)
+			return false;
+		reader->left = reader->in[reader->pos] - 1;								// Open the next block
+		reader->zero = reader->in[reader->pos++] < 0xFF;
 	}
-	else { len = 0; }
 
-	return len;
+	if ((reader->pos >= reader->len) || (reader->in[reader->pos] == PROTOCOL_DELIM))
+	{
+		reader->error = true;
+		return false;
+	}
+	reader->left--;
+	*byte = reader->in[reader->pos++];
+	reader->crc = CRC16_UPDATE(reader->crc, *byte);
+
+	return true;
+}
+
+static void deltaClear (protocol_delta_t* ctx)
+{
+	for (uint16_t id = 0; id < PROTOCOL_CANT_IDS; id++)
+		ctx->last[id] = 0;
+}
+
+static protocol_val_t deltaBase (const protocol_delta_t* ctx, const protocol_t* data, uint8_t i)
+{
+	for (uint8_t j = i; j; j--)													// Same id earlier in this frame
+		if (data[j - 1].id == data[i].id)
+			return data[j - 1].val;
+
+	return ctx->last[data[i].id];
 }
 
-int16_t __Chars2Num__ (uchar_t* const chars, const int8_t len)
+static void deltaCommit (protocol_delta_t* ctx, const protocol_t* data, uint8_t count, bool delta, uchar_t seq)
 {
-	int16_t num = 0;
+	if (!delta)
+		deltaClear(ctx);
+	for (uint8_t i = 0; i < count; i++)
+		ctx->last[data[i].id] = data[i].val;
+	ctx->seq = seq;
+	ctx->synced = true;
+}
+
+static uint32_t parseAscii (protocol_parser_t* p, uchar_t byte)
+{
+	uint32_t digit = DIGIT(byte), done = 0;
+
+	if (byte == '\r')
+		return 0;
+
+	if ((p->state == PARSE_DIGITS) && (digit > 9) && p->index)					// Ended by the delimiter or the next id
+	{
+		if (p->num <= (uint32_t)INT32_MAX + p->neg)
+		{
+			p->record.val = (protocol_val_t)(p->neg ? 0U - p->num : p->num);
+			p->callback(&p->record, p->arg);
+			done = 1;
+		}
+		else
+			p->errors++;
+		p->state = PARSE_ID;
+	}
+
+	if (byte == PROTOCOL_ASCII_DELIM)
+	{
+		p->errors += (p->state == PARSE_SIGN) || (p->state == PARSE_DIGITS);	// No digits
+		p->state = PARSE_ID;
+		return done;
+	}
+
+	switch (p->state)
+	{
+		case PARSE_ID:
+			p->record.id = byte;
+			p->num = 0;
+			p->index = 0;
+			p->neg = false;
+			p->state = PARSE_SIGN;
+			break;
+
+		case PARSE_SIGN:
+			p->state = PARSE_DIGITS;
+			if ((byte == '+') || (byte == '-'))
+			{
+				p->neg = byte == '-';
+				break;
+			}
+			// fall through
 
-	for (uint8_t i = 0; (i < len) && (i < MAX_DIGS); i++)
+		case PARSE_DIGITS:
+			if ((digit > 9) || (++p->index > MAX_DIGS) || (p->num > INT32_MAX / 10))	// The final check catches the rest
+			{
+				p->errors++;
+				p->state = PARSE_SKIP;
+			}
+			else
+				p->num = p->num * 10 + digit;
+			break;
+
+		default:
+			break;
+	}
+
+	return done;
+}
+
+static uint32_t parseBinary (protocol_parser_t* p, uchar_t byte)
+{
+	uint32_t done = 0;
+
+	if (byte == PROTOCOL_DELIM)
 	{
-		num *= 10;
-		num += ASCII2NUM(chars[i]);
+		done = parseEnd(p);
+		parseReset(p);
 	}
+	else if (p->state != PARSE_SKIP)
+	{
+		if (p->left)
+		{
+			p->left--;
+			parsePayload(p, byte);
+		}
+		else																	// Code byte
+		{
+			if (p->zero)
+				parsePayload(p, 0);
+			else if (p->state == PARSE_START)
+				p->state = (p->mode == PROTOCOL_STREAM_BATCH) ? PARSE_TAG : PARSE_RECORD;
+			p->left = byte - 1;
+			p->zero = byte < 0xFF;
+		}
+	}
+
+	return done;
+}
 
-	return num;
+static void parsePayload (protocol_parser_t* p, uchar_t byte)
+{
+	bool delta = p->tag & PROTOCOL_BATCH_DELTA, error = false;
+	protocol_t* record = &p->staged[p->staged_cant];
+
+	p->crc = CRC16_UPDATE(p->crc, byte);
+
+	if (p->mode == PROTOCOL_STREAM_FRAME)										// The last 2 bytes may turn out to be the CRC
+	{
+		p->window[p->index++] = byte;
+		if (p->index == sizeof(p->window))
+		{
+			if (!(error = p->staged_cant == PROTOCOL_MAX_RECORDS))
+			{
+				record->id = p->window[0];
+				p->num = 0;
+				for (uint8_t k = sizeof(protocol_val_t); k; k--)				// Little-endian
+					p->num = (p->num << 8) | p->window[k];
+				record->val = (protocol_val_t)p->num;
+				p->staged_cant++;
+			}
+			for (p->index = 0; p->index < PROTOCOL_CRC_SIZE; p->index++)
+				p->window[p->index] = p->window[PROTOCOL_RECORD_SIZE + p->index];
+		}
+	}
+	else
+		switch (p->state)
+		{
+			case PARSE_TAG:
+				p->tag = byte;
+				error = (byte & ~PROTOCOL_BATCH_DELTA) != PROTOCOL_BATCH_TAG;
+				p->state = PARSE_SEQ;
+				break;
+
+			case PARSE_SEQ:
+				p->seq = byte;
+				error = delta && !(p->delta && p->delta->synced && (byte == (uchar_t)(p->delta->seq + 1)));	// Wait for a key frame
+				p->state = PARSE_COUNT;
+				break;
+
+			case PARSE_COUNT:
+				p->count = byte;
+				error = byte > PROTOCOL_MAX_RECORDS;
+				p->state = byte ? PARSE_RECORD : PARSE_CRC;
+				break;
+
+			case PARSE_RECORD:
+				record->id = byte;
+				p->num = 0;
+				p->index = 0;
+				p->state = PARSE_VAL;
+				break;
+
+			case PARSE_VAL:
+				if (delta)														// Varint, 7 bits per byte
+				{
+					error = p->index >= 8 * sizeof(protocol_val_t);
+					p->num |= (uint32_t)(byte & 0x7F) << p->index;
+					p->index += 7;
+					if (byte & 0x80)
+						break;
+					record->val = (protocol_val_t)((uint32_t)deltaBase(p->delta, p->staged, p->staged_cant) + ZIGZAG_DECODE(p->num));
+				}
+				else															// Little-endian
+				{
+					p->num |= (uint32_t)byte << p->index;
+					p->index += 8;
+					if (p->index < 8 * sizeof(protocol_val_t))
+						break;
+					record->val = (protocol_val_t)p->num;
+				}
+				p->index = 0;
+				p->state = (++p->staged_cant == p->count) ? PARSE_CRC : PARSE_RECORD;
+				break;
+
+			case PARSE_CRC:
+				error = ++p->index > PROTOCOL_CRC_SIZE;
+				break;
+
+			default:
+				break;
+		}
+
+	if (error)
+		p->state = PARSE_SKIP;
+}
+
+static uint32_t parseEnd (protocol_parser_t* p)
+{
+	bool valid;
+
+	if (p->state == PARSE_START)												// Empty frame, or a delimiter to resync
+		return 0;
+
+	valid = (p->state != PARSE_SKIP) && !p->left && !p->crc;
+	if (p->mode == PROTOCOL_STREAM_FRAME)
+		valid = valid && (p->index == PROTOCOL_CRC_SIZE);
+	else
+		valid = valid && (p->state == PARSE_CRC) && (p->index == PROTOCOL_CRC_SIZE);
+
+	if (!valid)
+	{
+		p->errors++;
+		return 0;
+	}
+
+	if ((p->mode == PROTOCOL_STREAM_BATCH) && p->delta)
+		deltaCommit(p->delta, p->staged, p->staged_cant, p->tag & PROTOCOL_BATCH_DELTA, p->seq);
+	for (uint8_t i = 0; i < p->staged_cant; i++)
+		p->callback(&p->staged[i], p->arg);
+
+	return p->staged_cant;
+}
+
+static void parseReset (protocol_parser_t* p)
+{
+	p->state = PARSE_START;
+	p->left = 0;
+	p->zero = false;
+	p->crc = CRC16_INIT;
+	p->index = 0;
+	p->tag = 0;
+	p->staged_cant = 0;
 }
 
 /******************************************************************************/
@@ -1,6 +1,8 @@
 /***************************************************************************//**
   @file     protocol.h
   @brief    Data frame packer and unpacker, using protocol '{Id}[ValSign]{Val}'
+            or binary frames: COBS({Id}{Val LE}...{CRC-16 BE}) 0x00,
+            plain or batched with delta encoding
   @author   Group 4: - Oms, Mariano
                      - Solari Raigoso, Agustín
                      - Wickham, Tomás
@@ -14,6 +16,8 @@
  * INCLUDE HEADER FILES
  ******************************************************************************/
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /*******************************************************************************
@@ -22,9 +26,31 @@
 
 // Protocol configuration //////////////////////////////////////////////////////
 
-#define MAX_DIGS		3														// Maximum digits for the angle
+#define MAX_DIGS		10														// Maximum digits for the value, any int32_t
 #define PROTOCOL_DIGS	(MAX_DIGS + 2)											// Protocol size: id + sign + val
 
+// Binary framing //////////////////////////////////////////////////////////////
+
+#define PROTOCOL_DELIM				0x00										// Ends every binary frame
+#define PROTOCOL_RECORD_SIZE		(sizeof(protocol_id_t) + sizeof(protocol_val_t))
+#define PROTOCOL_CRC_SIZE			2
+#define PROTOCOL_MAX_RECORDS		32
+#define PROTOCOL_COBS_SIZE(n)		((n) + (n) / 254 + 1)						// Worst case stuffed size of n bytes
+#define PROTOCOL_FRAME_SIZE(count)	(PROTOCOL_COBS_SIZE((count) * PROTOCOL_RECORD_SIZE + PROTOCOL_CRC_SIZE) + 1)
+
+// Batch frames: COBS({Tag}{Seq}{Count}{Id}{Val or delta}...{CRC-16 BE}) 0x00
+
+#define PROTOCOL_BATCH_TAG			0xB0
+#define PROTOCOL_BATCH_DELTA		0x01										// Values are zigzag varint deltas
+#define PROTOCOL_BATCH_HEADER		3
+#define PROTOCOL_VARINT_MAX			((8 * sizeof(protocol_val_t) + 6) / 7)
+#define PROTOCOL_BATCH_SIZE(count)	(PROTOCOL_COBS_SIZE(PROTOCOL_BATCH_HEADER + (count) * (sizeof(protocol_id_t) + PROTOCOL_VARINT_MAX) + PROTOCOL_CRC_SIZE) + 1)
+#define PROTOCOL_CANT_IDS			256											// Every protocol_id_t
+
+// Streaming parser ////////////////////////////////////////////////////////////
+
+#define PROTOCOL_ASCII_DELIM		'\n'										// Ends ASCII records, '\r' is ignored
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
@@ -39,7 +65,7 @@
 
 typedef unsigned char uchar_t;
 typedef uchar_t protocol_id_t;
-typedef int16_t protocol_val_t;
+typedef int32_t protocol_val_t;
 
 /**
  * @brief Protocol data structure
@@ -51,6 +77,63 @@ typedef struct {
 	protocol_val_t val;
 } protocol_t;
 
+/**
+ * @brief Delta context, one per link end, owned by the caller
+ * @param last Last value of each id
+ * @param seq Last frame sequence number
+ * @param synced A key frame went through, deltas are meaningful
+ */
+typedef struct {
+	protocol_val_t	last[PROTOCOL_CANT_IDS];
+	uint8_t			seq;
+	bool			synced;
+} protocol_delta_t;
+
+/**
+ * @brief Streaming parser input format
+ * @param PROTOCOL_STREAM_ASCII '{Id}[ValSign]{Val}' records, ended by PROTOCOL_ASCII_DELIM or the next id
+ * @param PROTOCOL_STREAM_FRAME protocolPackFrame frames
+ * @param PROTOCOL_STREAM_BATCH protocolPackBatch frames
+ */
+typedef enum {
+	PROTOCOL_STREAM_ASCII,
+	PROTOCOL_STREAM_FRAME,
+	PROTOCOL_STREAM_BATCH
+} protocol_stream_t;
+
+/**
+ * @brief Called once per record, in order, as soon as it is complete
+ * @param data Record parsed, only valid during the call
+ * @param arg Argument given to protocolParserInit
+ */
+typedef void (*protocol_callback_t)(const protocol_t* data, void* arg);
+
+/**
+ * @brief Streaming parser state, owned by the caller (one per input stream)
+ * @note Fields are private to protocol.c
+ */
+typedef struct {
+	protocol_stream_t	mode;
+	protocol_callback_t	callback;
+	void*				arg;
+	protocol_delta_t*	delta;													// Batch deltas, NULL for key frames only
+	uint32_t			errors;													// Malformed records or frames dropped
+
+	uint8_t				state;
+	uint8_t				index;
+	bool				neg;
+	uint32_t			num;
+	protocol_t			record;
+
+	uint8_t				left;													// COBS
+	bool				zero;
+	uint16_t			crc;
+	uchar_t				tag, seq, count;
+	uchar_t				window[PROTOCOL_RECORD_SIZE + PROTOCOL_CRC_SIZE];
+	protocol_t			staged[PROTOCOL_MAX_RECORDS];							// Held until the CRC checks out
+	uint8_t				staged_cant;
+} protocol_parser_t;
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -67,10 +150,117 @@ uint8_t protocolPack (protocol_t* const data, uchar_t msg[PROTOCOL_DIGS]);
  * @brief Unpack a message using the protocol
  * @param msg Message to unpack
  * @param len Message length
- * @return Unpacked data
+ * @return Unpacked data, id 0 if the message is malformed (no digits, a
+ *         non-digit byte or out of range)
  */
 protocol_t* protocolUnpack (uchar_t* const msg, const uint8_t len);
 
+/**
+ * @brief Initialize a streaming parser
+ * @param parser Parser state
+ * @param mode Input format
+ * @param callback Called for every record parsed
+ * @param arg Passed to the callback
+ * @param delta Delta context for PROTOCOL_STREAM_BATCH, NULL otherwise
+ */
+void protocolParserInit (protocol_parser_t* parser, protocol_stream_t mode, protocol_callback_t callback, void* arg,
+						 protocol_delta_t* delta);
+
+/**
+ * @brief Feed bytes to a streaming parser, in chunks of any size
+ * @param parser Parser state
+ * @param data Bytes received
+ * @param len Number of bytes
+ * @return Number of records delivered to the callback
+ * @note Every byte is looked at once. Parsers share nothing, so each one may
+ *       run in its own context (ISR, task) without locking.
+ */
+uint32_t protocolParse (protocol_parser_t* parser, const uchar_t* data, size_t len);
+
+/**
+ * @brief Pack records into a binary frame: little-endian fields, CRC-16, COBS stuffing and delimiter
+ * @param data Records to pack
+ * @param count Number of records, up to PROTOCOL_MAX_RECORDS
+ * @param frame Place to store the frame, PROTOCOL_FRAME_SIZE(count) bytes
+ * @return Frame length, delimiter included
+ */
+size_t protocolPackFrame (const protocol_t* data, uint8_t count, uchar_t* frame);
+
+/**
+ * @brief Unpack a binary frame
+ * @param frame Frame to unpack, the delimiter is optional
+ * @param len Frame length
+ * @param data Place to store the records
+ * @param max Room in data, in records
+ * @return Number of records, -1 if the frame is corrupted or does not fit
+ */
+int16_t protocolUnpackFrame (const uchar_t* frame, size_t len, protocol_t* data, uint8_t max);
+
+/**
+ * @brief Reset a delta context, the next packed frame is a key frame
+ * @param ctx Context to reset
+ */
+void protocolDeltaInit (protocol_delta_t* ctx);
+
+/**
+ * @brief Make the next packed frame a key frame, so a receiver that lost one can catch up
+ * @param ctx Sender context
+ */
+void protocolDeltaKey (protocol_delta_t* ctx);
+
+/**
+ * @brief Pack records into one batch frame: header, count, records, CRC-16, COBS and delimiter
+ * @param data Records to pack
+ * @param count Number of records, up to PROTOCOL_MAX_RECORDS
+ * @param ctx Delta context, NULL for absolute values only
+ * @param frame Place to store the frame, PROTOCOL_BATCH_SIZE(count) bytes
+ * @return Frame length, delimiter included
+ * @note With a context, deltas are against the previous value of the same id;
+ *       the first frame after protocolDeltaInit or protocolDeltaKey is an
+ *       absolute key frame
+ */
+size_t protocolPackBatch (const protocol_t* data, uint8_t count, protocol_delta_t* ctx, uchar_t* frame);
+
+/**
+ * @brief Unpack a batch frame
+ * @param frame Frame to unpack, the delimiter is optional
+ * @param len Frame length
+ * @param data Place to store the records
+ * @param max Room in data, in records
+ * @param ctx Delta context, NULL to accept absolute frames only
+ * @return Number of records, -1 if the frame is corrupted, does not fit or
+ *         is a delta frame out of sequence (wait for the next key frame)
+ */
+int16_t protocolUnpackBatch (const uchar_t* frame, size_t len, protocol_t* data, uint8_t max, protocol_delta_t* ctx);
+
+/**
+ * @brief Wrap any payload the same way: CRC-16, COBS stuffing and delimiter
+ * @param payload Bytes to send
+ * @param len Payload length
+ * @param frame Place to store the frame, PROTOCOL_COBS_SIZE(len + PROTOCOL_CRC_SIZE) + 1 bytes
+ * @return Frame length, delimiter included
+ */
+size_t protocolPackBytes (const uchar_t* payload, size_t len, uchar_t* frame);
+
+/**
+ * @brief Unwrap a frame made by protocolPackBytes
+ * @param frame Frame to unpack, the delimiter is optional
+ * @param len Frame length
+ * @param payload Place to store the payload
+ * @param max Room in payload
+ * @return Payload length, -1 if the frame is corrupted or does not fit
+ */
+int32_t protocolUnpackBytes (const uchar_t* frame, size_t len, uchar_t* payload, size_t max);
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), table-driven
+ * @param crc Previous CRC, 0xFFFF to start
+ * @param data Bytes to add
+ * @param len Number of bytes
+ * @return Updated CRC
+ */
+uint16_t protocolCRC16 (uint16_t crc, const uchar_t* data, size_t len);
+
 /*******************************************************************************
  ******************************************************************************/
 
@@ -0,0 +1,169 @@
+/***************************************************************************//**
+  @file     scheduler.c
+  @brief    Run-to-completion scheduler: ISRs post tasks, the main loop runs
+            the highest priority one ready and sleeps when none is
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stddef.h>
+
+#include "scheduler.h"
+
+#if SCHED_HOST
+#include <pthread.h>
+#else
+#include "hardware.h"
+#endif
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define LOAD_ACQUIRE(x)			__atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define FETCH_OR(x, v)			__atomic_fetch_or(&(x), (v), __ATOMIC_RELEASE)
+#define FETCH_AND(x, v)			__atomic_fetch_and(&(x), (v), __ATOMIC_ACQUIRE)
+#define COUNT(x)				__atomic_fetch_add(&(x), 1, __ATOMIC_RELAXED)
+
+#define HIGHEST(set)			(31 - __builtin_clz(set))						// clz on the Cortex-M4
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Sleep until something is posted, returns right away if something is
+ */
+static void idle (void);
+
+/**
+ * @brief Wake the dispatcher up after a post
+ */
+static inline void wake (void);
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static sched_task_t tasks[SCHED_TASKS];
+static volatile uint32_t ready;													// Bit per task
+static sched_stats_t stats;
+
+#if SCHED_HOST
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t posted = PTHREAD_COND_INITIALIZER;
+#endif
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void schedInit (void)
+{
+	for (uint8_t i = 0; i < SCHED_TASKS; i++)
+		tasks[i] = NULL;
+	ready = 0;
+	stats = (sched_stats_t){ 0, 0, 0 };
+}
+
+bool schedRegister (sched_prio_t prio, sched_task_t task)
+{
+	bool status = (prio < SCHED_TASKS) && task && !tasks[prio];
+
+	if (status)
+		tasks[prio] = task;
+
+	return status;
+}
+
+void schedPost (sched_prio_t prio)
+{
+	if (prio >= SCHED_TASKS)
+		return;
+
+	COUNT(stats.posts);
+	FETCH_OR(ready, 1UL << prio);
+	wake();
+}
+
+bool schedDispatch (void)
+{
+	uint32_t set = LOAD_ACQUIRE(ready);
+	sched_prio_t prio;
+
+	if (!set)
+	{
+		idle();
+		return false;
+	}
+
+	prio = HIGHEST(set);
+	FETCH_AND(ready, ~(1UL << prio));													// Before running: a post from now on runs it again
+	COUNT(stats.runs);
+	if (tasks[prio])
+		tasks[prio]();
+
+	return true;
+}
+
+sched_stats_t schedGetStats (void)
+{
+	return (sched_stats_t){ LOAD_ACQUIRE(stats.posts), LOAD_ACQUIRE(stats.runs), LOAD_ACQUIRE(stats.sleeps) };
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+#if SCHED_HOST
+
+static void idle (void)
+{
+	pthread_mutex_lock(&lock);
+	if (!LOAD_ACQUIRE(ready))
+	{
+		COUNT(stats.sleeps);
+		while (!LOAD_ACQUIRE(ready))
+			pthread_cond_wait(&posted, &lock);
+	}
+	pthread_mutex_unlock(&lock);
+}
+
+static inline void wake (void)
+{
+	pthread_mutex_lock(&lock);													// Not between the check and the wait
+	pthread_cond_signal(&posted);
+	pthread_mutex_unlock(&lock);
+}
+
+#else
+
+static void idle (void)
+{
+	__disable_irq();															// A post between the check and WFI still wakes it
+	if (!LOAD_ACQUIRE(ready))
+	{
+		COUNT(stats.sleeps);
+		__DSB();
+		__WFI();
+	}
+	__enable_irq();																// The pending ISR runs here
+}
+
+static inline void wake (void)
+{
+}
+
+#endif // SCHED_HOST
+
+/******************************************************************************/
@@ -0,0 +1,93 @@
+/***************************************************************************//**
+  @file     scheduler.h
+  @brief    Run-to-completion scheduler: ISRs post tasks, the main loop runs
+            the highest priority one ready and sleeps when none is
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     The ready set is one word, posting is an atomic OR (ldrex/strex on
+            the Cortex-M4), so it is safe from any ISR without masking. Posts
+            to a task already ready are merged: tasks drain their own queues
+ ******************************************************************************/
+
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#ifndef SCHED_HOST
+#define SCHED_HOST			0													// 1: pthreads stand in for the ISRs, 0: WFI on the K64F
+#endif
+
+#define SCHED_TASKS			32													// Priorities 0 to 31, 31 runs first
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef void (*sched_task_t)(void);
+typedef uint8_t sched_prio_t;
+
+/**
+ * @brief Scheduler counters
+ * @param posts Posts, merged ones included
+ * @param runs Tasks run
+ * @param sleeps Times the core went to sleep with nothing ready
+ */
+typedef struct {
+	uint32_t	posts;
+	uint32_t	runs;
+	uint32_t	sleeps;
+} sched_stats_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Initialize the scheduler, no task registered nor ready
+ */
+void schedInit (void);
+
+/**
+ * @brief Register a task, one per priority
+ * @param prio Priority, also the task id
+ * @param task Task, runs to completion
+ * @return Registration succeed
+ */
+bool schedRegister (sched_prio_t prio, sched_task_t task);
+
+/**
+ * @brief Make a task ready, from an ISR or a task
+ * @param prio Task to run
+ * @note Lock-free and constant time
+ */
+void schedPost (sched_prio_t prio);
+
+/**
+ * @brief Run the highest priority task ready, or sleep until an interrupt if none
+ * @return A task was run
+ * @note Call it from App_Run
+ */
+bool schedDispatch (void);
+
+/**
+ * @brief Get the scheduler counters
+ * @return Counters since schedInit
+ */
+sched_stats_t schedGetStats (void);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _SCHEDULER_H_
@@ -0,0 +1,307 @@
+/***************************************************************************//**
+  @file     scope.c
+  @brief    Triggered burst capture: pre-trigger ring on the ADC path, snapshot
+            dumped as binary frames once the post-trigger samples are in
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "macros.h"
+#include "scope.h"
+#include "serial.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define SAMPLE_MASK					0x0FFF										// 12 bits
+#define RING_MASK					(SCOPE_BUFFER_SAMPLES - 1)
+
+#define CARRIER_FRAC				8											// Fixed point, Q8
+#define CARRIER_DC_SHIFT			6											// Running average over ~64 samples
+#define CARRIER_ENV_SHIFT			4											// Envelope over ~16 samples
+
+#if SCOPE_BUFFER_SAMPLES & RING_MASK
+#error "SCOPE_BUFFER_SAMPLES must be a power of 2"
+#endif
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Start watching, with the current configuration
+ */
+static void arm (void);
+
+/**
+ * @brief Run the trigger detector on a sample
+ * @param sample Sample
+ * @return Trigger condition met
+ */
+static bool detect (uint16_t sample);
+
+/**
+ * @brief Encode a chunk of the snapshot into a frame payload
+ * @param offset Index of the first sample in the snapshot
+ * @param payload Place to store the payload, SCOPE_PAYLOAD_MAX bytes
+ * @return Payload length
+ */
+static size_t encode (uint16_t offset, uchar_t* payload);
+
+/**
+ * @brief Serial callback, a frame buffer can be reused
+ * @param data Frame sent
+ */
+static void frameDone (const uchar_t* data);
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static uint16_t ring[SCOPE_BUFFER_SAMPLES];
+static uint32_t head;															// Samples written, free-running
+static uint32_t start;															// First sample of the snapshot
+static uint16_t filled;															// Pre-trigger samples in, up to cfg.pre
+static uint16_t left;															// Post-trigger samples to go
+
+static scope_cfg_t cfg;
+static scope_callback_t notify;
+static volatile scope_state_t state;
+static bool ready;																// Edge triggers: been on the other side
+static bool primed;																// Carrier: running average seeded
+static int32_t dc, env;
+
+static uchar_t frames[SCOPE_FRAMES][SCOPE_FRAME_SIZE];
+static uint32_t frames_out;
+static volatile uint32_t frames_done;
+static uint16_t sent;															// Snapshot samples encoded
+static uint8_t capture;
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void scopeInit (scope_callback_t cb)
+{
+	notify = cb;
+	state = SCOPE_IDLE;
+	frames_out = frames_done = 0;
+	capture = 0;
+}
+
+bool scopeArm (const scope_cfg_t* config)
+{
+	if ((state == SCOPE_DUMPING) || !config->post || ((uint32_t)config->pre + config->post > SCOPE_BUFFER_SAMPLES))
+		return false;
+
+	state = SCOPE_IDLE;															// The ADC callback leaves everything alone
+	cfg = *config;
+	arm();
+
+	return true;
+}
+
+void scopeDisarm (void)
+{
+	cfg.rearm = false;
+	if (state != SCOPE_DUMPING)
+		state = SCOPE_IDLE;
+}
+
+void scopePush (uint16_t sample)
+{
+	switch (state)
+	{
+		case SCOPE_ARMED:
+			ring[head++ & RING_MASK] = sample & SAMPLE_MASK;
+			if (detect(sample) && (filled == cfg.pre))
+			{
+				start = head - 1 - cfg.pre;
+				left = cfg.post - 1;
+				state = left ? SCOPE_TRIGGERED : SCOPE_DUMPING;
+				if (!left && notify)
+					notify();
+			}
+			else if (filled < cfg.pre)
+				filled++;
+			break;
+
+		case SCOPE_TRIGGERED:
+			ring[head++ & RING_MASK] = sample & SAMPLE_MASK;
+			if (!--left)
+			{
+				state = SCOPE_DUMPING;												// Frozen until it is out
+				if (notify)
+					notify();
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+void scopeUpdate (void)
+{
+	uchar_t payload[SCOPE_PAYLOAD_MAX], * frame;
+	size_t len;
+
+	while ((state == SCOPE_DUMPING) && (frames_out - frames_done < SCOPE_FRAMES))
+	{
+		frame = frames[frames_out % SCOPE_FRAMES];
+		len = protocolPackBytes(payload, encode(sent, payload), frame);
+		if (!serialWriteFrame(frame, len, frameDone))							// Transmit queue full, try again later
+			break;
+
+		frames_out++;
+		sent += payload[SCOPE_HEADER - 1];
+		if (sent == cfg.pre + cfg.post)											// All of it in frame buffers, the ring is free
+		{
+			capture++;
+			if (cfg.rearm)
+				arm();
+			else
+				state = SCOPE_IDLE;
+		}
+	}
+}
+
+scope_state_t scopeGetState (void)
+{
+	return state;
+}
+
+int16_t scopeDecode (const uchar_t* payload, size_t len, scope_header_t* header, uint16_t* samples)
+{
+	size_t n = SCOPE_HEADER;
+	uint8_t i;
+
+	if ((len < SCOPE_HEADER) || (payload[0] != SCOPE_TAG) || (payload[8] > SCOPE_CHUNK_SAMPLES))
+		return -1;
+
+	header->capture = payload[1];
+	header->offset = payload[2] | (payload[3] << 8);
+	header->trigger = payload[4] | (payload[5] << 8);
+	header->total = payload[6] | (payload[7] << 8);
+	header->count = payload[8];
+
+	if ((len != (size_t)SCOPE_HEADER + 3 * (header->count / 2) + 2 * (header->count & 1)) ||
+		(header->offset + header->count > header->total) || (header->trigger >= header->total))
+		return -1;
+	for (i = 0; i + 1 < header->count; i += 2, n += 3)
+	{
+		samples[i] = payload[n] | ((payload[n + 1] & 0x0F) << 8);
+		samples[i + 1] = (payload[n + 1] >> 4) | (payload[n + 2] << 4);
+	}
+	if (i < header->count)
+		samples[i] = payload[n] | (payload[n + 1] << 8);
+
+	return header->count;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void arm (void)
+{
+	filled = 0;
+	ready = false;
+	primed = false;
+	env = 0;
+	sent = 0;
+	state = SCOPE_ARMED;														// Last, the ADC callback takes it from here
+}
+
+static bool detect (uint16_t sample)
+{
+	int32_t x = sample & SAMPLE_MASK, level = cfg.level, dev;
+	bool hit = false;
+
+	switch (cfg.trigg)
+	{
+		case SCOPE_TRIGG_LEVEL:
+			hit = x >= level;
+			break;
+
+		case SCOPE_TRIGG_RISING:
+			hit = ready && (x >= level);
+			ready |= x < level - cfg.hyst;
+			break;
+
+		case SCOPE_TRIGG_FALLING:
+			hit = ready && (x <= level);
+			ready |= x > level + cfg.hyst;
+			break;
+
+		case SCOPE_TRIGG_CARRIER:												// Mean deviation from the running average
+			x <<= CARRIER_FRAC;
+			if (!primed)
+			{
+				dc = x;
+				primed = true;
+			}
+			dc += (x - dc) >> CARRIER_DC_SHIFT;
+			dev = (x > dc) ? x - dc : dc - x;
+			env += (dev - env) >> CARRIER_ENV_SHIFT;
+			hit = env >= (level << CARRIER_FRAC);
+			break;
+	}
+
+	return hit;
+}
+
+static size_t encode (uint16_t offset, uchar_t* payload)
+{
+	uint16_t total = cfg.pre + cfg.post, s[SCOPE_CHUNK_SAMPLES];
+	uint8_t count = MIN(total - offset, SCOPE_CHUNK_SAMPLES), i;
+	size_t n = SCOPE_HEADER;
+
+	for (i = 0; i < count; i++)
+		s[i] = ring[(start + offset + i) & RING_MASK];
+
+	payload[0] = SCOPE_TAG;
+	payload[1] = capture;
+	payload[2] = offset & 0xFF;
+	payload[3] = offset >> 8;
+	payload[4] = cfg.pre & 0xFF;
+	payload[5] = cfg.pre >> 8;
+	payload[6] = total & 0xFF;
+	payload[7] = total >> 8;
+	payload[8] = count;
+
+	for (i = 0; i + 1 < count; i += 2)											// Two samples in three bytes
+	{
+		payload[n++] = s[i] & 0xFF;
+		payload[n++] = (s[i] >> 8) | ((s[i + 1] & 0x0F) << 4);
+		payload[n++] = s[i + 1] >> 4;
+	}
+	if (i < count)
+	{
+		payload[n++] = s[i] & 0xFF;
+		payload[n++] = s[i] >> 8;
+	}
+
+	return n;
+}
+
+static void frameDone (const uchar_t* data)
+{
+	(void)data;
+	frames_done++;
+	if (notify && (state == SCOPE_DUMPING))
+		notify();
+}
+
+/******************************************************************************/
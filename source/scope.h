@@ -0,0 +1,157 @@
+/***************************************************************************//**
+  @file     scope.h
+  @brief    Triggered burst capture: pre-trigger ring on the ADC path, snapshot
+            dumped as binary frames once the post-trigger samples are in
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     Frame payload: {Tag}{Capture}{Offset LE16}{Trigger LE16}{Total LE16}{Count}{Samples},
+            samples packed 12-bit, wrapped by protocolPackBytes (CRC-16, COBS, 0x00)
+ ******************************************************************************/
+
+#ifndef _SCOPE_H_
+#define _SCOPE_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "protocol.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#ifndef SCOPE_BUFFER_SAMPLES
+#define SCOPE_BUFFER_SAMPLES		2048										// RAM: 2 bytes each, power of 2
+#endif // SCOPE_BUFFER_SAMPLES
+
+#define SCOPE_CHUNK_SAMPLES			64											// Samples per frame when dumping
+#define SCOPE_FRAMES				2											// Frames on the line at once, power of 2
+
+#define SCOPE_TAG					0xD0
+#define SCOPE_HEADER				9
+#define SCOPE_PAYLOAD_MAX			(SCOPE_HEADER + 3 * (SCOPE_CHUNK_SAMPLES / 2) + 2 * (SCOPE_CHUNK_SAMPLES & 1))
+#define SCOPE_FRAME_SIZE			(PROTOCOL_COBS_SIZE(SCOPE_PAYLOAD_MAX + PROTOCOL_CRC_SIZE) + 1)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/**
+ * @brief Trigger condition
+ * @param SCOPE_TRIGG_LEVEL Sample at or above the level
+ * @param SCOPE_TRIGG_RISING Crosses the level upwards, after being below level - hysteresis
+ * @param SCOPE_TRIGG_FALLING Crosses the level downwards, after being above level + hysteresis
+ * @param SCOPE_TRIGG_CARRIER Envelope (mean deviation from the running average) at or above the level
+ */
+typedef enum {
+	SCOPE_TRIGG_LEVEL,
+	SCOPE_TRIGG_RISING,
+	SCOPE_TRIGG_FALLING,
+	SCOPE_TRIGG_CARRIER
+} scope_trigger_t;
+
+typedef enum {
+	SCOPE_IDLE,
+	SCOPE_ARMED,																// Filling the pre-trigger ring, watching
+	SCOPE_TRIGGERED,															// Taking the post-trigger samples
+	SCOPE_DUMPING																// Snapshot frozen, going out
+} scope_state_t;
+
+/**
+ * @brief Capture configuration
+ * @param trigg Trigger condition
+ * @param level Trigger level, or envelope threshold for SCOPE_TRIGG_CARRIER (LSB)
+ * @param hyst Hysteresis for the edge triggers (LSB)
+ * @param pre Samples kept before the trigger
+ * @param post Samples taken from the trigger on, at least 1
+ * @param rearm Arm again once the snapshot is out
+ */
+typedef struct {
+	scope_trigger_t	trigg;
+	uint16_t		level;
+	uint16_t		hyst;
+	uint16_t		pre;
+	uint16_t		post;
+	bool			rearm;
+} scope_cfg_t;
+
+/**
+ * @brief Frame header, as decoded
+ * @param capture Capture number
+ * @param offset Index of the first sample of this frame in the snapshot
+ * @param trigger Index of the trigger sample in the snapshot
+ * @param total Samples in the snapshot
+ * @param count Samples in this frame
+ */
+typedef struct {
+	uint8_t		capture;
+	uint16_t	offset;
+	uint16_t	trigger;
+	uint16_t	total;
+	uint8_t		count;
+} scope_header_t;
+
+typedef void (*scope_callback_t)(void);
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Initialize the capture engine, idle, the serial port must be initialized already
+ * @param cb Called when scopeUpdate has work (snapshot complete, a frame sent), from the ISRs, NULL for none
+ */
+void scopeInit (scope_callback_t cb);
+
+/**
+ * @brief Arm a capture
+ * @param cfg Capture configuration
+ * @return Armed, false if busy dumping or pre + post does not fit SCOPE_BUFFER_SAMPLES
+ * @note The trigger is ignored until the pre-trigger samples are in
+ */
+bool scopeArm (const scope_cfg_t* cfg);
+
+/**
+ * @brief Stop watching or capturing, a snapshot already going out is finished
+ */
+void scopeDisarm (void);
+
+/**
+ * @brief Add a sample, from the ADC callback
+ * @param sample 12-bit sample
+ * @note Constant time, never blocks: samples are ignored while the snapshot goes out
+ */
+void scopePush (uint16_t sample);
+
+/**
+ * @brief Send the snapshot once complete, from the main loop
+ * @note Never blocks: frames wait while SCOPE_FRAMES frames are still going out
+ */
+void scopeUpdate (void);
+
+/**
+ * @brief Get the capture state
+ * @return Current state
+ */
+scope_state_t scopeGetState (void);
+
+/**
+ * @brief Decode a frame payload, see protocolUnpackBytes
+ * @param payload Payload
+ * @param len Payload length
+ * @param header Place to store the header
+ * @param samples Place to store the samples, SCOPE_CHUNK_SAMPLES
+ * @return Samples decoded, -1 if malformed
+ */
+int16_t scopeDecode (const uchar_t* payload, size_t len, scope_header_t* header, uint16_t* samples);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _SCOPE_H_
@@ -11,7 +11,10 @@
  * INCLUDE HEADER FILES
  ******************************************************************************/
 
+#include <string.h>
+
 #include "board.h"
+#include "macros.h"
 #include "uart.h"
 #include "serial.h"
 
@@ -22,6 +25,57 @@
 #define DEVELOPMENT_MODE			1
 
 #define SERIAL_PORT					UART0_ID
+#define SERIAL_BAUDRATE				1000000U										// Exact on UART0's core clock (SBR 6, BRFA 8), the stream alone needs ~300 kbaud
+
+/* Held frames, the one being searched and as much again for the line to go on while they are */
+_Static_assert((SERIAL_FRAMES_CANT + 2) * (SERIAL_FRAME_MAX + 1) <= UART_DMA_RX_SIZE, "Held frames leave the DMA no headroom in the ring");
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/**
+ * @brief Frame held by the application
+ * @param data Frame start, in the receive ring or in its linearization buffer
+ * @param span Ring bytes to release, delimiter included
+ */
+typedef struct {
+	const uchar_t*	data;
+	uint32_t		span;
+} frame_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Frame transmitted, forwards to the callback given to serialWriteFrame
+ * @param id UART ID
+ * @param data Frame
+ */
+static void frameDone (uart_id_t id, const uchar_t* data);
+
+/**
+ * @brief Check whether the DMA lapped the ring, dropping the held frames if so
+ * @return The held frames were overwritten
+ */
+static bool lapped (void);
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static serial_callback_t callbacks[UART_DESC_CANT];							// Frames complete in order
+static uint8_t cb_in, cb_out;													// Free-running, UART_DESC_CANT divides 256
+
+static frame_t frames[SERIAL_FRAMES_CANT];
+static uchar_t linear[SERIAL_FRAMES_CANT][SERIAL_FRAME_MAX];					// Only for frames that wrap around the ring
+static uint8_t frames_in, frames_out;											// Free-running, SERIAL_FRAMES_CANT divides 256
+static uint32_t held;															// Ring bytes under taken frames
+static uint32_t scanned;														// Bytes of the next frame already searched
+static bool reading;															// serialReadData holds the oldest frame
+static uint32_t overruns;														// Ring bytes lost, as last seen
+static bool resync;																// Skipping up to the next delimiter after a lap
 
 /*******************************************************************************
  *******************************************************************************
@@ -33,13 +87,13 @@
 
 bool serialInit (void)
 {
-	uart_cfg_t config = {9600,
+	uart_cfg_t config = {SERIAL_BAUDRATE,
 						 UART_MODE_8,
 						 UART_PARITY_NONE,
 						 UART_STOPS_1,
 						 UART_RX_TX_ENABLED,
 						 UART_FIFO_RX_TX_ENABLED,
-						 UART_ISR_PERIODIC};
+						 UART_ISR_DMA};
 
 	return uartInit(SERIAL_PORT, config);
 }
@@ -49,13 +103,100 @@ bool serialWriteData (uchar_t* data, uint8_t len)
 	return len == uartWriteMsg(SERIAL_PORT, data, len);
 }
 
+bool serialWriteFrame (const uchar_t* data, uint32_t len, serial_callback_t cb)
+{
+	bool status = (uint8_t)(cb_in - cb_out) < UART_DESC_CANT;
+
+	if(status)
+	{
+		callbacks[cb_in % UART_DESC_CANT] = cb;
+		status = uartWriteDesc(SERIAL_PORT, data, len, frameDone);
+		cb_in += status;
+	}
+
+	return status;
+}
+
 uchar_t* serialReadData (uint8_t* len)
 {
-	static unsigned char data[QUEUE_MAX_SIZE];
+	const uchar_t* data = NULL;
+	uint32_t length = 0;
 
-	*len = uartReadMsg(SERIAL_PORT, data, uartGetRxMsgLength(SERIAL_PORT));
+	if (reading)
+		serialReleaseFrame();
+	reading = serialReadFrame(&data, &length);
+	*len = length;
 
-	return data;
+	return (uchar_t*)data;
+}
+
+bool serialReadFrame (const uchar_t** data, uint32_t* len)
+{
+	const uchar_t* ptr, * delim = NULL;
+	uint32_t count, copied;
+	frame_t* frame = &frames[frames_in % SERIAL_FRAMES_CANT];
+	bool status;
+
+	lapped();
+
+	/* After a lap the ring starts mid frame: drop up to the next delimiter */
+	while (resync && (count = uartRxPeek(SERIAL_PORT, 0, &ptr)))
+	{
+		if ((delim = memchr(ptr, SERIAL_FRAME_DELIM, count)))
+		{
+			count = delim - ptr + 1;
+			resync = false;
+		}
+		uartRxConsume(SERIAL_PORT, count);
+	}
+	delim = NULL;
+	status = !resync && ((uint8_t)(frames_in - frames_out) < SERIAL_FRAMES_CANT);
+
+	/* Search the delimiter from where the last call stopped, one contiguous piece at a time */
+	while (status && !delim && (scanned < SERIAL_FRAME_MAX) && (count = uartRxPeek(SERIAL_PORT, held + scanned, &ptr)))
+	{
+		count = MIN(count, SERIAL_FRAME_MAX - scanned);
+		if ((delim = memchr(ptr, SERIAL_FRAME_DELIM, count)))
+			count = delim - ptr;
+		scanned += count;
+	}
+	status = status && (delim || (scanned == SERIAL_FRAME_MAX)) && !lapped();
+
+	if (status)
+	{
+		*len = scanned;
+		frame->span = scanned + (delim != NULL);
+
+		/* In place if contiguous, otherwise put both pieces together */
+		if (uartRxPeek(SERIAL_PORT, held, &ptr) >= scanned)
+			frame->data = ptr;
+		else
+		{
+			for (copied = 0; copied < scanned; copied += count)
+			{
+				count = MIN(uartRxPeek(SERIAL_PORT, held + copied, &ptr), scanned - copied);
+				memcpy(linear[frames_in % SERIAL_FRAMES_CANT] + copied, ptr, count);
+			}
+			frame->data = linear[frames_in % SERIAL_FRAMES_CANT];
+		}
+
+		*data = frame->data;
+		held += frame->span;
+		scanned = 0;
+		frames_in++;
+	}
+
+	return status;
+}
+
+void serialReleaseFrame (void)
+{
+	if (frames_in != frames_out)
+	{
+		uint32_t span = frames[frames_out++ % SERIAL_FRAMES_CANT].span;
+		uartRxConsume(SERIAL_PORT, span);
+		held -= span;
+	}
 }
 
 bool serialWriteStatus (void)
@@ -68,6 +209,11 @@ bool serialReadStatus (void)
 	return uartIsRxMsg(SERIAL_PORT);
 }
 
+bool serialReadMsgComplete (void)
+{
+	return uartIsRxMsgComplete(SERIAL_PORT);
+}
+
 bool serialWriteDataBlocking (uchar_t* data, uint8_t len)
 {
 	uint8_t aux = uartWriteMsg(SERIAL_PORT, data, len);
@@ -79,13 +225,49 @@ bool serialWriteDataBlocking (uchar_t* data, uint8_t len)
 
 uchar_t* serialReadDataBlocking (uint8_t* len)
 {
-	static unsigned char data[QUEUE_MAX_SIZE];
+	uchar_t* data;
 
-	*len = 0;
-	while (!uartIsRxMsg(SERIAL_PORT))
-		*len += uartReadMsg(SERIAL_PORT, data, uartGetRxMsgLength(SERIAL_PORT));
+	while (!(data = serialReadData(len)));
 
 	return data;
 }
 
+bool serialWritePolled (const uchar_t* data, uint32_t len)
+{
+	return uartWritePolled(SERIAL_PORT, data, len);
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void frameDone (uart_id_t id, const uchar_t* data)
+{
+	serial_callback_t cb = callbacks[cb_out++ % UART_DESC_CANT];
+
+	(void)id;
+	if (cb != NULL)
+		cb(data);
+}
+
+static bool lapped (void)
+{
+	uint32_t lost = uartRxOverruns(SERIAL_PORT);
+	bool status = lost != overruns;
+
+	if (status)
+	{
+		overruns = lost;
+		frames_out = frames_in;
+		held = 0;
+		scanned = 0;
+		reading = false;
+		resync = true;
+	}
+
+	return status;
+}
+
 /******************************************************************************/
@@ -23,12 +23,18 @@
 
 #define DEVELOPMENT_MODE			1
 
+#define SERIAL_FRAME_DELIM			'\n'											// Ends every received frame
+#define SERIAL_FRAME_MAX			64U											// Longer frames are split
+#define SERIAL_FRAMES_CANT			4U											// Frames held at once by the application, power of 2
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
 typedef unsigned char uchar_t;
 
+typedef void (*serial_callback_t)(const uchar_t* data);
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -48,12 +54,36 @@ bool serialInit (void);
 bool serialWriteData (uchar_t* data, uint8_t len);
 
 /**
- * @brief Read data from serial port
- * @param len Number of bytes read
- * @return Data read
+ * @brief Send a frame straight from the caller's memory, no copy nor wait
+ * @param data Frame to be sent, must stay valid until the callback
+ * @param len Number of bytes to be sent, any length
+ * @param cb Called once the frame is out of the caller's memory, NULL for none
+ * @return Frame was queued
+ */
+bool serialWriteFrame (const uchar_t* data, uint32_t len, serial_callback_t cb);
+
+/**
+ * @brief Read the next received frame, valid until the next call
+ * @param len Frame length, without the delimiter, 0 if no complete frame arrived
+ * @return Frame, in place in the receive ring when it does not wrap
  */
 uchar_t* serialReadData (uint8_t* len);
 
+/**
+ * @brief Take the next received frame, zero-copy, up to SERIAL_FRAMES_CANT held at once
+ * @param data Place to store the frame address, valid until the frame is released
+ * @param len Frame length, without the delimiter
+ * @return A complete frame was taken
+ * @note If the line overwrote held frames they are all dropped, releasing them does nothing,
+ *       and reading starts again after the next delimiter
+ */
+bool serialReadFrame (const uchar_t** data, uint32_t* len);
+
+/**
+ * @brief Give the oldest taken frame back to the receive ring
+ */
+void serialReleaseFrame (void);
+
 /**
  * @brief Check if there is data to be written
  * @return true if all data was sent
@@ -66,6 +96,12 @@ bool serialWriteStatus (void);
  */
 bool serialReadStatus (void);
 
+/**
+ * @brief Check if the line went idle after the last received bytes
+ * @return true once per complete message
+ */
+bool serialReadMsgComplete (void);
+
 /**
  * @brief Send data through serial port (blocking)
  * @param data Data to be sent
@@ -75,11 +111,20 @@ bool serialReadStatus (void);
 bool serialWriteDataBlocking (uchar_t* data, uint8_t len);
 
 /**
- * @brief Read data from serial port (blocking)
- * @return Data read
+ * @brief Read the next received frame (blocking), valid until the next read
+ * @param len Frame length, without the delimiter
+ * @return Frame
  */
 uchar_t* serialReadDataBlocking (uint8_t* len);
 
+/**
+ * @brief Send data polling the port, with interrupts off (from a fault handler)
+ * @param data Data to be sent
+ * @param len Number of bytes to be sent
+ * @return Data was sent
+ */
+bool serialWritePolled (const uchar_t* data, uint32_t len);
+
 /*******************************************************************************
  ******************************************************************************/
 
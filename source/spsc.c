@@ -0,0 +1,122 @@
+/***************************************************************************//**
+  @file     spsc.c
+  @brief    Lock-free Single-Producer/Single-Consumer Ring Buffer
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "prof.h"
+#include "spsc.h"
+#include "trace.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// Word accesses with ordering (ldr/str + dmb on the Cortex-M4) ////////////////
+
+#define LOAD_ACQUIRE(x)			__atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define LOAD_RELAXED(x)			__atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define STORE_RELEASE(x, v)		__atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Copy one element, with fast paths for the common word sizes
+ * @param dst Destination
+ * @param src Source
+ * @param size Element size
+ */
+static inline void copy (void* dst, const void* src, uint8_t size);
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+bool spscInit (spsc_t* ring, void* storage, uint32_t capacity, uint8_t data_size)
+{
+	bool status = (ring != NULL) && (storage != NULL) && data_size && SPSC_IS_POW2(capacity);
+
+	if (status)
+	{
+		ring->items = (uint8_t*)storage;
+		ring->mask = capacity - 1;
+		ring->data_size = data_size;
+		ring->head = ring->tail = 0;
+	}
+
+	return status;
+}
+
+bool spscPush (spsc_t* ring, const void* data)
+{
+	PROF_BEGIN(PROF_SPSC_PUSH);
+	uint32_t head = LOAD_RELAXED(ring->head);									// Own index
+	bool status = (head - LOAD_ACQUIRE(ring->tail)) <= ring->mask;				// Slot was released by the consumer
+
+	if (status)
+	{
+		copy(ring->items + (head & ring->mask) * ring->data_size, data, ring->data_size);
+		STORE_RELEASE(ring->head, head + 1);									// Publish after the data is written
+	}
+	else
+		TRACE_MARK(TRACE_QUEUE, TRACE_SPSC_FULL, (uint32_t)(uintptr_t)ring);
+	PROF_END(PROF_SPSC_PUSH);
+
+	return status;
+}
+
+bool spscPop (spsc_t* ring, void* data)
+{
+	PROF_BEGIN(PROF_SPSC_POP);
+	uint32_t tail = LOAD_RELAXED(ring->tail);									// Own index
+	bool status = LOAD_ACQUIRE(ring->head) != tail;								// Slot was published by the producer
+
+	if (status)
+	{
+		copy(data, ring->items + (tail & ring->mask) * ring->data_size, ring->data_size);
+		STORE_RELEASE(ring->tail, tail + 1);									// Release after the data is read
+	}
+	PROF_END(PROF_SPSC_POP);
+
+	return status;
+}
+
+uint32_t spscSize (const spsc_t* ring)
+{
+	return LOAD_ACQUIRE(ring->head) - LOAD_ACQUIRE(ring->tail);
+}
+
+bool spscIsEmpty	(const spsc_t* ring) { return !spscSize(ring); }
+bool spscIsFull		(const spsc_t* ring) { return spscSize(ring) > ring->mask; }
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static inline void copy (void* dst, const void* src, uint8_t size)
+{
+	switch (size)
+	{
+		case sizeof(uint8_t):	*(uint8_t*)dst = *(const uint8_t*)src;		break;
+		case sizeof(uint16_t):	*(uint16_t*)dst = *(const uint16_t*)src;	break;
+		case sizeof(uint32_t):	*(uint32_t*)dst = *(const uint32_t*)src;	break;
+		default:				memcpy(dst, src, size);						break;
+	}
+}
+
+/******************************************************************************/
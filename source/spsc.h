@@ -0,0 +1,116 @@
+/***************************************************************************//**
+  @file     spsc.h
+  @brief    Lock-free Single-Producer/Single-Consumer Ring Buffer
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     One side may be an ISR and the other the main loop. Only the
+            producer writes head and only the consumer writes tail, so no
+            interrupt masking is needed: ordering is given by acquire/release
+            word accesses (DMB on the Cortex-M4)
+ ******************************************************************************/
+
+#ifndef _SPSC_H_
+#define _SPSC_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define SPSC_IS_POW2(n)				(((n) != 0) && !((n) & ((n) - 1)))
+
+/**
+ * @brief Declare the storage for a ring
+ * @param name Storage name
+ * @param capacity Number of elements, must be a power of two
+ * @param type Element type
+ */
+#define SPSC_STORAGE(name, capacity, type) \
+	static type name[(capacity)]; \
+	_Static_assert(SPSC_IS_POW2(capacity), #name " capacity must be a power of two")
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/**
+ * @brief Ring structure
+ * @param items Storage, capacity * data_size bytes
+ * @param mask Capacity - 1, used to wrap the free-running indexes
+ * @param data_size Size of the data type
+ * @param head Next slot to write, only written by the producer
+ * @param tail Next slot to read, only written by the consumer
+ */
+typedef struct {
+	uint8_t*			items;
+	uint32_t			mask;
+	uint8_t				data_size;
+	volatile uint32_t	head;
+	volatile uint32_t	tail;
+} spsc_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Initialize a ring over caller-provided storage
+ * @param ring Ring to initialize
+ * @param storage Buffer of capacity * data_size bytes
+ * @param capacity Number of elements, must be a power of two
+ * @param data_size Size of the data type
+ * @return Initialization succeed
+ * @note Must be called before the producer and the consumer start
+ */
+bool spscInit (spsc_t* ring, void* storage, uint32_t capacity, uint8_t data_size);
+
+/**
+ * @brief Insert an element at the back of the ring (producer side)
+ * @param ring Ring
+ * @param data Element to copy in
+ * @return Element was pushed, false if the ring is full
+ */
+bool spscPush (spsc_t* ring, const void* data);
+
+/**
+ * @brief Remove an element from the front of the ring (consumer side)
+ * @param ring Ring
+ * @param data Place to copy the element out
+ * @return Element was popped, false if the ring is empty
+ */
+bool spscPop (spsc_t* ring, void* data);
+
+/**
+ * @brief Get the number of elements in the ring
+ * @param ring Ring
+ * @return Elements count, exact from either side, a snapshot from a third one
+ */
+uint32_t spscSize (const spsc_t* ring);
+
+/**
+ * @brief Check if the ring is empty
+ * @param ring Ring
+ * @return true if empty
+ */
+bool spscIsEmpty (const spsc_t* ring);
+
+/**
+ * @brief Check if the ring is full
+ * @param ring Ring
+ * @return true if full
+ */
+bool spscIsFull (const spsc_t* ring);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _SPSC_H_
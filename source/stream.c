@@ -0,0 +1,255 @@
+/***************************************************************************//**
+  @file     stream.c
+  @brief    Binary sample streaming: blocks filled from the ADC path, sent as
+            packed 12-bit or delta-coded frames without blocking
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "macros.h"
+#include "serial.h"
+#include "stream.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define SAMPLE_MASK					0x0FFF										// 12 bits
+
+#define ZIGZAG_ENCODE(d)			((uint16_t)(((uint16_t)(d) << 1) ^ (uint16_t)-((uint16_t)(d) >> 15)))
+#define ZIGZAG_DECODE(z)			((int16_t)(((z) >> 1) ^ (uint16_t)-((z) & 1)))
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Encode a full block into a frame payload
+ * @param block Block to encode (free-running number)
+ * @param payload Place to store the payload, STREAM_PAYLOAD_MAX bytes
+ * @return Payload length
+ */
+static size_t encode (uint32_t block, uchar_t* payload);
+
+/**
+ * @brief Serial callback, a frame buffer can be reused
+ * @param data Frame sent
+ */
+static void frameDone (const uchar_t* data);
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static uint16_t blocks[STREAM_BLOCKS][STREAM_BLOCK_SAMPLES];
+static uint16_t gaps[STREAM_BLOCKS];											// Samples dropped right before each block
+static volatile uint32_t filled;												// Blocks completed, by streamPush
+static volatile uint32_t sent;													// Blocks encoded, by streamUpdate
+static uint8_t fill;
+static uint32_t gap;
+
+static uchar_t frames[STREAM_FRAMES][STREAM_FRAME_SIZE];
+static uint32_t frames_out;
+static volatile uint32_t frames_done;
+
+static stream_format_t mode;
+static stream_callback_t notify;
+static volatile stream_stats_t stats;
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void streamInit (stream_format_t format, stream_callback_t cb)
+{
+	mode = format;
+	notify = cb;
+	filled = sent = 0;
+	fill = 0;
+	gap = 0;
+	frames_out = frames_done = 0;
+	stats = (stream_stats_t){ 0, 0, 0, 0, 0 };
+}
+
+void streamPush (uint16_t sample)
+{
+	uint32_t block = filled;
+
+	stats.samples++;
+
+	if (block - sent == STREAM_BLOCKS)											// Every block full: the link is not keeping up
+	{
+		stats.dropped++;
+		gap++;
+		return;
+	}
+
+	if (!fill)
+	{
+		gaps[block % STREAM_BLOCKS] = MIN(gap, UINT16_MAX);
+		gap = 0;
+	}
+	blocks[block % STREAM_BLOCKS][fill] = sample & SAMPLE_MASK;
+	if (++fill == STREAM_BLOCK_SAMPLES)
+	{
+		fill = 0;
+		filled = block + 1;														// Publish, after the samples
+		if (notify)
+			notify();
+	}
+}
+
+void streamUpdate (void)
+{
+	uchar_t payload[STREAM_PAYLOAD_MAX], * frame;
+	size_t len;
+
+	while ((sent != filled) && (frames_out - frames_done < STREAM_FRAMES))
+	{
+		frame = frames[frames_out % STREAM_FRAMES];
+		len = protocolPackBytes(payload, encode(sent, payload), frame);
+		if (!serialWriteFrame(frame, len, frameDone))							// Transmit queue full, try again later
+			break;
+
+		stats.packed += (payload[0] & ~STREAM_TAG) == STREAM_PACKED;
+		stats.frames++;
+		stats.bytes += len;
+		frames_out++;
+		sent++;																	// The block can be filled again
+	}
+}
+
+stream_stats_t streamGetStats (void)
+{
+	return (stream_stats_t){ stats.samples, stats.dropped, stats.frames, stats.packed, stats.bytes };
+}
+
+int16_t streamDecode (const uchar_t* payload, size_t len, stream_header_t* header, uint16_t* samples)
+{
+	size_t n = STREAM_HEADER;
+	uint16_t zigzag;
+	uint8_t i;
+
+	if ((len < STREAM_HEADER) || ((payload[0] & ~0x01) != STREAM_TAG) || (payload[4] > STREAM_BLOCK_SAMPLES))
+		return -1;
+
+	header->format = (stream_format_t)(payload[0] & 0x01);
+	header->seq = payload[1];
+	header->dropped = payload[2] | (payload[3] << 8);
+	header->count = payload[4];
+
+	if (header->format == STREAM_PACKED)
+	{
+		if (len != (size_t)STREAM_HEADER + 3 * (header->count / 2) + 2 * (header->count & 1))
+			return -1;
+		for (i = 0; i + 1 < header->count; i += 2, n += 3)
+		{
+			samples[i] = payload[n] | ((payload[n + 1] & 0x0F) << 8);
+			samples[i + 1] = (payload[n + 1] >> 4) | (payload[n + 2] << 4);
+		}
+		if (i < header->count)
+			samples[i] = payload[n] | (payload[n + 1] << 8);
+	}
+	else if (header->count)
+	{
+		if (len < STREAM_HEADER + 2)
+			return -1;
+		samples[0] = payload[n] | (payload[n + 1] << 8);
+		for (i = 1, n += 2; i < header->count; i++)
+		{
+			if (n >= len)
+				return -1;
+			zigzag = payload[n] & 0x7F;
+			if (payload[n++] & 0x80)											// Never more than 2 bytes for 12 bits
+			{
+				if ((n >= len) || (payload[n] & 0x80))
+					return -1;
+				zigzag |= payload[n++] << 7;
+			}
+			samples[i] = (samples[i - 1] + ZIGZAG_DECODE(zigzag)) & SAMPLE_MASK;
+		}
+		if (n != len)
+			return -1;
+	}
+
+	return header->count;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static size_t encode (uint32_t block, uchar_t* payload)
+{
+	const uint16_t* s = blocks[block % STREAM_BLOCKS];
+	size_t n = STREAM_HEADER, packed = 3 * (STREAM_BLOCK_SAMPLES / 2) + 2 * (STREAM_BLOCK_SAMPLES & 1), delta = 2;
+	stream_format_t format = mode;
+	uint16_t zigzag;
+	uint8_t i;
+
+	if (format == STREAM_AUTO)													// Size the delta coding first, it is cheap
+	{
+		for (i = 1; i < STREAM_BLOCK_SAMPLES; i++)
+			delta += (ZIGZAG_ENCODE(s[i] - s[i - 1]) < 0x80) ? 1 : 2;
+		format = (delta < packed) ? STREAM_DELTA : STREAM_PACKED;
+	}
+
+	payload[0] = STREAM_TAG | format;
+	payload[1] = (uchar_t)block;
+	payload[2] = gaps[block % STREAM_BLOCKS] & 0xFF;
+	payload[3] = gaps[block % STREAM_BLOCKS] >> 8;
+	payload[4] = STREAM_BLOCK_SAMPLES;
+
+	if (format == STREAM_PACKED)												// Two samples in three bytes
+	{
+		for (i = 0; i + 1 < STREAM_BLOCK_SAMPLES; i += 2)
+		{
+			payload[n++] = s[i] & 0xFF;
+			payload[n++] = (s[i] >> 8) | ((s[i + 1] & 0x0F) << 4);
+			payload[n++] = s[i + 1] >> 4;
+		}
+		if (i < STREAM_BLOCK_SAMPLES)
+		{
+			payload[n++] = s[i] & 0xFF;
+			payload[n++] = s[i] >> 8;
+		}
+	}
+	else																		// Differences, 1 byte when under +-64
+	{
+		payload[n++] = s[0] & 0xFF;
+		payload[n++] = s[0] >> 8;
+		for (i = 1; i < STREAM_BLOCK_SAMPLES; i++)
+		{
+			zigzag = ZIGZAG_ENCODE(s[i] - s[i - 1]);
+			if (zigzag < 0x80)
+				payload[n++] = zigzag;
+			else
+			{
+				payload[n++] = (zigzag & 0x7F) | 0x80;
+				payload[n++] = zigzag >> 7;
+			}
+		}
+	}
+
+	return n;
+}
+
+static void frameDone (const uchar_t* data)
+{
+	(void)data;
+	frames_done++;
+	if (notify)																	// Blocks may be waiting for the frame
+		notify();
+}
+
+/******************************************************************************/
@@ -0,0 +1,129 @@
+/***************************************************************************//**
+  @file     stream.h
+  @brief    Binary sample streaming: blocks filled from the ADC path, sent as
+            packed 12-bit or delta-coded frames without blocking
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     Frame payload: {Tag|Format}{Seq}{Dropped LE16}{Count}{Samples},
+            wrapped by protocolPackBytes (CRC-16, COBS, 0x00)
+ ******************************************************************************/
+
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "protocol.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define STREAM_BLOCK_SAMPLES		64											// Samples per frame
+#define STREAM_BLOCKS				4											// Blocks being filled or waiting, power of 2
+#define STREAM_FRAMES				2											// Frames on the line at once, power of 2
+
+#define STREAM_TAG					0xC0
+#define STREAM_HEADER				5
+#define STREAM_PAYLOAD_MAX			(STREAM_HEADER + 2 + 2 * (STREAM_BLOCK_SAMPLES - 1))	// Worst case: delta-coded
+#define STREAM_FRAME_SIZE			(PROTOCOL_COBS_SIZE(STREAM_PAYLOAD_MAX + PROTOCOL_CRC_SIZE) + 1)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/**
+ * @brief Sample encoding
+ * @param STREAM_PACKED 12-bit samples, two in three bytes
+ * @param STREAM_DELTA First sample, then zigzag varint differences
+ * @param STREAM_AUTO Whichever is smaller, block by block
+ */
+typedef enum {
+	STREAM_PACKED,
+	STREAM_DELTA,
+	STREAM_AUTO
+} stream_format_t;
+
+/**
+ * @brief Frame header, as decoded
+ * @param format STREAM_PACKED or STREAM_DELTA
+ * @param seq Block sequence number, gaps mean blocks dropped whole
+ * @param dropped Samples dropped just before this block (saturates)
+ * @param count Samples in the block
+ */
+typedef struct {
+	stream_format_t	format;
+	uint8_t			seq;
+	uint16_t		dropped;
+	uint8_t			count;
+} stream_header_t;
+
+/**
+ * @brief Stream counters
+ * @param samples Samples taken from the ADC path
+ * @param dropped Samples dropped because every block was full
+ * @param frames Frames handed to the serial port
+ * @param packed Frames sent as packed 12-bit
+ * @param bytes Bytes handed to the serial port
+ */
+typedef struct {
+	uint32_t	samples;
+	uint32_t	dropped;
+	uint32_t	frames;
+	uint32_t	packed;
+	uint32_t	bytes;
+} stream_stats_t;
+
+typedef void (*stream_callback_t)(void);
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Initialize the stream, the serial port must be initialized already
+ * @param format Sample encoding
+ * @param cb Called when streamUpdate has work (a block filled, a frame sent), from the ISRs, NULL for none
+ */
+void streamInit (stream_format_t format, stream_callback_t cb);
+
+/**
+ * @brief Add a sample, from the ADC callback
+ * @param sample 12-bit sample
+ * @note Never blocks: when every block is full the sample is counted as dropped
+ */
+void streamPush (uint16_t sample);
+
+/**
+ * @brief Encode full blocks and hand them to the serial port, from the main loop
+ * @note Never blocks: blocks wait while STREAM_FRAMES frames are still going out
+ */
+void streamUpdate (void);
+
+/**
+ * @brief Get the stream counters
+ * @return Counters since streamInit
+ */
+stream_stats_t streamGetStats (void);
+
+/**
+ * @brief Decode a frame payload, see protocolUnpackBytes
+ * @param payload Payload
+ * @param len Payload length
+ * @param header Place to store the header
+ * @param samples Place to store the samples, STREAM_BLOCK_SAMPLES
+ * @return Samples decoded, -1 if malformed
+ */
+int16_t streamDecode (const uchar_t* payload, size_t len, stream_header_t* header, uint16_t* samples);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _STREAM_H_
@@ -0,0 +1,135 @@
+/***************************************************************************//**
+  @file     cqueue_bench.c
+  @brief    Circular Queue Benchmark: per-element vs bulk push/pop throughput
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. cqueue_bench.c ../cqueue.c
+            Add -DPROF_ZONES=1 ../prof.c for the push and pop profiling zones
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cqueue.h"
+#include "prof.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define BENCH_BYTES		(16UL * 1024 * 1024)
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+QUEUE_STATIC_DEFINE(byte_queue, uint8_t, QUEUE_MAX_SIZE);
+
+QUEUE_STORAGE(pool_items, QUEUE_MAX_SIZE, uint8_t);
+static byte_queue_t typed;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static double now (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	queue_id_t id = queueInitStatic(pool_items, QUEUE_MAX_SIZE, sizeof(uint8_t));
+	uint8_t in[QUEUE_MAX_SIZE], out[QUEUE_MAX_SIZE];
+	unsigned long errors = 0;
+	double st, et;
+	static char zones[1024];
+
+	profInit();
+	for (count_t i = 0; i < QUEUE_MAX_SIZE; i++)
+		in[i] = (uint8_t)(i * 7 + 1);
+
+	printf("%6s %14s %14s %14s\n", "chunk", "1-by-1 MB/s", "bulk MB/s", "static MB/s");
+	for (count_t chunk = 1; chunk <= QUEUE_MAX_SIZE; chunk *= 2)
+	{
+		double single, bulk, fixed;
+
+		/* Per-element calls, as uartReadMsg/uartWriteMsg used to do */
+		st = now();
+		for (unsigned long done = 0; done < BENCH_BYTES; done += chunk)
+		{
+			for (count_t i = 0; i < chunk; i++)
+				queuePush(id, &in[i]);
+			for (count_t i = 0; i < chunk; i++)
+				out[i] = *(uint8_t*)queuePop(id);
+		}
+		et = now();
+		single = BENCH_BYTES / (et - st) / 1e6;
+		errors += memcmp(in, out, chunk) != 0;
+
+		/* One call per chunk, wrapping handled once */
+		st = now();
+		for (unsigned long done = 0; done < BENCH_BYTES; done += chunk)
+		{
+			queuePushN(id, in, chunk);
+			queuePopN(id, out, chunk);
+		}
+		et = now();
+		bulk = BENCH_BYTES / (et - st) / 1e6;
+		errors += memcmp(in, out, chunk) != 0;
+
+		/* Compile-time sized queue, element copies resolved by the compiler */
+		st = now();
+		for (unsigned long done = 0; done < BENCH_BYTES; done += chunk)
+		{
+			for (count_t i = 0; i < chunk; i++)
+				byte_queuePush(&typed, in[i]);
+			for (count_t i = 0; i < chunk; i++)
+				byte_queuePop(&typed, &out[i]);
+		}
+		et = now();
+		fixed = BENCH_BYTES / (et - st) / 1e6;
+		errors += memcmp(in, out, chunk) != 0;
+
+		printf("%6u %14.1f %14.1f %14.1f\n", (unsigned)chunk, single, bulk, fixed);
+	}
+
+	/* Partial transfers when the queue fills or empties */
+	queueClear(id);
+	errors += queuePushN(id, in, QUEUE_MAX_SIZE + 5) != QUEUE_MAX_SIZE;
+	errors += !queueIsFull(id);
+	errors += queuePopN(id, out, QUEUE_MAX_SIZE + 5) != QUEUE_MAX_SIZE;
+	errors += memcmp(in, out, QUEUE_MAX_SIZE) != 0;
+	errors += !queueIsEmpty(id);
+
+	errors += byte_queuePushN(&typed, in, QUEUE_MAX_SIZE + 5) != QUEUE_MAX_SIZE;
+	errors += !byte_queueIsFull(&typed);
+	errors += byte_queuePopN(&typed, out, QUEUE_MAX_SIZE + 5) != QUEUE_MAX_SIZE;
+	errors += memcmp(in, out, QUEUE_MAX_SIZE) != 0;
+	errors += !byte_queueIsEmpty(&typed);
+
+	if (profDump(zones, sizeof(zones)))											// Per call, on top of the throughput above
+		printf("%s", zones);
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
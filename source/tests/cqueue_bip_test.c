@@ -0,0 +1,129 @@
+/***************************************************************************//**
+  @file     cqueue_bip_test.c
+  @brief    Circular Queue Testbench: zero-copy (bip-buffer) access
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. cqueue_bip_test.c ../cqueue.c
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cqueue.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_SIZE		13
+#define TEST_STEPS		2000000UL
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+QUEUE_STORAGE(items, TEST_SIZE, uint16_t);
+
+static uint16_t model[1 << 16];													// Reference FIFO, far larger than the queue
+static unsigned long head, tail, errors;
+static uint16_t next;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void check (uint16_t data)
+{
+	if ((tail == head) || (model[tail++ & 0xFFFF] != data))
+		errors++;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	queue_id_t id = queueInitStatic(items, TEST_SIZE, sizeof(uint16_t));
+	uint16_t buffer[TEST_SIZE + 2];
+	unsigned long reserves = 0, skipped = 0;
+	data_t ptr;
+
+	srand(1);
+	for (unsigned long step = 0; step < TEST_STEPS; step++)
+	{
+		count_t n = rand() % (TEST_SIZE + 2), count;
+
+		switch (rand() % 6)
+		{
+			case 0: /* Zero-copy write, region must be contiguous */
+				if (queueReserve(id, n, &ptr))
+				{
+					count_t commit = n ? rand() % (n + 1) : 0;
+					for (count_t i = 0; i < commit; i++)
+						((uint16_t*)ptr)[i] = model[head++ & 0xFFFF] = next++;
+					skipped += (uint16_t*)ptr == items && queueSize(id);
+					queueCommit(id, commit);
+					reserves++;
+				}
+				break;
+
+			case 1: /* Zero-copy read */
+				count = queuePeekContiguous(id, &ptr);
+				if (count > queueSize(id))
+					errors++;
+				count = queueConsume(id, rand() % (count + 1));
+				for (count_t i = 0; i < count; i++)
+					check(((uint16_t*)ptr)[i]);
+				break;
+
+			case 2:
+				for (count_t i = 0; i < n; i++)
+					buffer[i] = model[(head + i) & 0xFFFF] = next + i;
+				count = queuePushN(id, buffer, n);
+				head += count;
+				next += count;
+				break;
+
+			case 3:
+				count = queuePopN(id, buffer, n);
+				for (count_t i = 0; i < count; i++)
+					check(buffer[i]);
+				break;
+
+			case 4:
+				model[head & 0xFFFF] = next;
+				if (queuePush(id, &next) != QUEUE_OVERFLOW)
+					head++, next++;
+				break;
+
+			case 5:
+				if ((ptr = queuePop(id)) != QUEUE_UNDERFLOW)
+					check(*(uint16_t*)ptr);
+				break;
+		}
+
+		if (queueSize(id) != head - tail)
+			errors++;
+		if ((head != tail) && (*(uint16_t*)queueFront(id) != model[tail & 0xFFFF]))
+			errors++;
+		if ((head != tail) && (*(uint16_t*)queueBack(id) != model[(head - 1) & 0xFFFF]))
+			errors++;
+	}
+
+	printf("Steps: %lu, reservations: %lu (%lu wrapped early), errors: %lu\n", TEST_STEPS, reserves, skipped, errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,157 @@
+/***************************************************************************//**
+  @file     cqueue_stats_test.c
+  @brief    Circular Queue Testbench: statistics counters and latency buckets
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -DQUEUE_STATS=1 -I.. cqueue_stats_test.c ../cqueue.c
+            A fake clock moves only when the test says so, so every latency
+            sampled is known and has one bucket it can land in.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+
+#include "cqueue.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_SIZE		8
+
+#if !QUEUE_STATS
+#error "Build with -DQUEUE_STATS=1"
+#endif
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+QUEUE_STORAGE(items, TEST_SIZE, uint16_t);
+
+static const uint32_t latencies[] = { 0, 1, 3, 4, 15, 16, 63, 64, 255, 256, 1023, 1024, 4095, 4096, 16383, 16384, 100000, 0xFFFFFFFFUL };
+
+static uint32_t now;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static uint32_t fakeClock (void)
+{
+	return now;
+}
+
+static uint8_t bucket (uint32_t latency)										// Smallest i with latency < 4^i, counted the slow way
+{
+	uint8_t i = 0;
+
+	for (uint64_t limit = 1; (latency >= limit) && (i < QUEUE_STATS_BUCKETS - 1); limit *= 4)
+		i++;
+
+	return i;
+}
+
+static unsigned long expect (const queue_stats_t* stats, count_t peak, uint32_t pushes, uint32_t pops, uint32_t drops, uint32_t underflows)
+{
+	return (stats->peak != peak) || (stats->pushes != pushes) || (stats->pops != pops) || (stats->drops != drops) || (stats->underflows != underflows);
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	queue_id_t id = queueInitStatic(items, TEST_SIZE, sizeof(uint16_t));
+	uint32_t histogram[QUEUE_STATS_BUCKETS] = { 0 }, samples = 0, max = 0;
+	uint16_t data = 0, buffer[TEST_SIZE + 2];
+	unsigned long errors = 0, before;
+	queue_stats_t stats;
+	data_t ptr;
+
+	errors += queueStatsGet(QUEUE_INVALID_ID, &stats) || queueStatsGet(id, NULL);
+
+	for (uint8_t i = 0; i < TEST_SIZE + 2; i++, data++)							// Fills up, two dropped
+		queuePush(id, &data);
+	errors += !queueStatsGet(id, &stats) || expect(&stats, TEST_SIZE, TEST_SIZE, 0, 2, 0);
+	for (uint8_t i = 0; i < TEST_SIZE + 3; i++)									// Empties, three underflows
+		queuePop(id);
+	queueStatsGet(id, &stats);
+	errors += expect(&stats, TEST_SIZE, TEST_SIZE, TEST_SIZE, 2, 3);
+
+	errors += queuePushN(id, buffer, TEST_SIZE + 2) != TEST_SIZE;				// Partial: the rest dropped
+	errors += queuePopN(id, buffer, TEST_SIZE + 2) != TEST_SIZE;				// Partial: not an underflow
+	errors += queuePopN(id, buffer, 1) != 0;									// Nothing: one
+	queueStatsGet(id, &stats);
+	errors += expect(&stats, TEST_SIZE, 2 * TEST_SIZE, 2 * TEST_SIZE, 4, 4);
+
+	errors += !queueReserve(id, 3, &ptr);										// Zero-copy side counts the same
+	queueCommit(id, 3);
+	errors += queueReserve(id, TEST_SIZE, &ptr);
+	errors += queueConsume(id, 1) != 1;
+	queueStatsGet(id, &stats);
+	errors += expect(&stats, TEST_SIZE, 2 * TEST_SIZE + 3, 2 * TEST_SIZE + 1, 4 + TEST_SIZE, 4);
+
+	queueStatsReset(id);														// Peak restarts from the 2 left
+	queueStatsGet(id, &stats);
+	errors += expect(&stats, 2, 0, 0, 0, 0);
+	queuePush(id, &data);
+	queueStatsGet(id, &stats);
+	errors += expect(&stats, 3, 1, 0, 0, 0);
+	queueClear(id);
+	printf("Counters: peak, pushes, pops, drops and underflows, errors: %lu\n", errors);
+	before = errors;
+
+	queueStatsReset(id);														// No clock: nothing sampled
+	queuePush(id, &data);
+	now += 100;
+	queuePop(id);
+	queueStatsGet(id, &stats);
+	for (uint8_t b = 0; b < QUEUE_STATS_BUCKETS; b++)
+		errors += stats.latency[b] != 0;
+
+	queueStatsClock(fakeClock);													// One element in flight each time
+	for (uint8_t i = 0; i < sizeof(latencies) / sizeof(latencies[0]); i++)
+	{
+		queuePush(id, &data);
+		now += latencies[i];
+		queuePop(id);
+		histogram[bucket(latencies[i])]++;
+		max = (latencies[i] > max) ? latencies[i] : max;
+		samples++;
+	}
+	queuePush(id, &data);														// Only the first one of these is timed
+	now += 10;
+	queuePush(id, &data);
+	now += 1000;
+	queuePop(id);
+	queuePop(id);
+	histogram[bucket(10 + 1000)]++;
+	samples++;
+	queueStatsGet(id, &stats);
+	for (uint8_t b = 0; b < QUEUE_STATS_BUCKETS; b++)
+	{
+		errors += stats.latency[b] != histogram[b];
+		samples -= stats.latency[b];
+	}
+	errors += samples || (stats.latency_max != max);
+	printf("Latency: %zu samples,", sizeof(latencies) / sizeof(latencies[0]) + 1);
+	for (uint8_t b = 0; b < QUEUE_STATS_BUCKETS; b++)
+		printf(" %u", stats.latency[b]);
+	printf(", max %u, errors: %lu\n", stats.latency_max, errors - before);
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,224 @@
+/***************************************************************************//**
+  @file     deadline_test.c
+  @brief    Deadline Queue Testbench: random deadlines on a simulated clock
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. deadline_test.c ../deadline.c
+            The clock jumps from deadline to deadline as a one-shot compare
+            would make it, every expiry is checked against its deadline and
+            the heap against its invariant.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "deadline.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_DEADLINES	(DEADLINE_MAX + 8)										// Some left out when full
+#define TEST_STEPS		200000UL
+#define TEST_LATENCY	40														// Counts from compare to the interrupt reading the clock
+#define TEST_BENCH		2000000UL
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef struct {																// Reference for each deadline
+	bool			queued;
+	uint64_t		when;
+	unsigned long	fired;
+} model_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static deadline_queue_t queue;
+static deadline_t deadlines[TEST_DEADLINES];
+static model_t model[TEST_DEADLINES];
+static uint64_t now, last;
+static unsigned long errors, fired, early, order, meddled, full;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static uint64_t delay (void)													// Mostly short, now and then seconds away
+{
+	switch (rand() % 8)
+	{
+		case 0:		return 0;
+		case 1:		return rand() % 100;
+		case 2:		return (uint64_t)rand() * 1000;
+		default:	return 1 + rand() % 50000;
+	}
+}
+
+static bool heap (void)															// Every parent no later than its children
+{
+	for (uint16_t i = 1; i < queue.count; i++)
+		if ((queue.heap[(i - 1) / 2]->when > queue.heap[i]->when) || (queue.heap[i]->slot != i + 1))
+			return false;
+
+	return !queue.count || (queue.heap[0]->slot == 1);
+}
+
+static void expired (void* arg);
+
+static void start (uint16_t i, uint64_t from)
+{
+	uint64_t when = from + delay();
+	bool queued = deadlineStart(&queue, &deadlines[i], when, expired, (void*)(size_t)i);
+	unsigned long running = 0;
+
+	for (uint16_t j = 0; j < TEST_DEADLINES; j++)
+		running += model[j].queued;
+	errors += queued != (model[i].queued || (running < DEADLINE_MAX));
+	full += !queued;
+	if (queued)
+	{
+		model[i].queued = true;
+		model[i].when = when;
+	}
+}
+
+static void cancel (uint16_t i)
+{
+	errors += deadlineCancel(&queue, &deadlines[i]) != model[i].queued;
+	model[i].queued = false;
+}
+
+static void expired (void* arg)
+{
+	uint16_t i = (uint16_t)(size_t)arg;
+
+	errors += !model[i].queued || deadlineQueued(&deadlines[i]);
+	early += model[i].when > now;
+	order += model[i].when < last;												// Earliest first, across calls too
+	last = model[i].when;
+	model[i].queued = false;
+	model[i].fired++;
+	fired++;
+
+	if (!(rand() % 8))															// Meddle: itself or another, maybe already due
+	{
+		uint16_t j = (rand() & 1) ? i : rand() % TEST_DEADLINES;
+
+		if (rand() % 4)
+			start(j, now - rand() % 100);
+		else
+			cancel(j);
+		if (model[j].queued && (model[j].when < last))							// Already due, runs next
+			last = model[j].when;
+		meddled++;
+	}
+}
+
+static void counter (void* arg)
+{
+	(*(unsigned long*)arg)++;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	unsigned long missed = 0, calls = 0, wakes = 0, expected = 0;
+	deadline_t once = { 0 }, bench[DEADLINE_MAX] = { 0 };
+	uint64_t next;
+	clock_t begin;
+	double spent;
+
+	srand(1);
+	now = 0xFFFFFFF0ULL;														// Past 32 bits soon
+	deadlineInit(&queue);
+	for (uint16_t i = 0; i < TEST_DEADLINES; i++)
+		start(i, now);
+
+	for (unsigned long step = 0; step < TEST_STEPS; step++)
+	{
+		next = deadlineNext(&queue);
+		if ((next != DEADLINE_NEVER) && (rand() % 4))							// Compare fires, read a bit later
+			now = (next > now ? next : now) + rand() % TEST_LATENCY;
+		else																	// Something else woke the core up first
+			now += rand() % 1000;
+		deadlineExpire(&queue, now);
+		wakes++;
+
+		errors += !heap();
+		for (uint16_t i = 0; i < TEST_DEADLINES; i++)
+		{
+			missed += model[i].queued && (model[i].when <= now);
+			errors += deadlineQueued(&deadlines[i]) != model[i].queued;
+		}
+		if (!(rand() % 2))
+		{
+			uint16_t i = rand() % TEST_DEADLINES;
+
+			if (rand() % 4)
+				start(i, now);
+			else
+				cancel(i);
+			errors += !heap();
+		}
+		if (queue.count && (deadlineNext(&queue) != queue.heap[0]->when))
+			errors++;
+		last = 0;
+	}
+	for (uint16_t i = 0; i < TEST_DEADLINES; i++)
+		expected += model[i].queued;
+	errors += missed || early || order || (queue.count != expected) || !full;
+	printf("Random: %lu wakes, %lu expirations, %lu starts or cancels from callbacks, %lu refused full, %lu early, %lu out of order, %lu missed, errors: %lu\n",
+		   wakes, fired, meddled, full, early, order, missed, errors);
+
+	deadlineInit(&queue);														// Past, now and later
+	errors += deadlineNext(&queue) != DEADLINE_NEVER;
+	deadlineStart(&queue, &once, 10, counter, &calls);
+	errors += (deadlineExpire(&queue, 9) != 0) || (deadlineNext(&queue) != 10) || (deadlineExpire(&queue, 10) != 1) || deadlineQueued(&once);
+	deadlineStart(&queue, &once, 50, counter, &calls);
+	deadlineStart(&queue, &once, 20, counter, &calls);							// Moved, not queued twice
+	errors += (queue.count != 1) || (deadlineNext(&queue) != 20);
+	errors += !deadlineCancel(&queue, &once) || deadlineCancel(&queue, &once) || deadlineExpire(&queue, 1000) || queue.count;
+	printf("One-shot: %lu calls, errors: %lu\n", calls, errors);
+
+	deadlineInit(&queue);														// Cost of a full queue, restarted as it expires
+	for (uint16_t i = 0; i < DEADLINE_MAX; i++)
+		deadlineStart(&queue, &bench[i], 1 + rand() % 100000, counter, &calls);
+	calls = 0;
+	now = 0;
+	begin = clock();
+	for (unsigned long n = 0; n < TEST_BENCH; n++)
+	{
+		deadline_t* head = queue.heap[0];
+
+		now = deadlineNext(&queue);
+		deadlineExpire(&queue, now);
+		deadlineStart(&queue, head, now + 1 + rand() % 100000, counter, &calls);
+	}
+	spent = (double)(clock() - begin) / CLOCKS_PER_SEC;
+	printf("Cost: %u deadlines queued, %lu expirations, %.1f ns per expiry and restart\n",
+		   DEADLINE_MAX, calls, 1e9 * spent / TEST_BENCH);
+	errors += calls < TEST_BENCH;
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,119 @@
+/***************************************************************************//**
+  @file     dmaring_test.c
+  @brief    DMA Ring Testbench: simulated circular DMA producer
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. dmaring_test.c ../dmaring.c
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dmaring.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_SIZE		64
+#define TEST_STEPS		1000000UL
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static uint8_t buffer[TEST_SIZE];
+static uint32_t laps;
+static uint16_t remaining = TEST_SIZE;											// Mirrors CITER, reloaded from BITER
+static uint32_t written;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void dmaRequest (void)													// One minor loop: one byte, as UART RX would
+{
+	buffer[TEST_SIZE - remaining] = (uint8_t)written++;
+	if (--remaining == 0)
+	{
+		remaining = TEST_SIZE;
+		laps++;																	// Major loop callback
+	}
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	dma_ring_t ring;
+	uint8_t data[TEST_SIZE];
+	uint32_t expected = 0, lost = 0, errors = 0;
+
+	dmaRingInit(&ring, buffer, TEST_SIZE);
+
+	srand(1);
+	for (unsigned long step = 0; step < TEST_STEPS; step++)
+	{
+		uint32_t n = rand() % (TEST_SIZE / 2), count, head;
+		uint8_t* ptr;
+
+		for (uint32_t i = rand() % (step & 0x3FF ? TEST_SIZE / 2 : 3 * TEST_SIZE); i; i--)
+			dmaRequest();															// Occasionally lap the reader
+
+		head = dmaRingHead(laps, TEST_SIZE, remaining);
+		if (head != written)
+			errors++;
+
+		if (head - expected > TEST_SIZE)										// Bytes the reader is bound to lose
+		{
+			lost += head - expected - TEST_SIZE;
+			expected = head - TEST_SIZE;
+		}
+
+		if (rand() & 1)
+		{
+			count = dmaRingRead(&ring, head, data, n);
+			for (uint32_t i = 0; i < count; i++)
+				errors += data[i] != (uint8_t)expected++;
+		}
+		else
+		{
+			count = dmaRingPeek(&ring, head, &ptr);
+			count = count < n ? count : n;
+			for (uint32_t i = 0; i < count; i++)
+				errors += ptr[i] != (uint8_t)expected++;
+			dmaRingConsume(&ring, count);
+		}
+
+		if (dmaRingAvailable(&ring, head) != head - expected)
+			errors++;
+
+		n = rand() % TEST_SIZE;													// Look ahead without consuming
+		count = dmaRingPeekAt(&ring, head, n, &ptr);
+		for (uint32_t i = 0; i < count; i++)
+			errors += ptr[i] != (uint8_t)(expected + n + i);
+		if ((n < head - expected) ? !count : count)
+			errors++;
+	}
+
+	if (ring.overruns != lost)
+		errors++;
+
+	printf("Steps: %lu, bytes: %u, overruns: %u, errors: %u\n", TEST_STEPS, written, ring.overruns, errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,280 @@
+/***************************************************************************//**
+  @file     fsm_test.c
+  @brief    FSM Testbench: table dispatch, event queue and benchmark
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. fsm_test.c ../fsm.c -lpthread
+            The table form is checked against the edge-list interpreter on
+            random machines, the queue against threads posting as ISRs.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fsm.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_EVENTS		1000000UL
+#define TEST_PRODUCERS	4														// Threads standing in for ISRs
+#define TEST_POSTS		200000UL												// Per thread
+#define TEST_BENCH		20000000UL
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef struct {																// As fsm_state_t, the next state by number
+	fsm_id_t	event;
+	fsm_id_t	next;
+	void		(* callback)(void);
+} edge_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static fsm_cell_t table[FSM_MAX_STATES * FSM_MAX_EVENTS];
+static edge_t edges[FSM_MAX_STATES][FSM_MAX_EVENTS + 1];
+static fsm_machine_t machine;
+
+static unsigned long actions, reference_actions;
+static fsm_id_t events[1024];
+static volatile unsigned long sink;
+
+static unsigned long posted[TEST_PRODUCERS], runs[TEST_PRODUCERS];
+static unsigned long failed[TEST_PRODUCERS];
+static fsm_id_t last[TEST_PRODUCERS];
+static unsigned long order_errors, depth, depth_max, chained;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static double seconds (clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Random machines /////////////////////////////////////////////////////////////
+
+static void action (void)
+{
+	actions++;
+}
+
+static void referenceAction (void)
+{
+	reference_actions++;
+}
+
+static void build (fsm_id_t states, fsm_id_t events, unsigned density)			// density: % of cells with a transition
+{
+	for (fsm_id_t s = 0; s < states; s++)
+	{
+		uint8_t n = 0;
+
+		for (fsm_id_t e = 0; e < events; e++)
+		{
+			bool used = (unsigned)(rand() % 100) < density;
+			fsm_id_t next = rand() % states;
+			bool cb = rand() & 1;
+
+			table[s * events + e] = used ? (fsm_cell_t)FSM_GOTO(next, cb ? action : NULL) : (fsm_cell_t){ 0, NULL };
+			if (used)
+				edges[s][n++] = (edge_t){ e, next, cb ? referenceAction : NULL };
+		}
+		for (uint8_t i = n; i > 1; i--)											// Edge order does not matter to the scan
+		{
+			uint8_t j = rand() % i;
+			edge_t aux = edges[s][i - 1];
+			edges[s][i - 1] = edges[s][j];
+			edges[s][j] = aux;
+		}
+		edges[s][n] = (edge_t){ FSM_TABLE_END, s, NULL };							// Otherwise stay
+	}
+}
+
+static fsm_id_t scan (fsm_id_t state, fsm_id_t event)							// The fsm() interpreter
+{
+	const edge_t* edge = edges[state];
+
+	while ((edge->event != event) && (edge->event != FSM_TABLE_END))
+		++edge;
+	if (edge->callback)
+		edge->callback();
+
+	return edge->next;
+}
+
+// Threads as ISRs /////////////////////////////////////////////////////////////
+
+#define PRODUCER_TASK(t, e)	static void run##t##e (void) { order_errors += last[t] != e; last[t] = !e; runs[t]++; }
+PRODUCER_TASK(0, 0) PRODUCER_TASK(0, 1) PRODUCER_TASK(1, 0) PRODUCER_TASK(1, 1)
+PRODUCER_TASK(2, 0) PRODUCER_TASK(2, 1) PRODUCER_TASK(3, 0) PRODUCER_TASK(3, 1)
+
+static void* producer (void* arg)												// Alternates its two events
+{
+	uint8_t t = (uint8_t)(size_t)arg;
+
+	for (unsigned long n = 0; n < TEST_POSTS; )
+	{
+		if (fsmPost(&machine, 2 * t + (n & 1)))
+			n++;
+		else
+		{
+			failed[t]++;															// Full: the same event again, later
+			sched_yield();
+		}
+	}
+	posted[t] = TEST_POSTS;
+
+	return NULL;
+}
+
+// Run to completion ///////////////////////////////////////////////////////////
+
+static void first (void)
+{
+	depth_max = ++depth > depth_max ? depth : depth_max;
+	fsmPost(&machine, 1);														// Runs after this one returns
+	depth--;
+}
+
+static void second (void)
+{
+	depth_max = ++depth > depth_max ? depth : depth_max;
+	chained++;
+	depth--;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	static const fsm_cell_t queue_table[1][2 * TEST_PRODUCERS] = {
+		{ FSM_GOTO(0, run00), FSM_GOTO(0, run01), FSM_GOTO(0, run10), FSM_GOTO(0, run11),
+		  FSM_GOTO(0, run20), FSM_GOTO(0, run21), FSM_GOTO(0, run30), FSM_GOTO(0, run31) } };
+	static const fsm_cell_t chain_table[2][2] = {
+		{ FSM_GOTO(1, first), { 0, NULL } },									// Event 1 ignored in state 0
+		{ FSM_GOTO(0, first), FSM_GOTO(0, second) } };
+	unsigned long errors = 0, entered[FSM_MAX_STATES] = { 0 }, ignored = 0, total = 0, dropped = 0;
+	pthread_t threads[TEST_PRODUCERS];
+	fsm_id_t state, reference;
+	clock_t start;
+	double scan_s, table_s;
+
+	srand(1);																	// Against the edge-list interpreter
+	for (uint8_t m = 0; m < 20; m++)
+	{
+		fsm_id_t states = 1 + rand() % FSM_MAX_STATES, nevents = 1 + rand() % FSM_MAX_EVENTS;
+
+		build(states, nevents, 10 + rand() % 90);
+		errors += !fsmTableInit(&machine, table, states, nevents, 0, NULL);
+		reference = 0;
+		for (fsm_id_t s = 0; s < FSM_MAX_STATES; s++)
+			entered[s] = !s;
+		ignored = 0;
+
+		for (unsigned long n = 0; n < TEST_EVENTS / 20; n++)
+		{
+			fsm_id_t event = rand() % (nevents + 1);							// One out of range
+			fsm_id_t next = (event < nevents) ? scan(reference, event) : reference;
+
+			ignored += (event >= nevents) || !table[reference * nevents + event].next;
+			entered[next] += (event < nevents) && table[reference * nevents + event].next;
+			reference = next;
+			state = fsmDispatch(&machine, event);
+			errors += (state != reference) || (fsmGetState(&machine) != state);
+		}
+
+		const fsm_stats_t* stats = fsmGetStats(&machine);
+		for (fsm_id_t s = 0; s < states; s++)
+			errors += stats->entered[s] != entered[s];
+		for (fsm_id_t e = 0; e < nevents; e++)
+			total += stats->events[e];
+		errors += stats->ignored != ignored;
+	}
+	errors += (actions != reference_actions) || (total > TEST_EVENTS);
+	errors += fsmTableInit(&machine, table, FSM_MAX_STATES + 1, 1, 0, NULL) || fsmTableInit(&machine, table, 2, 2, 2, NULL);
+	printf("Dispatch: %lu events on 20 machines, %lu actions, errors: %lu\n", TEST_EVENTS, actions, errors);
+
+	fsmTableInit(&machine, &chain_table[0][0], 2, 2, 0, NULL);				// Run to completion
+	fsmPost(&machine, 1);
+	errors += (fsmRun(&machine) != 1) || (fsmGetState(&machine) != 0) || (fsmGetStats(&machine)->ignored != 1);
+	for (uint8_t i = 1; i <= 3; i++)											// first() posts, second() runs once it returns
+	{
+		fsmPost(&machine, 0);
+		errors += (fsmRun(&machine) != 2) || (chained != i) || (depth_max != 1) || (fsmGetState(&machine) != 0);
+	}
+	printf("Run to completion: %lu chained, depth %lu, errors: %lu\n", chained, depth_max, errors);
+
+	fsmTableInit(&machine, &queue_table[0][0], 1, 2 * TEST_PRODUCERS, 0, NULL);	// Threads as ISRs
+	for (uint8_t t = 0; t < TEST_PRODUCERS; t++)
+		pthread_create(&threads[t], NULL, producer, (void*)(size_t)t);
+	for (unsigned long idle = 0; idle < 1000; )
+	{
+		bool finished = true;
+
+		for (uint8_t t = 0; t < TEST_PRODUCERS; t++)
+			finished &= __atomic_load_n(&posted[t], __ATOMIC_ACQUIRE) != 0;
+		if (fsmRun(&machine))
+			idle = 0;
+		else
+		{
+			idle = finished ? idle + 1 : 0;
+			sched_yield();															// Nothing posted, let the ISRs run
+		}
+	}
+	for (uint8_t t = 0; t < TEST_PRODUCERS; t++)
+	{
+		pthread_join(threads[t], NULL);
+		errors += runs[t] != TEST_POSTS;
+		dropped += failed[t];
+	}
+	errors += order_errors || (fsmGetStats(&machine)->dropped != dropped);
+	printf("Queue: %lu events from %u threads, %lu posts dropped on a full queue, errors: %lu\n",
+		   TEST_PRODUCERS * TEST_POSTS, TEST_PRODUCERS, dropped, errors);
+
+	build(FSM_MAX_STATES, FSM_MAX_EVENTS, 50);									// Benchmark, 8 edges per state on average
+	fsmTableInit(&machine, table, FSM_MAX_STATES, FSM_MAX_EVENTS, 0, NULL);
+	for (uint16_t i = 0; i < sizeof(events); i++)
+		events[i] = rand() % FSM_MAX_EVENTS;
+
+	start = clock();
+	reference = 0;
+	for (unsigned long n = 0; n < TEST_BENCH; n++)
+		reference = scan(reference, events[n % sizeof(events)]);
+	sink += reference;
+	scan_s = seconds(start);
+
+	start = clock();
+	for (unsigned long n = 0; n < TEST_BENCH; n++)
+		fsmDispatch(&machine, events[n % sizeof(events)]);
+	sink += fsmGetState(&machine);
+	table_s = seconds(start);
+
+	printf("Dispatch (16 states x 16 events): edge list %.1f ns, table %.1f ns\n", 1e9 * scan_s / TEST_BENCH, 1e9 * table_s / TEST_BENCH);
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
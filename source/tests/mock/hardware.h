@@ -0,0 +1,73 @@
+/***************************************************************************//**
+  @file     hardware.h
+  @brief    Host mock of SDK/startup/hardware.h: peripherals live in RAM
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Put this directory first in the include path, and define the
+            mock register files (mockUART, mockPORT, mockSIM, mockSysTick)
+            the code under test uses in the test
+ ******************************************************************************/
+
+#ifndef _HARDWARE_H_
+#define _HARDWARE_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "fsl_device_registers.h"
+#include "core_cm4.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define __CORE_CLOCK__		100000000U
+#define __FOREVER__			for(;;)
+#define __ISR__				void												// Plain functions, tests call them
+
+/* Register files */
+#undef	SIM
+#define SIM					(&mockSIM)
+#undef	PORT_BASE_PTRS
+#define PORT_BASE_PTRS		{ &mockPORT[0], &mockPORT[1], &mockPORT[2], &mockPORT[3], &mockPORT[4] }
+#undef	UART_BASE_PTRS
+#define UART_BASE_PTRS		{ &mockUART[0], &mockUART[1], &mockUART[2], &mockUART[3], &mockUART[4], &mockUART[5] }
+
+/* Core (no NVIC nor PRIMASK on the host) */
+#undef	SysTick
+#define SysTick				(&mockSysTick)
+#undef	NVIC_EnableIRQ
+#define NVIC_EnableIRQ(irq)		((void)(irq))
+#undef	NVIC_DisableIRQ
+#define NVIC_DisableIRQ(irq)	((void)(irq))
+#define __get_PRIMASK()			0U
+#define __set_PRIMASK(mask)		((void)(mask))
+#define __disable_irq()			((void)0)
+#define __enable_irq()			((void)0)
+
+/*******************************************************************************
+ * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+extern SIM_Type mockSIM;
+extern PORT_Type mockPORT[5];
+extern UART_Type mockUART[6];
+extern SysTick_Type mockSysTick;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+static inline void hw_EnableInterrupts (void) {}
+static inline void hw_DisableInterrupts (void) {}
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _HARDWARE_H_
@@ -0,0 +1,282 @@
+/***************************************************************************//**
+  @file     modem_test.c
+  @brief    Modem Testbench: half-duplex exchanges with a simulated far end
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. modem_test.c ../modem.c ../fsm.c ../spsc.c -lm
+            Received bytes are checked against what the far end sent, sent
+            bytes against a reference tone correlator, and turnaround times
+            are measured in samples from one side going quiet to the other
+            one starting.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "modem.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_UPDATE		4														// Samples between main loop passes
+#define TEST_LIMIT		200000UL												// Samples to wait for anything
+#define TEST_AMPLITUDE	700.0													// Far end tone, LSB
+#define TEST_ECHO		0.5														// Own output back on the input
+#define TEST_NOISE		60
+#define TEST_PI			3.14159265358979
+
+#define SPB				(MODEM_SAMPLE_HZ / MODEM_BAUD)							// Samples per bit
+#define MS(x)			(1000.0 * (x) / MODEM_SAMPLE_HZ)
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const modem_cfg_t config = { 20, 10, 5, 150, 75, 1000 };				// Preamble, turnaround, qualify (ms), carrier on, off, amplitude
+
+static struct {																	// Far end transmitter
+	const uchar_t*	data;
+	uint16_t		len;
+	unsigned long	start, end;													// Samples
+	unsigned long	preamble;													// Bits
+	double			phase;
+	bool			active;
+} remote;
+
+static unsigned long n, errors;
+static uint16_t out = MODEM_DAC_IDLE;
+static uint16_t sent[TEST_LIMIT];												// Own output while the modulator runs
+static unsigned long tx_count, tx_first, tx_last, rx_last, overlap;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+// Line ////////////////////////////////////////////////////////////////////////
+
+static int32_t noise (unsigned long i, int32_t amplitude)
+{
+	uint32_t hash = (uint32_t)i * 2654435761U;
+
+	return (int32_t)((hash >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+static uint16_t clip (double x)
+{
+	return (uint16_t)(x < 0 ? 0 : x > 4095 ? 4095 : x);
+}
+
+static void talk (const uchar_t* data, uint16_t len, uint16_t preamble_ms, unsigned long delay)
+{
+	remote = (typeof(remote)){ data, len, n + delay, 0, preamble_ms * MODEM_BAUD / 1000, 0, true };
+}
+
+static double far (void)														// Preamble, then 8N1 bytes, phase continuous
+{
+	unsigned long bit, b;
+	bool value;
+
+	if (!remote.active || (n < remote.start))
+		return 0;
+
+	bit = (n - remote.start) / SPB;
+	if (bit < remote.preamble)
+		value = true;
+	else if ((b = bit - remote.preamble) / 10 < remote.len)
+		value = (b % 10 == 0) ? false : (b % 10 == 9) ? true : (remote.data[b / 10] >> (b % 10 - 1)) & 1;
+	else
+	{
+		remote.active = false;
+		remote.end = n;
+		return 0;
+	}
+	remote.phase += 2 * TEST_PI * (value ? MODEM_MARK_HZ : MODEM_SPACE_HZ) / MODEM_SAMPLE_HZ;
+
+	return TEST_AMPLITUDE * sin(remote.phase);
+}
+
+static void tick (void)															// One ADC and DAC sample, now and then a main loop pass
+{
+	double line = 2048 + 200 * sin(n * 0.0003) + far() + TEST_ECHO * (out - 2048.0) + noise(n, TEST_NOISE);
+	modem_stats_t before = modemGetStats(), after;
+	bool rx, tx;
+
+	modemSample(clip(line));
+	out = modemOutput();
+	after = modemGetStats();
+
+	rx = after.rx_samples != before.rx_samples;
+	tx = after.tx_samples != before.tx_samples;
+	overlap += rx && tx;															// Never both
+	errors += !tx && (out != MODEM_DAC_IDLE);
+	if (tx)
+	{
+		if (!tx_count)
+			tx_first = n;
+		sent[tx_count++] = out;
+		tx_last = n;
+	}
+	if (rx)
+		rx_last = n;
+
+	n++;
+	if (!(n % TEST_UPDATE))
+		modemUpdate();
+}
+
+// Reference demodulator ///////////////////////////////////////////////////////
+
+static double energy (const uint16_t* x, double f)								// One bit against a tone
+{
+	double i = 0, q = 0;
+
+	for (uint8_t k = 0; k < SPB; k++)
+	{
+		i += (x[k] - 2048.0) * cos(2 * TEST_PI * f * k / MODEM_SAMPLE_HZ);
+		q += (x[k] - 2048.0) * sin(2 * TEST_PI * f * k / MODEM_SAMPLE_HZ);
+	}
+
+	return i * i + q * q;
+}
+
+static uint16_t reference (const uint16_t* x, unsigned long count, uchar_t* data, unsigned long* framing)	// Bits aligned to the first sample
+{
+	uint16_t len = 0;
+
+	for (unsigned long b = 0; b + 10 <= count / SPB; b++)
+	{
+		if (energy(&x[b * SPB], MODEM_MARK_HZ) > energy(&x[b * SPB], MODEM_SPACE_HZ))
+			continue;																// Mark, hunting a start bit
+
+		uchar_t byte = 0;
+		for (uint8_t i = 1; i <= 8; i++)
+			byte |= (energy(&x[(b + i) * SPB], MODEM_MARK_HZ) > energy(&x[(b + i) * SPB], MODEM_SPACE_HZ)) << (i - 1);
+		*framing += energy(&x[(b + 9) * SPB], MODEM_MARK_HZ) < energy(&x[(b + 9) * SPB], MODEM_SPACE_HZ);
+		data[len++] = byte;
+		b += 9;
+	}
+
+	return len;
+}
+
+// Checks //////////////////////////////////////////////////////////////////////
+
+static unsigned long check (const uchar_t* data, uint16_t len)					// Everything the far end sent, in order
+{
+	uchar_t got[MODEM_RX_SIZE];
+	uint16_t count = modemRead(got, sizeof(got));
+	unsigned long bad = count != len;
+
+	for (uint16_t i = 0; (i < count) && (i < len); i++)
+		bad += got[i] != data[i];
+
+	return bad;
+}
+
+static unsigned long checkSent (const uchar_t* data, uint16_t len)				// Everything we sent, through the reference
+{
+	uchar_t got[MODEM_TX_SIZE];
+	unsigned long framing = 0;
+	uint16_t count = reference(sent, tx_count, got, &framing);
+	unsigned long bad = (count != len) + framing;
+
+	for (uint16_t i = 0; (i < count) && (i < len); i++)
+		bad += got[i] != data[i];
+
+	return bad;
+}
+
+static bool wait (modem_state_t state)
+{
+	unsigned long start = n;
+
+	while ((modemGetState() != state) && (n - start < TEST_LIMIT))
+		tick();
+
+	return modemGetState() == state;
+}
+
+static void fill (uchar_t* data, uint16_t len)
+{
+	for (uint16_t i = 0; i < len; i++)
+		data[i] = rand();
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	uchar_t question[64], answer[48], late[32], alone[16];
+	unsigned long before, rx_to_tx, tx_to_rx, idle_to_tx, to_rx;
+	modem_stats_t stats;
+
+	srand(1);
+	fill(question, sizeof(question));
+	fill(answer, sizeof(answer));
+	fill(late, sizeof(late));
+	fill(alone, sizeof(alone));
+
+	errors += modemInit(&(modem_cfg_t){ 20, 10, 5, 75, 150, 1000 }, NULL) || modemInit(&(modem_cfg_t){ 20, 10, 5, 150, 75, 4000 }, NULL);
+	errors += !modemInit(&config, NULL);
+	for (unsigned i = 0; i < 5000; i++)											// Quiet line, no carrier
+		tick();
+	errors += (modemGetState() != MODEM_IDLE) || modemGetStats().tx_samples;
+
+	before = errors;															// Answer while the far end talks, after it stops
+	talk(question, sizeof(question), 30, 0);
+	while ((modemGetStats().rx_bytes < sizeof(question) / 2) && (n < TEST_LIMIT))
+		tick();
+	errors += (modemGetState() != MODEM_RECEIVE) || (modemWrite(answer, sizeof(answer)) != sizeof(answer));
+	errors += !wait(MODEM_PREAMBLE) || remote.active || tx_count;
+	errors += !wait(MODEM_IDLE);
+	rx_to_tx = tx_first - remote.end;
+	while (rx_last <= tx_last)
+		tick();
+	tx_to_rx = rx_last - tx_last;
+	errors += check(question, sizeof(question)) + checkSent(answer, sizeof(answer));
+	printf("Receive, answer: %2zu bytes in, %2zu out, RX->TX %5.2f ms, TX->RX %5.2f ms, errors: %lu\n",
+		   sizeof(question), sizeof(answer), MS(rx_to_tx), MS(tx_to_rx), errors - before);
+	errors += (MS(rx_to_tx) < config.turnaround_ms) || (MS(tx_to_rx) < config.turnaround_ms);
+
+	before = errors;															// The far end answers as soon as we stop
+	tx_count = 0;
+	errors += modemWrite(alone, sizeof(alone)) != sizeof(alone);
+	idle_to_tx = n;
+	errors += !wait(MODEM_TURNAROUND);
+	idle_to_tx = tx_first - idle_to_tx;
+	talk(late, sizeof(late), 30, 2 * SPB);										// Still in our echo guard
+	stats = modemGetStats();
+	errors += !wait(MODEM_RECEIVE) || (modemGetStats().tx_samples != stats.tx_samples);
+	to_rx = n - remote.start;
+	while (remote.active && (n < 2 * TEST_LIMIT))
+		tick();
+	errors += !wait(MODEM_IDLE);
+	errors += check(late, sizeof(late)) + checkSent(alone, sizeof(alone));
+	printf("Send, receive:  %2zu bytes out, %2zu in, idle->TX %5.2f ms, far end in the guard->RX %5.2f ms, errors: %lu\n",
+		   sizeof(alone), sizeof(late), MS(idle_to_tx), MS(to_rx), errors - before);
+
+	stats = modemGetStats();
+	errors += overlap || stats.framing || stats.overruns;
+	errors += (stats.rx_bytes != sizeof(question) + sizeof(late)) || (stats.tx_bytes != sizeof(answer) + sizeof(alone)) || (stats.turnarounds != 4);
+	printf("DSP: %lu receive, %lu transmit samples of %lu, both at once: %lu\n",
+		   (unsigned long)stats.rx_samples, (unsigned long)stats.tx_samples, n, overlap);
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
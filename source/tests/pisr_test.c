@@ -0,0 +1,186 @@
+/***************************************************************************//**
+  @file     pisr_test.c
+  @brief    PISR Testbench: callback rates, jitter and cost over a mocked SysTick
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -DCPU_MK64FN1M0VLL12 -DPISR_ACCOUNTING=1 -Imock -I.. -I../../SDK/startup -I../../SDK/CMSIS
+                        pisr_test.c ../pisr.c
+            Every callback's count is checked against its rate times the
+            ticks run, and every interval against the two whole numbers of
+            ticks its period falls between. Callbacks burn a known number
+            of SysTick counts, which the accounting has to give back.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+
+#include "hardware.h"
+#include "pisr.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_SECONDS	60
+#define TEST_TICKS		(TEST_SECONDS * PISR_FREQUENCY_HZ)
+#define TEST_LOAD		((__CORE_CLOCK__ / PISR_FREQUENCY_HZ) - 1U)
+#define TEST_BENCH		10000000UL
+
+#define CALLBACK(n)		static void callback##n (void) { called(n); }
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef struct {																// Reference for each callback
+	uint32_t		hz;															// 0 for whole periods
+	uint32_t		period;														// Ticks
+	uint32_t		cost;														// SysTick counts it burns
+	unsigned long	calls;
+	unsigned long	last;														// Tick of the last call
+	unsigned long	jitter;														// Intervals out of bounds
+} model_t;
+
+/*******************************************************************************
+ * GLOBAL VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+SysTick_Type mockSysTick;
+
+void SysTick_Handler (void);
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static model_t model[PISR_CANT] = {
+	{ .hz = 1500, .period = 0, .cost = 300   },									// UART: used to run at 2000
+	{ .hz = 1000, .period = 0, .cost = 20    },
+	{ .hz =  700, .period = 0, .cost = 1     },
+	{ .hz =    3, .period = 0, .cost = 5000  },
+	{ .hz = 2000, .period = 0, .cost = 10    },
+	{ .hz = 1999, .period = 0, .cost = 0     },
+	{ .hz =    1, .period = 0, .cost = 48000 },									// After the rest: SysTick reloads meanwhile
+	{ .hz =    0, .period = 4, .cost = 40    },
+};
+static unsigned long tick, errors, selfish, spawned;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void called (uint8_t i)
+{
+	double period = model[i].hz ? (double)PISR_FREQUENCY_HZ / model[i].hz : model[i].period;
+	unsigned long interval = tick - model[i].last;
+
+	if (model[i].calls && ((interval < (unsigned long)period) || (interval > (unsigned long)period + (period != (unsigned long)period))))
+		model[i].jitter++;														// Floor or ceiling of the period, nothing else
+	model[i].calls++;
+	model[i].last = tick;
+
+	if (mockSysTick.VAL >= model[i].cost)
+		mockSysTick.VAL -= model[i].cost;
+	else
+		mockSysTick.VAL += TEST_LOAD + 1 - model[i].cost;
+}
+
+CALLBACK(0) CALLBACK(1) CALLBACK(2) CALLBACK(3) CALLBACK(4) CALLBACK(5) CALLBACK(6) CALLBACK(7)
+
+static const pisr_callback_t callbacks[PISR_CANT] = { callback0, callback1, callback2, callback3,
+													  callback4, callback5, callback6, callback7 };
+
+static void spawn (void)														// Registers the next one, once
+{
+	spawned++;
+	errors += !pisrUnregister(spawn) || !pisrRegisterHz(callbacks[7], 500);
+}
+
+static void quitter (void)														// Unregisters itself
+{
+	if (++selfish == 10)
+		errors += !pisrUnregister(quitter) || pisrUnregister(quitter);
+}
+
+static void run (unsigned long ticks)
+{
+	for (unsigned long t = 0; t < ticks; t++)
+	{
+		tick++;
+		mockSysTick.VAL = TEST_LOAD;											// Reloaded as it interrupts
+		SysTick_Handler();
+	}
+}
+
+static void nothing (void)
+{
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	unsigned long start, expected, before = 0;
+	pisr_stats_t stats;
+	clock_t begin;
+	double spent;
+
+	errors += pisrRegisterHz(nothing, 0) || pisrRegisterHz(nothing, PISR_FREQUENCY_HZ + 1) || pisrRegister(nothing, 0) || pisrRegister(NULL, 1);
+	for (uint8_t i = 0; i < PISR_CANT; i++)
+		errors += !(model[i].hz ? pisrRegisterHz(callbacks[i], model[i].hz) : pisrRegister(callbacks[i], model[i].period));
+	errors += pisrRegisterHz(nothing, 10) || !(mockSysTick.CTRL & SysTick_CTRL_ENABLE_Msk) || (mockSysTick.LOAD != TEST_LOAD);
+
+	run(TEST_TICKS);
+	for (uint8_t i = 0; i < PISR_CANT; i++)
+	{
+		expected = model[i].hz ? (unsigned long)((uint64_t)TEST_TICKS * model[i].hz / PISR_FREQUENCY_HZ) : TEST_TICKS / model[i].period;
+		errors += (model[i].calls + 1 < expected) || (model[i].calls > expected + 1) || model[i].jitter;
+		errors += !pisrGetStats(callbacks[i], &stats);
+		errors += (stats.calls != model[i].calls) || (stats.last != model[i].cost) || (stats.max != model[i].cost) || (stats.total != (uint64_t)model[i].cost * model[i].calls);
+		printf("Rate: %4u/%u Hz, %7lu calls in %d s, %7lu expected, %lu intervals off, %5u cycles each, errors: %lu\n",
+			   model[i].hz ? model[i].hz : PISR_FREQUENCY_HZ, model[i].hz ? 1 : model[i].period,
+			   model[i].calls, TEST_SECONDS, expected, model[i].jitter, stats.last, errors - before);
+		before = errors;
+	}
+
+	start = model[2].calls;														// Unregister from the main loop, from a callback, and register from one
+	errors += !pisrUnregister(callbacks[2]) || pisrUnregister(callbacks[2]) || pisrGetStats(callbacks[2], &stats);
+	errors += !pisrUnregister(callbacks[7]) || !pisrRegisterHz(quitter, 1000) || !pisrRegister(spawn, 100);
+	model[7].calls = 0;
+	model[7].hz = 500;
+	run(PISR_FREQUENCY_HZ);
+	errors += (model[2].calls != start) || (selfish != 10) || (spawned != 1) || (model[7].calls + 1 < 475) || (model[7].calls > 476) || model[7].jitter;
+	errors += !pisrRegister(nothing, 1) || pisrRegister(nothing, 1);			// The quitter's spot back, the spawner's taken again
+	printf("Unregister: %lu calls after, %lu of 10 before quitting, %lu spawned, %lu calls spawned, errors: %lu\n",
+		   model[2].calls - start, selfish, spawned, model[7].calls, errors);
+
+	for (uint8_t i = 0; i < PISR_CANT; i++)										// Cost per tick, every callback almost never due
+	{
+		pisrUnregister(callbacks[i]);
+		pisrUnregister(nothing);
+	}
+	for (uint8_t i = 0; i < PISR_CANT; i++)
+		errors += !pisrRegisterHz(callbacks[i], 1);
+	begin = clock();
+	for (unsigned long t = 0; t < TEST_BENCH; t++)
+		SysTick_Handler();
+	spent = (double)(clock() - begin) / CLOCKS_PER_SEC;
+	printf("Cost: %u callbacks at 1 Hz, %.1f ns per tick\n", PISR_CANT, 1e9 * spent / TEST_BENCH);
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,135 @@
+/***************************************************************************//**
+  @file     prof_test.c
+  @brief    Profiling Testbench: zone statistics, histogram buckets and dumps
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -DPROF_ZONES=1 -I.. prof_test.c ../prof.c -lpthread
+            Known durations are recorded and read back, then threads record
+            at once as ISRs would, and dumps are cut to whole lines.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "prof.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_THREADS	4
+#define TEST_RECORDS	1000000UL												// Per thread
+#define TEST_SLEEP_NS	1000000L
+#define TEST_JITTER		100														// What an empty zone may still measure on the host
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const struct {
+	uint32_t	elapsed;
+	uint8_t		bucket;
+} known[] = { { 0, 0 }, { 1, 1 }, { 2, 2 }, { 3, 2 }, { 4, 3 }, { 1000, 10 }, { 16383, 14 }, { 16384, 15 }, { 1UL << 30, 15 } };
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void* recorder (void* arg)
+{
+	for (unsigned long i = 0; i < TEST_RECORDS; i++)
+		profRecord(PROF_SPSC_PUSH, (uint32_t)(size_t)arg);
+
+	return NULL;
+}
+
+static unsigned long lines (const char* text)
+{
+	unsigned long count = 0;
+
+	for (; *text; text++)
+		count += *text == '\n';
+
+	return count;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	pthread_t threads[TEST_THREADS];
+	prof_stats_t stats, empty;
+	unsigned long errors = 0, expected = 0, full, cut;
+	uint64_t total = 0;
+	char text[1024], small[120], tiny[10];
+	size_t len;
+
+	for (uint8_t i = 0; i < sizeof(known) / sizeof(known[0]); i++)				// No profInit yet: nothing subtracted, for known values
+	{
+		profRecord(PROF_FSK_DEMOD, known[i].elapsed);
+		total += known[i].elapsed;
+		errors += !profGet(PROF_FSK_DEMOD, &stats) || (stats.histogram[known[i].bucket] == 0);
+	}
+	for (uint8_t i = 0; i < sizeof(known) / sizeof(known[0]); i++)
+		expected += known[i].bucket == 3;
+	errors += (stats.count != sizeof(known) / sizeof(known[0])) || stats.min || (stats.max != 1UL << 30) || (stats.total != total);
+	errors += (stats.histogram[2] != 2) || (stats.histogram[15] != 2) || (stats.histogram[3] != expected);
+	errors += profGet(PROF_CANT, &stats);
+	printf("Known: %lu runs, min %lu, mean %lu, max %lu, errors: %lu\n", (unsigned long)stats.count,
+		   (unsigned long)stats.min, (unsigned long)(stats.total / stats.count), (unsigned long)stats.max, errors);
+
+	for (size_t t = 0; t < TEST_THREADS; t++)									// Nested ISRs hitting the same zone
+		pthread_create(&threads[t], NULL, recorder, (void*)(t + 1));
+	for (size_t t = 0; t < TEST_THREADS; t++)
+		pthread_join(threads[t], NULL);
+	profGet(PROF_SPSC_PUSH, &stats);
+	errors += (stats.count != TEST_THREADS * TEST_RECORDS) || (stats.total != TEST_RECORDS * TEST_THREADS * (TEST_THREADS + 1) / 2);
+	errors += (stats.min != 1) || (stats.max != TEST_THREADS) || (stats.histogram[1] != TEST_RECORDS) || (stats.histogram[2] != 2 * TEST_RECORDS);
+	printf("Threads: %d x %lu runs, %lu counted, errors: %lu\n", TEST_THREADS, TEST_RECORDS, (unsigned long)stats.count, errors);
+
+	profInit();																	// Empty zones measure nothing, a sleep what it slept
+	for (uint8_t i = 0; i < 100; i++)
+	{
+		PROF_BEGIN(PROF_FSK_MOD);
+		PROF_END(PROF_FSK_MOD);
+	}
+	{
+		PROF_BEGIN(PROF_MODEM_TX);
+		nanosleep(&(struct timespec){ 0, TEST_SLEEP_NS }, NULL);
+		PROF_END(PROF_MODEM_TX);
+	}
+	errors += !profGet(PROF_FSK_MOD, &empty) || !profGet(PROF_MODEM_TX, &stats);
+	errors += (empty.count != 100) || (empty.min > TEST_JITTER) || (stats.count != 1) || (stats.min < TEST_SLEEP_NS);
+	printf("Zones: empty min %lu mean %lu %s, %ld %s sleep measured %lu, errors: %lu\n", (unsigned long)empty.min,
+		   (unsigned long)(empty.total / empty.count), PROF_UNIT, TEST_SLEEP_NS, PROF_UNIT, (unsigned long)stats.min, errors);
+
+	len = profDump(text, sizeof(text));											// Header and the zones run since profInit, whole lines
+	full = lines(text);
+	errors += (len != strlen(text)) || (full != 1 + 2) || !strstr(text, "modem_tx ") || strstr(text, "fsk_demod ");
+	len = profDump(small, sizeof(small));
+	cut = lines(small);
+	errors += (len != strlen(small)) || !cut || (cut >= full) || (small[len - 1] != '\n');
+	errors += profDump(tiny, sizeof(tiny)) || tiny[0];
+	profReset();
+	errors += (profDump(text, sizeof(text)) == 0) || (lines(text) != 1);
+	printf("Dump: %lu lines, %lu in %zu bytes, errors: %lu\n%s", full, cut, sizeof(small), errors, small);
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
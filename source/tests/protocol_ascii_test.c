@@ -0,0 +1,204 @@
+/***************************************************************************//**
+  @file     protocol_ascii_test.c
+  @brief    Protocol Testbench: ASCII conversions, every int32_t and malformed input
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. protocol_ascii_test.c ../protocol.c
+            Walks all 2^32 values, a couple of minutes on a desktop.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "macros.h"
+#include "protocol.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_SAMPLE		997														// Checked against snprintf, 1 in TEST_SAMPLE
+#define TEST_MALFORMED	10000000UL
+#define TEST_BENCH		10000000UL
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const char* const cases[] = { "R", "R+", "R-", "R0", "R+0", "R-0", "R007", "R2147483647", "R+2147483647", "R-2147483648",
+									 "R2147483648", "R-2147483649", "R4294967295", "R4294967296", "R9999999999", "R00000000001",
+									 "R1 2", "R+-1", "R--1", "R1-", "R/", "R:" };
+static const int32_t results[] = { 0, 0, 0, 0, 0, 0, 7, INT32_MAX, INT32_MAX, INT32_MIN,
+								   -1, -1, -1, -1, -1, -1,
+								   -1, -1, -1, -1, -1, -1 };						// -1: malformed
+static const bool valid[] = { false, false, false, true, true, true, true, true, true, true,
+							  false, false, false, false, false, false,
+							  false, false, false, false, false, false };
+
+static int32_t values[1024];
+static volatile unsigned long sink;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static uint8_t perDigitPack (int32_t val, uchar_t* msg)							// The previous conversion, widened
+{
+	uint32_t num = val < 0 ? 0U - (uint32_t)val : (uint32_t)val, aux = num;
+	uint8_t len = 0, index = 1;
+
+	msg[0] = 'R';
+	if (val < 0)
+		msg[index++] = '-';
+	do { aux /= 10; } while (++len < MAX_DIGS && aux);
+	for (uint8_t i = 0; i < len; i++)
+	{
+		msg[index + len - 1 - i] = NUM2ASCII(num % 10);
+		num /= 10;
+	}
+
+	return index + len;
+}
+
+static int32_t perDigitUnpack (const uchar_t* msg, uint8_t len)
+{
+	uint8_t index = (msg[1] == '+' || msg[1] == '-') ? 2 : 1;
+	uint32_t num = 0;
+
+	for (uint8_t i = index; i < len; i++)
+		num = num * 10 + ASCII2NUM(msg[i]);
+
+	return (int32_t)(msg[1] == '-' ? 0U - num : num);
+}
+
+static bool reference (const char* msg, uint8_t len, int32_t* val)				// strtol, plus what it lets through
+{
+	char text[32], * end;
+	long num;
+
+	if ((len < 2) || (len > sizeof(text) - 1))
+		return false;
+	for (uint8_t i = (msg[1] == '+' || msg[1] == '-') ? 2 : 1; i < len; i++)
+		if ((msg[i] < '0') || (msg[i] > '9'))
+			return false;
+	if ((len - ((msg[1] == '+' || msg[1] == '-') ? 2 : 1) > MAX_DIGS) || (len == 2 && (msg[1] == '+' || msg[1] == '-')))
+		return false;
+
+	memcpy(text, msg + 1, len - 1);
+	text[len - 1] = 0;
+	errno = 0;
+	num = strtol(text, &end, 10);
+	if (errno || (*end) || (num < INT32_MIN) || (num > INT32_MAX))
+		return false;
+	*val = (int32_t)num;
+
+	return true;
+}
+
+static double seconds (clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	unsigned long errors = 0, rejected = 0;
+	uchar_t msg[PROTOCOL_DIGS + 2];
+	char text[PROTOCOL_DIGS + 2];
+	protocol_t data = { 'R', 0 }, * out;
+	uint8_t len, last = 1;
+	clock_t start;
+	double table_s, digit_s, stdio_s;
+	int32_t val;
+
+	uint32_t u = 0;																// Every int32_t, both ways
+	do {
+		data.val = (protocol_val_t)u;
+		len = protocolPack(&data, msg);
+		out = protocolUnpack(msg, len);
+		errors += (out->id != 'R') || (out->val != data.val);
+		if (!(u % TEST_SAMPLE) || (u <= 100000) || (u >= 0xFFFE7960) || (len != last))	// Small, digit count changes
+		{
+			errors += len != snprintf(text, sizeof(text), "R%ld", (long)data.val);
+			errors += memcmp(msg, text, len) != 0;
+		}
+		last = len;
+	} while (++u);
+
+	for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)				// Edges
+	{
+		out = protocolUnpack((uchar_t*)cases[i], strlen(cases[i]));
+		errors += (out->id != 0) == !valid[i];
+		errors += valid[i] && (out->val != results[i]);
+	}
+
+	srand(1);
+	for (unsigned long n = 0; n < TEST_MALFORMED; n++)							// Mostly digits, some junk
+	{
+		len = 1 + rand() % (PROTOCOL_DIGS + 1);
+		msg[0] = 'R';
+		for (uint8_t i = 1; i < len; i++)
+			msg[i] = (rand() % 16) ? NUM2ASCII(rand() % 10) : (uchar_t)rand();
+		if ((len > 1) && !(rand() % 3))
+			msg[1] = (rand() & 1) ? '+' : '-';
+
+		bool ok = reference((const char*)msg, len, &val);
+		out = protocolUnpack(msg, len);
+		errors += (out->id != 0) != ok;
+		errors += ok && (out->val != val);
+		rejected += !ok;
+	}
+
+	for (uint16_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)			// Every length, both signs
+		values[i] = (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand()) >> (rand() % 32);
+
+	start = clock();
+	for (unsigned long n = 0; n < TEST_BENCH; n++)
+	{
+		data.val = values[n % (sizeof(values) / sizeof(values[0]))];
+		len = protocolPack(&data, msg);
+		sink += protocolUnpack(msg, len)->val;
+	}
+	table_s = seconds(start);
+
+	start = clock();
+	for (unsigned long n = 0; n < TEST_BENCH; n++)
+	{
+		len = perDigitPack(values[n % (sizeof(values) / sizeof(values[0]))], msg);
+		sink += perDigitUnpack(msg, len);
+	}
+	digit_s = seconds(start);
+
+	start = clock();
+	for (unsigned long n = 0; n < TEST_BENCH; n++)
+	{
+		len = snprintf(text, sizeof(text), "R%ld", (long)values[n % (sizeof(values) / sizeof(values[0]))]);
+		sink += strtol(text + 1, NULL, 10);
+	}
+	stdio_s = seconds(start);
+
+	printf("Pack + unpack: pair table %.1f ns, per digit %.1f ns, snprintf/strtol %.1f ns\n",
+		   1e9 * table_s / TEST_BENCH, 1e9 * digit_s / TEST_BENCH, 1e9 * stdio_s / TEST_BENCH);
+	printf("Values: 4294967296, malformed: %lu of %lu, errors: %lu\n", rejected, TEST_MALFORMED, errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
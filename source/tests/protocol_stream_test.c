@@ -0,0 +1,228 @@
+/***************************************************************************//**
+  @file     protocol_stream_test.c
+  @brief    Protocol Testbench: streaming parser fed in random chunks
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. protocol_stream_test.c ../protocol.c
+            ASCII, frame and batch streams are parsed side by side, a chunk of
+            each at a time, with corrupted and lost messages on the way.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "protocol.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_MESSAGES	200000UL												// Per stream
+#define TEST_CHUNK_MAX	48
+#define TEST_LINE_MAX	(PROTOCOL_BATCH_SIZE(PROTOCOL_MAX_RECORDS) + PROTOCOL_DIGS)
+#define TEST_PENDING	1024													// Records sent and not parsed yet
+#define TEST_KEY		16
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef struct {
+	protocol_stream_t	mode;
+	protocol_parser_t	parser;
+	uchar_t				line[TEST_LINE_MAX * 4];									// Bytes on the wire, not parsed yet
+	size_t				head, tail;
+	protocol_t			pending[TEST_PENDING];									// Records the parser must deliver, in order
+	unsigned long		in, out;
+	unsigned long		bad;													// Messages the parser must drop
+	unsigned long		errors;
+} stream_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static stream_t streams[3];
+static protocol_delta_t tx, rx, reference;
+static protocol_t records[PROTOCOL_MAX_RECORDS], unpacked[PROTOCOL_MAX_RECORDS];
+static protocol_val_t signal[8];
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void deliver (const protocol_t* data, void* arg)
+{
+	stream_t* s = arg;
+	protocol_t* want = &s->pending[s->out++ % TEST_PENDING];
+
+	s->errors += (s->out > s->in) || (data->id != want->id) || (data->val != want->val);
+}
+
+static void expect (stream_t* s, const protocol_t* data, uint8_t count)
+{
+	for (uint8_t i = 0; i < count; i++)
+		s->pending[s->in++ % TEST_PENDING] = data[i];
+}
+
+static void send (stream_t* s, const uchar_t* data, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+		s->line[s->head++ % sizeof(s->line)] = data[i];
+}
+
+static void receive (stream_t* s)												// One chunk, cut anywhere
+{
+	size_t len = s->head - s->tail, n = rand() % (TEST_CHUNK_MAX + 1), start = s->tail % sizeof(s->line);
+
+	n = n < len ? n : len;
+	n = n < sizeof(s->line) - start ? n : sizeof(s->line) - start;			// The parser sees contiguous bytes
+	protocolParse(&s->parser, &s->line[start], n);
+	s->tail += n;
+}
+
+static uint8_t sample (void)													// Slowly moving channels
+{
+	uint8_t count = 1 + rand() % PROTOCOL_MAX_RECORDS;
+
+	for (uint8_t i = 0; i < count; i++)
+	{
+		uint8_t ch = rand() % 8;
+		signal[ch] += rand() % 41 - 20;
+		records[i] = (protocol_t){ 'A' + ch, (rand() % 64) ? signal[ch] : (protocol_val_t)(((uint32_t)rand() << 16) ^ rand()) };
+	}
+
+	return count;
+}
+
+static void asciiMessage (stream_t* s, unsigned long n)
+{
+	uchar_t msg[PROTOCOL_DIGS + 1];
+	protocol_t data = { 'A' + rand() % 26, (protocol_val_t)(((uint32_t)rand() << 16) ^ rand()) >> (rand() % 32) };
+	uint8_t len = protocolPack(&data, msg);
+
+	if (!(n % 97))																// No digits, or a stray byte after the sign
+	{
+		msg[1] = (n & 1) ? '+' : '-';
+		msg[2] = '#';
+		len = (n & 1) ? 2 : len;
+		s->bad++;
+	}
+	else
+		expect(s, &data, 1);
+
+	if (!(n % 97) || (rand() % 3))												// Otherwise the next id ends it
+	{
+		if (rand() & 1)
+			msg[len++] = '\r';
+		msg[len++] = PROTOCOL_ASCII_DELIM;
+	}
+
+	send(s, msg, len);
+}
+
+static void frameMessage (stream_t* s, unsigned long n)
+{
+	uchar_t frame[PROTOCOL_FRAME_SIZE(PROTOCOL_MAX_RECORDS)];
+	uint8_t count = rand() % (PROTOCOL_MAX_RECORDS + 1);
+	size_t len;
+
+	for (uint8_t i = 0; i < count; i++)
+		records[i] = (protocol_t){ (protocol_id_t)rand(), (protocol_val_t)(((uint32_t)rand() << 16) ^ rand()) };
+	len = protocolPackFrame(records, count, frame);
+
+	if (!(n % 61))																// One bad byte, never a delimiter
+	{
+		size_t at = rand() % (len - 1);
+		uchar_t flip = 1 + rand() % 0xFF;
+		frame[at] ^= (frame[at] ^ flip) ? flip : 0x80;
+		s->bad++;
+	}
+	else
+		expect(s, records, count);
+
+	if (!(n % 53))																// Idle delimiters are fine
+		send(s, (const uchar_t[]){ PROTOCOL_DELIM }, 1);
+	send(s, frame, len);
+}
+
+static void batchMessage (stream_t* s, unsigned long n)
+{
+	uchar_t frame[PROTOCOL_BATCH_SIZE(PROTOCOL_MAX_RECORDS)];
+	uint8_t count = sample();
+	size_t len;
+	int16_t got;
+
+	if (!(n % TEST_KEY))
+		protocolDeltaKey(&tx);
+	len = protocolPackBatch(records, count, &tx, frame);
+
+	if (!(rand() % 50))															// Lost on the line
+		return;
+
+	got = protocolUnpackBatch(frame, len, unpacked, PROTOCOL_MAX_RECORDS, &reference);	// What the parser must agree with
+	if (got < 0)
+		s->bad++;
+	else
+		expect(s, unpacked, got);
+
+	send(s, frame, len);
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	static void (* const message[])(stream_t*, unsigned long) = { asciiMessage, frameMessage, batchMessage };
+	static const char* const names[] = { "ASCII", "Frame", "Batch" };
+	unsigned long errors = 0;
+
+	protocolDeltaInit(&tx);
+	protocolDeltaInit(&rx);
+	protocolDeltaInit(&reference);
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		streams[i].mode = (protocol_stream_t)i;
+		protocolParserInit(&streams[i].parser, streams[i].mode, deliver, &streams[i], (i == PROTOCOL_STREAM_BATCH) ? &rx : NULL);
+	}
+
+	srand(1);
+	for (unsigned long n = 0; n < TEST_MESSAGES; n++)
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			message[i](&streams[i], n);
+			while (streams[i].head - streams[i].tail > TEST_LINE_MAX * 2)		// Interleaved chunks, partial messages left over
+				for (uint8_t j = 0; j < 3; j++)
+					receive(&streams[j]);
+		}
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		stream_t* s = &streams[i];
+
+		send(s, (const uchar_t[]){ (i == PROTOCOL_STREAM_ASCII) ? PROTOCOL_ASCII_DELIM : PROTOCOL_DELIM }, 1);
+		while (s->tail != s->head)
+			receive(s);
+
+		s->errors += (s->out != s->in) || (s->parser.errors != s->bad);
+		errors += s->errors;
+		printf("%s: %lu records, %lu dropped (%lu expected), errors: %lu\n", names[i], s->out,
+			   (unsigned long)s->parser.errors, s->bad, s->errors);
+	}
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,204 @@
+/***************************************************************************//**
+  @file     protocol_test.c
+  @brief    Protocol Testbench: binary and batch frames round trip, corruption and speed
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. protocol_test.c ../protocol.c
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "protocol.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_FRAMES		200000UL
+#define TEST_BENCH		2000000UL												// Records per benchmark
+#define TEST_IDS		8														// Channels in the batch tests
+#define TEST_KEY		16														// Frames between key frames
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static protocol_t records[PROTOCOL_MAX_RECORDS], unpacked[PROTOCOL_MAX_RECORDS];
+static uchar_t frame[PROTOCOL_BATCH_SIZE(PROTOCOL_MAX_RECORDS)];
+static protocol_delta_t tx, rx;
+static protocol_val_t signal[TEST_IDS];
+static volatile unsigned long sink;												// Keeps the benchmarks honest
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void fill (uint8_t count, int zeros)										// Random records, optionally zero-heavy for COBS
+{
+	for (uint8_t i = 0; i < count; i++)
+	{
+		records[i].id = zeros && (rand() & 1) ? 0 : (protocol_id_t)rand();
+		records[i].val = zeros && (rand() & 1) ? 0 : (protocol_val_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+	}
+}
+
+static void sample (uint8_t count, int step)									// Slowly moving channels, ids repeat within a frame
+{
+	for (uint8_t i = 0; i < count; i++)
+	{
+		uint8_t ch = rand() % TEST_IDS;
+		signal[ch] += rand() % (2 * step + 1) - step;
+		records[i] = (protocol_t){ 'A' + ch, signal[ch] };
+	}
+}
+
+static unsigned long check (uint8_t count, int16_t got)
+{
+	unsigned long errors = got != count;
+
+	for (uint8_t i = 0; (got == count) && (i < count); i++)
+		errors += (unpacked[i].id != records[i].id) || (unpacked[i].val != records[i].val);
+
+	return errors;
+}
+
+static double seconds (clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	unsigned long errors = 0, corrupted = 0, detected = 0, ascii_bytes = 0, binary_bytes = 0;
+	uchar_t msg[PROTOCOL_DIGS];
+	clock_t start;
+	double ascii_s, binary_s;
+
+	errors += protocolCRC16(0xFFFF, (const uchar_t*)"123456789", 9) != 0x29B1;	// Check value
+
+	srand(1);
+	for (unsigned long n = 0; n < TEST_FRAMES; n++)
+	{
+		uint8_t count = rand() % (PROTOCOL_MAX_RECORDS + 1);
+		size_t len;
+		int16_t got;
+
+		fill(count, n & 1);
+		len = protocolPackFrame(records, count, frame);
+
+		errors += len > PROTOCOL_FRAME_SIZE(count);
+		errors += frame[len - 1] != PROTOCOL_DELIM;
+		for (size_t i = 0; i < len - 1; i++)									// No delimiter inside the frame
+			errors += frame[i] == PROTOCOL_DELIM;
+
+		got = protocolUnpackFrame(frame, len, unpacked, PROTOCOL_MAX_RECORDS);
+		errors += got != count;
+		for (uint8_t i = 0; (got == count) && (i < count); i++)
+			errors += (unpacked[i].id != records[i].id) || (unpacked[i].val != records[i].val);
+
+		errors += protocolUnpackFrame(frame, len - 1, unpacked, PROTOCOL_MAX_RECORDS) != count;	// Delimiter optional
+		errors += count && (protocolUnpackFrame(frame, len, unpacked, count - 1) != -1);		// No room
+
+		if (len > 2)															// One bad byte
+		{
+			size_t at = rand() % (len - 1);
+			uchar_t good = frame[at];
+			frame[at] ^= 1 + rand() % 0xFF;
+			corrupted++;
+			detected += protocolUnpackFrame(frame, len, unpacked, PROTOCOL_MAX_RECORDS) != count;
+			frame[at] = good;
+		}
+		errors += (len > 2) && (protocolUnpackFrame(frame, len - 2, unpacked, PROTOCOL_MAX_RECORDS) != -1);	// Truncated
+	}
+	errors += detected != corrupted;
+
+	protocolDeltaInit(&tx);														// Batch frames, deltas, a lossy link
+	protocolDeltaInit(&rx);
+	unsigned long batches = 0, lost = 0, rejected = 0, batch_bytes = 0, batch_records = 0;
+	for (unsigned long n = 0; n < TEST_FRAMES; n++)
+	{
+		uint8_t count = 1 + rand() % PROTOCOL_MAX_RECORDS;
+		size_t len;
+		int16_t got;
+
+		if (!(n % TEST_KEY))
+			protocolDeltaKey(&tx);
+		sample(count, (n & 0xFF) ? 20 : 30000);									// Now and then, deltas as large as they get
+		len = protocolPackBatch(records, count, &tx, frame);
+		errors += len > PROTOCOL_BATCH_SIZE(count);
+		errors += protocolUnpackBatch(frame, len, unpacked, count, NULL) != ((n % TEST_KEY) ? -1 : count);	// No context: key frames only
+
+		if (!(rand() % 50))														// Lost on the line
+		{
+			lost++;
+			continue;
+		}
+		got = protocolUnpackBatch(frame, len, unpacked, PROTOCOL_MAX_RECORDS, &rx);
+		if (got < 0)
+		{
+			rejected++;
+			errors += !lost || !(n % TEST_KEY);									// Only after a loss, never a key frame
+			continue;
+		}
+		errors += check(count, got);
+		batches++;
+		batch_bytes += len;
+		batch_records += count;
+	}
+	errors += !rejected;
+
+	for (uint8_t i = 0; i < TEST_IDS; i++)										// Absolute batch without a context
+		signal[i] = 0;
+	sample(PROTOCOL_MAX_RECORDS, 30000);
+	errors += check(PROTOCOL_MAX_RECORDS, protocolUnpackBatch(frame, protocolPackBatch(records, PROTOCOL_MAX_RECORDS, NULL, frame),
+															  unpacked, PROTOCOL_MAX_RECORDS, NULL));
+	frame[4] ^= 0x10;
+	errors += protocolUnpackBatch(frame, PROTOCOL_BATCH_SIZE(PROTOCOL_MAX_RECORDS), unpacked, PROTOCOL_MAX_RECORDS, NULL) != -1;
+
+	fill(PROTOCOL_MAX_RECORDS, 0);
+
+	start = clock();
+	for (unsigned long n = 0; n < TEST_BENCH; n++)
+	{
+		uint8_t len = protocolPack(&records[n % PROTOCOL_MAX_RECORDS], msg);
+		ascii_bytes += len + 1;													// Plus the '\n' separator
+		sink += protocolUnpack(msg, len)->val;
+	}
+	ascii_s = seconds(start);
+
+	start = clock();
+	for (unsigned long n = 0; n < TEST_BENCH; n += PROTOCOL_MAX_RECORDS)
+	{
+		size_t len = protocolPackFrame(records, PROTOCOL_MAX_RECORDS, frame);
+		binary_bytes += len;
+		sink += protocolUnpackFrame(frame, len, unpacked, PROTOCOL_MAX_RECORDS);
+	}
+	binary_s = seconds(start);
+
+	printf("ASCII:  %.2f bytes/record, %.1f ns/record (full range)\n", (double)ascii_bytes / TEST_BENCH, 1e9 * ascii_s / TEST_BENCH);
+	printf("Binary: %.2f bytes/record, %.1f ns/record (%u per frame, full range)\n", (double)binary_bytes / TEST_BENCH,
+		   1e9 * binary_s / TEST_BENCH, PROTOCOL_MAX_RECORDS);
+	printf("Batch:  %.2f bytes/record with deltas, %lu frames, %lu lost, %lu rejected until the next key frame\n",
+		   (double)batch_bytes / batch_records, batches, lost, rejected);
+	printf("Frames: %lu, corrupted: %lu, detected: %lu, errors: %lu\n", TEST_FRAMES, corrupted, detected, errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,184 @@
+/***************************************************************************//**
+  @file     scheduler_test.c
+  @brief    Scheduler Testbench: priorities, merged posts and threads as ISRs
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -DSCHED_HOST=1 -I.. scheduler_test.c ../scheduler.c -lpthread
+            Each ISR thread counts what it posts and its task checks nothing
+            is left behind, so a lost wakeup shows up as a count mismatch.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "scheduler.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_IRQS		4														// Threads standing in for ISRs
+#define TEST_POSTS		200000UL												// Per thread
+#define TEST_STOP		0														// Lowest priority, runs once everything else did
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static sched_prio_t order[SCHED_TASKS * 2];
+static unsigned ran, again;
+
+static volatile unsigned long produced[TEST_IRQS], consumed[TEST_IRQS];
+static volatile long long posted_at[TEST_IRQS];
+static long long latency_max, latency_sum;
+static unsigned long latency_n;
+static volatile bool stop;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static long long now (void)														// ns
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Single thread: order and merging ////////////////////////////////////////////
+
+#define LOG_TASK(p)		static void task##p (void) { order[ran++] = p; }
+LOG_TASK(0)  LOG_TASK(1)  LOG_TASK(2)  LOG_TASK(3)  LOG_TASK(4)  LOG_TASK(5)  LOG_TASK(6)  LOG_TASK(7)
+LOG_TASK(8)  LOG_TASK(9)  LOG_TASK(10) LOG_TASK(11) LOG_TASK(12) LOG_TASK(13) LOG_TASK(14) LOG_TASK(15)
+LOG_TASK(16) LOG_TASK(17) LOG_TASK(18) LOG_TASK(19) LOG_TASK(20) LOG_TASK(21) LOG_TASK(22) LOG_TASK(23)
+LOG_TASK(24) LOG_TASK(25) LOG_TASK(26) LOG_TASK(27) LOG_TASK(28) LOG_TASK(29) LOG_TASK(30)
+
+static void selfPost (void)														// Posted while running: runs again
+{
+	order[ran++] = 31;
+	if (!again++)
+		schedPost(31);
+}
+
+// Threads as ISRs /////////////////////////////////////////////////////////////
+
+static void irqTask (sched_prio_t i)
+{
+	long long lat = now() - __atomic_load_n(&posted_at[i], __ATOMIC_ACQUIRE);
+
+	consumed[i] = __atomic_load_n(&produced[i], __ATOMIC_ACQUIRE);				// Everything posted so far is handled
+	latency_sum += lat;
+	latency_max = lat > latency_max ? lat : latency_max;
+	latency_n++;
+}
+
+static void irq1 (void) { irqTask(0); }
+static void irq2 (void) { irqTask(1); }
+static void irq3 (void) { irqTask(2); }
+static void irq4 (void) { irqTask(3); }
+
+static void stopTask (void)
+{
+	stop = true;
+}
+
+static void* stopThread (void* arg)											// Once every ISR thread is done
+{
+	pthread_t* threads = arg;
+
+	for (sched_prio_t i = 0; i < TEST_IRQS; i++)
+		pthread_join(threads[i], NULL);
+	schedPost(TEST_STOP);
+
+	return NULL;
+}
+
+static void* irqThread (void* arg)
+{
+	sched_prio_t i = (sched_prio_t)(size_t)arg;
+	unsigned seed = i;
+
+	for (unsigned long n = 0; n < TEST_POSTS; n++)
+	{
+		__atomic_fetch_add(&produced[i], 1, __ATOMIC_RELEASE);
+		__atomic_store_n(&posted_at[i], now(), __ATOMIC_RELEASE);
+		schedPost(i + 1);
+		if (!(rand_r(&seed) % 64))												// Quiet now and then, the dispatcher sleeps
+			usleep(rand_r(&seed) % 50);
+	}
+
+	return NULL;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	static void (* const tasks[])(void) = { task0, task1, task2, task3, task4, task5, task6, task7, task8, task9, task10, task11, task12, task13, task14, task15,
+											task16, task17, task18, task19, task20, task21, task22, task23, task24, task25, task26, task27, task28, task29, task30, selfPost };
+	static void (* const irqs[])(void) = { irq1, irq2, irq3, irq4 };
+	unsigned long errors = 0;
+	pthread_t threads[TEST_IRQS], joiner;
+	sched_stats_t stats;
+
+	schedInit();
+	for (sched_prio_t p = 0; p < SCHED_TASKS; p++)
+		errors += !schedRegister(p, tasks[p]);
+	errors += schedRegister(0, task0) || schedRegister(SCHED_TASKS, task0);		// Taken, out of range
+
+	srand(1);
+	for (unsigned n = 0; n < 4 * SCHED_TASKS; n++)								// Every task, most of them several times
+		schedPost(rand() % SCHED_TASKS);
+	for (sched_prio_t p = 0; p < SCHED_TASKS; p++)
+		schedPost(p);
+	while (ran < SCHED_TASKS + 1)
+		errors += !schedDispatch();
+
+	errors += (order[0] != 31) || (order[1] != 31);								// Highest first, the self post right away
+	for (unsigned i = 2; i < ran; i++)
+		errors += order[i] != SCHED_TASKS - i;
+	stats = schedGetStats();
+	errors += (stats.runs != SCHED_TASKS + 1) || (stats.posts != 5 * SCHED_TASKS + 1) || stats.sleeps;
+	printf("Order: %u tasks run for %lu posts, errors: %lu\n", ran, (unsigned long)stats.posts, errors);
+
+	schedInit();
+	for (sched_prio_t i = 0; i < TEST_IRQS; i++)
+		schedRegister(i + 1, irqs[i]);
+	schedRegister(TEST_STOP, stopTask);
+
+	for (sched_prio_t i = 0; i < TEST_IRQS; i++)
+		pthread_create(&threads[i], NULL, irqThread, (void*)(size_t)i);
+	pthread_create(&joiner, NULL, stopThread, threads);
+	while (!stop)																// App_Run
+		schedDispatch();
+	pthread_join(joiner, NULL);
+
+	stats = schedGetStats();
+	for (sched_prio_t i = 0; i < TEST_IRQS; i++)
+		errors += consumed[i] != TEST_POSTS;
+	errors += (stats.posts != TEST_IRQS * TEST_POSTS + 1) || !stats.sleeps;
+	printf("Threads: %lu posts, %lu runs, %lu sleeps, post to run %.1f us mean, %.1f us max\n", (unsigned long)stats.posts,
+		   (unsigned long)stats.runs, (unsigned long)stats.sleeps, latency_sum / 1e3 / latency_n, latency_max / 1e3);
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
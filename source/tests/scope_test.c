@@ -0,0 +1,255 @@
+/***************************************************************************//**
+  @file     scope_test.c
+  @brief    Scope Testbench: triggers and snapshots through a simulated serial link
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. scope_test.c ../scope.c ../protocol.c -lm
+            Every trigger is checked against a plain scan of the signal and
+            every snapshot sample against the signal around the trigger.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+
+#include "scope.h"
+#include "serial.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_QUEUE		8														// Frames the serial port takes at once
+#define TEST_UPDATE		4														// Samples between main loop passes
+#define TEST_LIMIT		100000UL												// Samples to wait for a capture
+#define TEST_REARMS		20
+#define TEST_LATENCY	64														// Carrier detector, samples
+#define TEST_PI			3.14159265358979
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static struct {
+	const uchar_t*		data;
+	uint32_t			len;
+	serial_callback_t	cb;
+} queue[TEST_QUEUE];
+static unsigned in, out;
+
+static uint16_t (* signal)(unsigned long);
+static const scope_cfg_t* config;
+static unsigned long n, event;													// Next sample, where the burst or step starts
+static unsigned long armed_at, trigger, captured, frames, errors;
+static uint16_t snap[SCOPE_BUFFER_SAMPLES], got;
+static uint8_t capture;
+static bool busy;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+// Stubs ///////////////////////////////////////////////////////////////////////
+
+bool serialWriteFrame (const uchar_t* data, uint32_t len, serial_callback_t cb)
+{
+	if (in - out == TEST_QUEUE)
+		return false;
+	queue[in++ % TEST_QUEUE] = (typeof(queue[0])){ data, len, cb };
+
+	return true;
+}
+
+// Signals /////////////////////////////////////////////////////////////////////
+
+static int32_t noise (unsigned long i, int32_t amplitude)
+{
+	uint32_t hash = (uint32_t)i * 2654435761U;
+
+	return (int32_t)((hash >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+static uint16_t clip (double x)
+{
+	return (uint16_t)(x < 0 ? 0 : x > 4095 ? 4095 : x);
+}
+
+static uint16_t step (unsigned long i)
+{
+	return clip((i < event ? 1000 : 3000) + noise(i, 8));
+}
+
+static uint16_t sine (unsigned long i)
+{
+	return clip(2048 + 1000 * sin(2 * TEST_PI * i / 37.3) + noise(i, 40));
+}
+
+static uint16_t burst (unsigned long i)											// 1200 Hz at 12 kHz, on a drifting line
+{
+	double line = 2048 + 200 * sin(i * 0.0005) + noise(i, 4);
+
+	return clip(line + ((i >= event) && (i < event + 3000) ? 800 * sin(2 * TEST_PI * i / 10) : 0));
+}
+
+// Reference and far end ///////////////////////////////////////////////////////
+
+static unsigned long reference (unsigned long from)								// First trigger once the ring holds cfg.pre
+{
+	int32_t level = config->level, hyst = config->hyst;
+	bool ready = false;
+
+	for (unsigned long k = from; ; k++)
+	{
+		int32_t x = signal(k);
+		bool hit = (config->trigg == SCOPE_TRIGG_LEVEL) ? (x >= level) :
+				   (config->trigg == SCOPE_TRIGG_RISING) ? ready && (x >= level) : ready && (x <= level);
+
+		if (hit && (k - from >= config->pre))
+			return k;
+		ready |= (config->trigg == SCOPE_TRIGG_RISING) ? (x < level - hyst) : (x > level + hyst);
+	}
+}
+
+static void farEnd (const uchar_t* frame, uint32_t len)
+{
+	uchar_t payload[SCOPE_PAYLOAD_MAX];
+	uint16_t samples[SCOPE_CHUNK_SAMPLES];
+	scope_header_t header;
+	int32_t size = protocolUnpackBytes(frame, len, payload, sizeof(payload));
+	int16_t count = (size < 0) ? -1 : scopeDecode(payload, size, &header, samples);
+
+	frames++;
+	if ((count <= 0) || (header.offset != got) || (header.capture != capture) ||
+		(header.trigger != config->pre) || (header.total != config->pre + config->post))
+	{
+		errors++;
+		return;
+	}
+	for (int16_t i = 0; i < count; i++)
+		snap[got++] = samples[i];
+
+	if (got == header.total)
+	{
+		for (uint16_t i = 0; i < got; i++)
+			errors += snap[i] != signal(trigger - header.trigger + i);
+		captured++;
+		capture++;
+		got = 0;
+	}
+}
+
+static void link (void)															// Everything queued goes out
+{
+	while (in != out)
+	{
+		farEnd(queue[out % TEST_QUEUE].data, queue[out % TEST_QUEUE].len);
+		queue[out % TEST_QUEUE].cb(queue[out % TEST_QUEUE].data);
+		out++;
+	}
+}
+
+static void tick (void)															// One ADC sample, now and then a main loop pass
+{
+	scope_state_t before = scopeGetState();
+
+	scopePush(signal(n));
+	if ((before == SCOPE_ARMED) && (scopeGetState() != SCOPE_ARMED))
+	{
+		trigger = n;
+		if (config->trigg == SCOPE_TRIGG_CARRIER)
+			errors += (trigger < event) || (trigger > event + TEST_LATENCY);
+		else
+			errors += trigger != reference(armed_at);
+	}
+	n++;
+
+	if ((scopeGetState() == SCOPE_DUMPING) && !busy)							// Snapshot frozen until it is out
+	{
+		errors += scopeArm(config);
+		busy = true;
+	}
+
+	if (!(n % TEST_UPDATE))
+	{
+		before = scopeGetState();
+		scopeUpdate();
+		if ((before == SCOPE_DUMPING) && (scopeGetState() == SCOPE_ARMED))		// Rearmed
+		{
+			armed_at = n;
+			busy = false;
+		}
+		link();
+	}
+}
+
+static bool run (const scope_cfg_t* cfg, uint16_t (* sig)(unsigned long), unsigned long captures)
+{
+	unsigned long start = n, want = captured + captures;
+
+	config = cfg;
+	signal = sig;
+	busy = false;
+	armed_at = n;
+	if (!scopeArm(cfg))
+		return false;
+
+	while ((captured < want) && (n - start < TEST_LIMIT))
+		tick();
+	scopeDisarm();
+	while (scopeGetState() == SCOPE_DUMPING)
+		tick();
+
+	return captured >= want;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	static const struct {
+		const char*		name;
+		scope_cfg_t		cfg;
+		uint16_t		(* signal)(unsigned long);
+		unsigned long	captures;
+	} cases[] = {
+		{ "Level",          { SCOPE_TRIGG_LEVEL,   2000,   0,  300,  700, false }, step,  1 },
+		{ "Level, no pre",  { SCOPE_TRIGG_LEVEL,   2000,   0,    0,    1, false }, step,  1 },
+		{ "Level at once",  { SCOPE_TRIGG_LEVEL,      0,   0,  500,  100, false }, step,  1 },
+		{ "Rising",         { SCOPE_TRIGG_RISING,  2048, 100,  256,  256, false }, sine,  1 },
+		{ "Falling",        { SCOPE_TRIGG_FALLING, 2048, 100, 1000, 1048, false }, sine,  1 },
+		{ "Carrier",        { SCOPE_TRIGG_CARRIER,  100,   0,  512, 1536, false }, burst, 1 },
+		{ "Rising, rearm",  { SCOPE_TRIGG_RISING,  2600,  50,  100,  157, true  }, sine,  TEST_REARMS },
+	};
+	const scope_cfg_t too_big = { SCOPE_TRIGG_LEVEL, 0, 0, SCOPE_BUFFER_SAMPLES, 1, false }, no_post = { SCOPE_TRIGG_LEVEL, 0, 0, 1, 0, false };
+
+	scopeInit(NULL);
+	errors += scopeArm(&too_big) || scopeArm(&no_post);
+
+	for (uint8_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		unsigned long before = errors, from = captured, start = frames;
+
+		event = n + 5000;
+		errors += !run(&cases[i].cfg, cases[i].signal, cases[i].captures);
+		errors += (captured - from != cases[i].captures) || (scopeGetState() != SCOPE_IDLE);
+		printf("%-14s %2lu captures, %4u samples each, trigger %+ld from the event, %3lu frames, errors: %lu\n", cases[i].name,
+			   captured - from, cases[i].cfg.pre + cases[i].cfg.post, (long)(trigger - event), frames - start, errors - before);
+	}
+
+	printf("Captures: %lu, frames: %lu, errors: %lu\n", captured, frames, errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,178 @@
+/***************************************************************************//**
+  @file     serial_test.c
+  @brief    Serial Testbench: framed zero-copy receive over a simulated DMA ring
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. serial_test.c ../serial.c ../dmaring.c
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dmaring.h"
+#include "macros.h"
+#include "serial.h"
+#include "uart.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_RING_SIZE	200														// Not a multiple of anything, frames wrap often
+#define TEST_FRAMES		1000000UL
+#define TEST_LEN_MAX	(SERIAL_FRAME_MAX + 20)									// Some frames get split
+#define TEST_LAP_LEN	10
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static uint8_t buffer[TEST_RING_SIZE];
+static dma_ring_t ring;
+static uint32_t head;
+
+static uint32_t expected[SERIAL_FRAMES_CANT * 4 + TEST_RING_SIZE];				// Pending frame lengths, as serial.c must split them
+static uint8_t first[SERIAL_FRAMES_CANT * 4 + TEST_RING_SIZE];
+static unsigned long pushed, popped;
+static uint8_t next;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+// Stubs ///////////////////////////////////////////////////////////////////////
+
+bool uartInit (uart_id_t id, uart_cfg_t config) { return true; }
+uint8_t uartWriteMsg (uart_id_t id, const uchar_t* msg, uint8_t cant) { return cant; }
+uint8_t uartIsTxMsgComplete (uart_id_t id) { return true; }
+uint8_t uartIsRxMsg (uart_id_t id) { return dmaRingAvailable(&ring, head) != 0; }
+uint8_t uartIsRxMsgComplete (uart_id_t id) { return false; }
+bool uartWriteDesc (uart_id_t id, const uchar_t* msg, uint32_t cant, uart_callback_t cb) { return false; }
+bool uartWritePolled (uart_id_t id, const uchar_t* msg, uint32_t cant) { return true; }
+
+uint32_t uartRxPeek (uart_id_t id, uint32_t offset, const uchar_t** msg) { return dmaRingPeekAt(&ring, head, offset, (uint8_t**)msg); }
+void uartRxConsume (uart_id_t id, uint32_t cant) { dmaRingConsume(&ring, cant); }
+uint32_t uartRxOverruns (uart_id_t id) { dmaRingAvailable(&ring, head); return ring.overruns; }
+
+// Simulated line //////////////////////////////////////////////////////////////
+
+static void expect (uint32_t len, uint8_t byte)
+{
+	expected[pushed % (sizeof(expected) / sizeof(expected[0]))] = len;
+	first[pushed++ % (sizeof(first) / sizeof(first[0]))] = byte;
+}
+
+static bool receive (void)														// One frame written by the "DMA", if it fits
+{
+	uint32_t len = rand() % TEST_LEN_MAX;
+
+	if (dmaRingAvailable(&ring, head) + len + 1 > TEST_RING_SIZE)
+		return false;
+
+	for (uint32_t i = 0; i <= len; i++)
+	{
+		if (!(i % SERIAL_FRAME_MAX))											// serial.c splits long frames
+			expect(MIN(len - i, SERIAL_FRAME_MAX), next);
+		if (i < len)
+		{
+			buffer[head++ % TEST_RING_SIZE] = next++;
+			next += next == SERIAL_FRAME_DELIM;
+		}
+	}
+	buffer[head++ % TEST_RING_SIZE] = SERIAL_FRAME_DELIM;
+
+	return true;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	unsigned long errors = 0, before, in_place = 0, linearized = 0, frames = 0;
+	const uchar_t* data;
+	uint32_t len;
+	uint8_t taken = 0;
+
+	dmaRingInit(&ring, buffer, TEST_RING_SIZE);
+
+	srand(1);
+	while (frames < TEST_FRAMES)
+	{
+		for (uint8_t i = rand() % 3; i; i--)
+			receive();
+
+		for (uint8_t i = rand() % (SERIAL_FRAMES_CANT + 1); i && serialReadFrame(&data, &len); i--)
+		{
+			uint32_t index = popped++ % (sizeof(expected) / sizeof(expected[0]));
+			uint8_t byte = first[index];
+
+			errors += (popped > pushed) || (len != expected[index]);
+			for (uint32_t j = 0; j < len; j++)
+			{
+				errors += data[j] != byte++;
+				byte += byte == SERIAL_FRAME_DELIM;
+			}
+			if ((data >= buffer) && (data < buffer + TEST_RING_SIZE))
+				in_place++;
+			else
+				linearized++;
+			taken++;
+			frames++;
+		}
+
+		errors += (taken == SERIAL_FRAMES_CANT) && serialReadFrame(&data, &len);	// No more than SERIAL_FRAMES_CANT held
+
+		for (uint8_t i = rand() % (taken + 1); i; i--, taken--)
+			serialReleaseFrame();
+	}
+
+	errors += ring.overruns;
+	printf("Frames: %lu (%lu in place, %lu linearized), overruns: %u, errors: %lu\n", frames, in_place, linearized, ring.overruns, errors);
+	before = errors;
+
+	for (; taken; taken--)														// Line overwrites two held frames
+		serialReleaseFrame();
+	while (serialReadFrame(&data, &len))
+		serialReleaseFrame();
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		receive();
+		errors += !serialReadFrame(&data, &len);
+	}
+	for (uint32_t i = 0; i < 3 * TEST_RING_SIZE; i++)							// Ends mid garbage, no delimiter to resync on
+		buffer[head++ % TEST_RING_SIZE] = 'x';
+	buffer[head++ % TEST_RING_SIZE] = SERIAL_FRAME_DELIM;
+	for (uint8_t i = 0; i < TEST_LAP_LEN; i++)
+		buffer[head++ % TEST_RING_SIZE] = 'a' + i;
+	buffer[head++ % TEST_RING_SIZE] = SERIAL_FRAME_DELIM;
+
+	errors += !serialReadFrame(&data, &len) || (len != TEST_LAP_LEN) || !ring.overruns;
+	for (uint8_t i = 0; (i < len) && (i < TEST_LAP_LEN); i++)
+		errors += data[i] != 'a' + i;
+	serialReleaseFrame();
+	serialReleaseFrame();														// Dropped ones: nothing left to release
+	serialReleaseFrame();
+	errors += dmaRingAvailable(&ring, head) || serialReadFrame(&data, &len);
+	for (uint8_t i = 0; i < TEST_LAP_LEN / 2; i++)								// Back in step
+		buffer[head++ % TEST_RING_SIZE] = 'a' + i;
+	buffer[head++ % TEST_RING_SIZE] = SERIAL_FRAME_DELIM;
+	errors += !serialReadFrame(&data, &len) || (len != TEST_LAP_LEN / 2) || (data[0] != 'a');
+	printf("Lapped: %u bytes lost, frames resynced, errors: %lu\n", ring.overruns, errors - before);
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
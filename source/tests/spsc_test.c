@@ -0,0 +1,136 @@
+/***************************************************************************//**
+  @file     spsc_test.c
+  @brief    SPSC Ring Buffer Testbench: two-thread stress and throughput
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. spsc_test.c ../spsc.c ../cqueue.c -lpthread
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "cqueue.h"
+#include "spsc.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define STRESS_CAPACITY		64
+#define STRESS_ITEMS		2000000UL
+#define BENCH_ITEMS			1000000UL
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+SPSC_STORAGE(stress_items, STRESS_CAPACITY, uint32_t);
+SPSC_STORAGE(bench_items, 32, uint8_t);
+
+static spsc_t stress;
+static spsc_t bench;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static double now (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void* producer (void* arg)
+{
+	(void)arg;
+	for (uint32_t i = 0; i < STRESS_ITEMS; )
+		if (spscPush(&stress, &i))
+			i++;
+		else
+			sched_yield();														// Let the consumer run on single-core hosts
+
+	return NULL;
+}
+
+static void* consumer (void* arg)
+{
+	unsigned long* errors = arg;
+	uint32_t data;
+
+	for (uint32_t i = 0; i < STRESS_ITEMS; )
+		if (spscPop(&stress, &data))
+		{
+			if (data != i)
+				(*errors)++;
+			i++;
+		}
+		else
+			sched_yield();
+
+	return NULL;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	pthread_t prod, cons;
+	unsigned long errors = 0;
+	double st, et;
+	uint8_t byte = 0;
+
+	/* Stress: one producer and one consumer thread, every element in order */
+	spscInit(&stress, stress_items, STRESS_CAPACITY, sizeof(uint32_t));
+	st = now();
+	pthread_create(&cons, NULL, consumer, &errors);
+	pthread_create(&prod, NULL, producer, NULL);
+	pthread_join(prod, NULL);
+	pthread_join(cons, NULL);
+	et = now();
+	printf("Stress: %lu items, %lu errors, %s, %.1f Mitems/s\n", STRESS_ITEMS, errors,
+		   spscIsEmpty(&stress) ? "empty" : "NOT EMPTY", STRESS_ITEMS / (et - st) / 1e6);
+
+	/* Throughput: push + pop pairs on a single thread */
+	spscInit(&bench, bench_items, 32, sizeof(uint8_t));
+	st = now();
+	for (unsigned long i = 0; i < BENCH_ITEMS; i++)
+	{
+		byte = (uint8_t)i;
+		spscPush(&bench, &byte);
+		spscPop(&bench, &byte);
+	}
+	et = now();
+	double spsc_ns = (et - st) * 1e9 / BENCH_ITEMS;
+
+	queue_id_t id = queueInit(QUEUE_MAX_SIZE, sizeof(uint8_t));
+	st = now();
+	for (unsigned long i = 0; i < BENCH_ITEMS; i++)
+	{
+		byte = (uint8_t)i;
+		queuePush(id, &byte);
+		queuePop(id);
+	}
+	et = now();
+	double cqueue_ns = (et - st) * 1e9 / BENCH_ITEMS;
+
+	printf("Push+Pop: spsc %.1f ns, cqueue %.1f ns (x%.1f)\n", spsc_ns, cqueue_ns, cqueue_ns / spsc_ns);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
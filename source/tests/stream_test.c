@@ -0,0 +1,182 @@
+/***************************************************************************//**
+  @file     stream_test.c
+  @brief    Stream Testbench: ADC samples through a simulated serial link
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. stream_test.c ../stream.c ../protocol.c -lm
+            Every frame is decoded on the far end and every sample checked
+            against its position in the sequence, drops included.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+
+#include "serial.h"
+#include "stream.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_TICKS		200000UL												// 10 us each
+#define TEST_QUEUE		8														// Frames the serial port takes at once
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef struct {
+	const char*		name;
+	stream_format_t	format;
+	uint32_t		rate;														// Samples per second
+	uint32_t		baud;
+	double			noise;														// LSBs
+	bool			drops;														// Expected
+} scenario_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const scenario_t scenarios[] = {
+	{ "Smooth, auto",      STREAM_AUTO,   10000,  921600,   2, false },
+	{ "Noisy, auto",       STREAM_AUTO,   10000,  921600, 600, false },
+	{ "Smooth, packed",    STREAM_PACKED, 10000,  921600,   2, false },
+	{ "Noisy, delta",      STREAM_DELTA,  10000,  921600, 600, false },
+	{ "Smooth, slow link", STREAM_AUTO,   20000,  115200,   2, true  },
+	{ "Noisy, slow link",  STREAM_AUTO,   20000,  115200, 600, true  },
+};
+
+static struct {
+	const uchar_t*		data;
+	uint32_t			len;
+	serial_callback_t	cb;
+} queue[TEST_QUEUE];
+static unsigned in, out;
+static uint32_t on_line;														// Bytes of the front frame already sent
+
+static unsigned long next, received, reported, errors;
+static uint8_t seq;
+static double noise;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+// Stubs ///////////////////////////////////////////////////////////////////////
+
+bool serialWriteFrame (const uchar_t* data, uint32_t len, serial_callback_t cb)
+{
+	if (in - out == TEST_QUEUE)
+		return false;
+	queue[in++ % TEST_QUEUE] = (typeof(queue[0])){ data, len, cb };
+
+	return true;
+}
+
+// Simulated ADC and far end ///////////////////////////////////////////////////
+
+static uint16_t sample (unsigned long i)										// Sample i of the sequence
+{
+	uint32_t hash = (uint32_t)i * 2654435761U;
+	double noisy = 2048 + 1800 * sin(i * 0.002) + noise * ((double)(hash >> 16) / 65536 - 0.5);
+
+	return (uint16_t)(noisy < 0 ? 0 : noisy > 4095 ? 4095 : noisy);
+}
+
+static void farEnd (const uchar_t* frame, uint32_t len)
+{
+	uchar_t payload[STREAM_PAYLOAD_MAX];
+	uint16_t samples[STREAM_BLOCK_SAMPLES];
+	stream_header_t header;
+	int32_t size = protocolUnpackBytes(frame, len, payload, sizeof(payload));
+	int16_t count = (size < 0) ? -1 : streamDecode(payload, size, &header, samples);
+
+	if ((count != STREAM_BLOCK_SAMPLES) || (frame[len - 1] != PROTOCOL_DELIM) || (header.seq != seq++))
+	{
+		errors++;
+		return;
+	}
+	next += header.dropped;
+	reported += header.dropped;
+	for (int16_t i = 0; i < count; i++)
+		errors += samples[i] != sample(next++);
+	received += count;
+}
+
+static void link (uint32_t bytes)												// The UART, some bytes per tick
+{
+	while (bytes && (in != out))
+	{
+		uint32_t n = queue[out % TEST_QUEUE].len - on_line;
+		n = n < bytes ? n : bytes;
+		on_line += n;
+		bytes -= n;
+		if (on_line == queue[out % TEST_QUEUE].len)
+		{
+			farEnd(queue[out % TEST_QUEUE].data, on_line);
+			queue[out % TEST_QUEUE].cb(queue[out % TEST_QUEUE].data);
+			on_line = 0;
+			out++;
+		}
+	}
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	unsigned long total = 0;
+
+	for (uint8_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++)
+	{
+		const scenario_t* sc = &scenarios[s];
+		unsigned long produced = 0, before = errors;
+		double samples = 0, bytes = 0;
+		stream_stats_t stats;
+
+		streamInit(sc->format, NULL);
+		in = out = on_line = 0;
+		next = received = reported = 0;
+		seq = 0;
+		noise = sc->noise;
+
+		for (unsigned long t = 0; t < TEST_TICKS; t++)
+		{
+			for (samples += sc->rate / 100000.0; samples >= 1; samples--)		// ADC interrupt
+				streamPush(sample(produced++));
+			for (bytes += sc->baud / 10 / 100000.0; bytes >= 1; bytes--)		// 10 bits per byte
+				link(1);
+			if (!(t % 7))														// Main loop, now and then
+				streamUpdate();
+		}
+
+		stats = streamGetStats();
+		errors += (stats.samples != produced) || (received != (stats.frames - (in - out)) * (unsigned long)STREAM_BLOCK_SAMPLES);	// Some still on the line
+		errors += (reported > stats.dropped) || (received + stats.dropped > produced) ||
+				  (produced - received - stats.dropped > (STREAM_BLOCKS + STREAM_FRAMES + 1) * STREAM_BLOCK_SAMPLES);
+		errors += sc->drops != (stats.dropped != 0);
+		printf("%-18s %6lu samples, %6lu received, %6lu dropped, %.2f bytes/sample, %3.0f%% packed, errors: %lu\n", sc->name,
+			   produced, received, (unsigned long)stats.dropped, (double)stats.bytes / stats.frames / STREAM_BLOCK_SAMPLES,
+			   100.0 * stats.packed / stats.frames, errors - before);
+		total += received;
+	}
+
+	printf("Samples checked: %lu, errors: %lu\n", total, errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+# Trace decoder: turns a trace dump ("!trace" on the serial port, or what the
+# board sends on a fault) into Chrome trace JSON, for chrome://tracing or
+# https://ui.perfetto.dev. One track per context: thread mode and each ISR.
+#
+#   python3 trace_decode.py capture.bin > trace.json
+#
+# The capture may hold anything else around the dump, the last dump in it is
+# decoded. Records are laid out as trace_record_t in trace.h, little endian.
+
+import json
+import struct
+import sys
+
+MAGIC = b"TRC1"
+HEADER = struct.Struct("<IIII")  # magic, hz, count, written
+RECORD = struct.Struct("<IIIBBH")  # time, arg, seq, event, kind, context
+
+EVENTS = [  # trace_event_t, in order
+    "adc_isr",
+    "dma_isr",
+    "gpio_isr",
+    "pdb_isr",
+    "pit_isr",
+    "systick_isr",
+    "uart_update",
+    "queue_full",
+    "spsc_full",
+    "fsm_state",
+    "fault",
+]
+PHASES = ["B", "E", "i"]  # trace_kind_t
+
+CONTEXTS = {  # Exception numbers: 16 + IRQn
+    0: "thread",
+    4: "MemManage",
+    5: "BusFault",
+    6: "UsageFault",
+    15: "SysTick",
+    16 + 31: "UART0",
+    16 + 33: "UART1",
+    16 + 35: "UART2",
+    16 + 37: "UART3",
+    16 + 39: "ADC0",
+    16 + 48: "PIT0",
+    16 + 49: "PIT1",
+    16 + 50: "PIT2",
+    16 + 51: "PIT3",
+    16 + 52: "PDB0",
+    16 + 59: "PORTA",
+    16 + 60: "PORTB",
+    16 + 61: "PORTC",
+    16 + 62: "PORTD",
+    16 + 63: "PORTE",
+    16 + 66: "UART4",
+    16 + 68: "UART5",
+    16 + 73: "ADC1",
+}
+CONTEXTS.update({16 + ch: "DMA%d" % ch for ch in range(16)})
+
+
+def args(name, arg):
+    if name == "fsm_state":
+        return {"event": arg >> 16, "state": arg & 0xFFFF}
+    if name == "fault":
+        return {"cfsr": "0x%08X" % arg}
+    if name == "spsc_full":
+        return {"ring": "0x%08X" % arg}
+    return {"arg": arg}
+
+
+def decode(data):
+    start = data.rfind(MAGIC)
+    if start < 0 or start + HEADER.size > len(data):
+        sys.exit("No trace dump found")
+
+    _, hz, count, written = HEADER.unpack_from(data, start)
+    count = min(count, (len(data) - start - HEADER.size) // RECORD.size)
+    records = [RECORD.unpack_from(data, start + HEADER.size + i * RECORD.size) for i in range(count)]
+
+    events, contexts = [], set()
+    last_seq, last_time, now = 0, None, 0
+    for time, arg, seq, event, kind, context in records:
+        if seq <= last_seq or event >= len(EVENTS) or kind >= len(PHASES):  # Torn while the board wrote it
+            continue
+        last_seq = seq
+        if last_time is not None:
+            now += ((time - last_time + 0x80000000) & 0xFFFFFFFF) - 0x80000000  # Wraps, and nested ISRs may stamp slightly out of order
+        last_time = time
+
+        name = EVENTS[event]
+        entry = {"name": name, "ph": PHASES[kind], "ts": now * 1e6 / hz, "pid": 0, "tid": context, "args": args(name, arg)}
+        if PHASES[kind] == "i":
+            entry["s"] = "t"
+        events.append(entry)
+        contexts.add(context)
+
+    for context in sorted(contexts):
+        events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": context,
+                       "args": {"name": CONTEXTS.get(context, "exception %d" % context)}})
+        events.append({"name": "thread_sort_index", "ph": "M", "pid": 0, "tid": context, "args": {"sort_index": context}})
+
+    sys.stderr.write("%d of %d records, %d written, %d Hz\n" % (len([e for e in events if e["ph"] != "M"]), count, written, hz))
+
+    return {"traceEvents": events, "displayTimeUnit": "ns", "otherData": {"hz": hz, "written": written}}
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        sys.exit("Usage: trace_decode.py capture.bin > trace.json")
+    with open(sys.argv[1], "rb") as capture:
+        json.dump(decode(capture.read()), sys.stdout, indent=1)
@@ -0,0 +1,199 @@
+/***************************************************************************//**
+  @file     trace_test.c
+  @brief    Trace Testbench: record order, ring wrap, partial dumps and
+            concurrent writers
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -DTRACE_EVENTS=1 -I.. trace_test.c ../trace.c -lpthread
+            Threads stand in for nested ISRs, writing while the main thread
+            dumps: every record dumped has to be whole and in order. Run
+            with a file name to save the first dump for trace_decode.py.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "trace.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_THREADS	4
+#define TEST_RECORDS	1000000UL												// Per thread, under 2^24
+#define TEST_BENCH		10000000UL
+#define TEST_PARTIAL	5
+
+#define ARG(t, i)		(((uint32_t)(t) << 24) | (uint32_t)(i))
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const struct {
+	trace_event_t	event;
+	trace_kind_t	kind;
+	uint32_t		arg;
+} script[] = {																	// A SysTick with a UART interrupt inside, a queue filling up
+	{ TRACE_SYSTICK_ISR, TRACE_KIND_BEGIN, 0 },
+	{ TRACE_UART_UPDATE, TRACE_KIND_BEGIN, 0 },
+	{ TRACE_QUEUE_FULL, TRACE_KIND_MARK, 3 },
+	{ TRACE_UART_UPDATE, TRACE_KIND_END, 0 },
+	{ TRACE_FSM_STATE, TRACE_KIND_MARK, (2UL << 16) | 1 },
+	{ TRACE_SYSTICK_ISR, TRACE_KIND_END, 0 },
+	{ TRACE_PIT_ISR, TRACE_KIND_BEGIN, 2 },
+	{ TRACE_PIT_ISR, TRACE_KIND_END, 2 },
+};
+
+static uint8_t dump[sizeof(trace_header_t) + TRACE_RECORDS * sizeof(trace_record_t)];
+static volatile bool writing;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void* writer (void* arg)
+{
+	size_t t = (size_t)arg;
+
+	for (unsigned long i = 0; i < TEST_RECORDS; i++)
+		traceRecord(TRACE_SPSC_FULL, TRACE_KIND_MARK, ARG(t, i));
+
+	return NULL;
+}
+
+static unsigned long parse (size_t len, trace_header_t* header, trace_record_t* records)
+{
+	unsigned long errors = len < sizeof(*header);
+
+	if (!errors)
+	{
+		memcpy(header, dump, sizeof(*header));
+		memcpy(records, dump + sizeof(*header), len - sizeof(*header));
+		errors += (header->magic != TRACE_MAGIC) || (header->hz != TRACE_HZ) || (len != sizeof(*header) + header->count * sizeof(*records));
+		for (uint32_t i = 1; i < header->count; i++)
+			errors += records[i].seq <= records[i - 1].seq;						// Gaps are records left out, never reordered
+	}
+
+	return errors;
+}
+
+static unsigned long check (const trace_header_t* header, const trace_record_t* records, uint32_t* last)
+{
+	unsigned long errors = 0;
+	uint32_t t, i;
+
+	for (uint32_t r = 0; r < header->count; r++)
+	{
+		t = records[r].arg >> 24;
+		i = records[r].arg & 0xFFFFFF;
+		errors += (records[r].event != TRACE_SPSC_FULL) || (records[r].kind != TRACE_KIND_MARK) || (t >= TEST_THREADS) || (i >= TEST_RECORDS);
+		if (t < TEST_THREADS)
+		{
+			errors += (last[t] != UINT32_MAX) && (i <= last[t]);				// Each thread's own in its order
+			last[t] = i;
+		}
+	}
+
+	return errors;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (int argc, char* argv[])
+{
+	static trace_record_t records[TRACE_RECORDS];
+	pthread_t threads[TEST_THREADS];
+	trace_header_t header;
+	unsigned long errors = 0, before, dumps = 0, records_seen = 0;
+	uint32_t count = sizeof(script) / sizeof(script[0]), last[TEST_THREADS];
+	size_t len;
+	FILE* file;
+	struct timespec begin, end;
+	double spent;
+
+	traceInit(NULL);															// Recorded as written
+	for (uint32_t i = 0; i < count; i++)
+		traceRecord(script[i].event, script[i].kind, script[i].arg);
+	len = traceDump(dump, sizeof(dump));
+	errors += parse(len, &header, records) || (header.count != count) || (header.written != count);
+	for (uint32_t i = 0; (i < count) && (i < header.count); i++)
+	{
+		errors += (records[i].event != script[i].event) || (records[i].kind != script[i].kind) || (records[i].arg != script[i].arg);
+		errors += (records[i].seq != i + 1) || (i && ((int32_t)(records[i].time - records[i - 1].time) < 0));
+	}
+	if ((argc > 1) && (file = fopen(argv[1], "wb")))
+	{
+		fwrite(dump, 1, len, file);
+		fclose(file);
+	}
+	printf("Order: %u records, %zu bytes, errors: %lu\n", header.count, len, errors);
+	before = errors;
+
+	for (uint32_t i = 0; i < 3 * TRACE_RECORDS; i++)							// The ring keeps the latest
+		traceRecord(TRACE_DMA_ISR, TRACE_KIND_MARK, i);
+	len = traceDump(dump, sizeof(dump));
+	errors += parse(len, &header, records) || (header.count != TRACE_RECORDS) || (header.written != count + 3 * TRACE_RECORDS);
+	for (uint32_t i = 0; i < header.count; i++)
+		errors += records[i].arg != 2 * TRACE_RECORDS + i;
+	len = traceDump(dump, sizeof(header) + TEST_PARTIAL * sizeof(trace_record_t) + sizeof(trace_record_t) - 1);
+	errors += parse(len, &header, records) || (header.count != TEST_PARTIAL) || (records[TEST_PARTIAL - 1].arg != 3 * TRACE_RECORDS - 1);
+	errors += traceDump(dump, sizeof(header) - 1) != 0;
+	traceReset();
+	len = traceDump(dump, sizeof(dump));
+	errors += parse(len, &header, records) || header.count || header.written;
+	traceRecord(TRACE_FAULT, TRACE_KIND_MARK, 0);
+	len = traceDump(dump, sizeof(dump));
+	errors += parse(len, &header, records) || (header.count != 1) || (records[0].event != TRACE_FAULT);
+	printf("Wrap: %u records kept, %d of them in a cut dump, errors: %lu\n", TRACE_RECORDS, TEST_PARTIAL, errors - before);
+	before = errors;
+
+	traceReset();																// Dumps while the writers run
+	for (size_t t = 0; t < TEST_THREADS; t++)
+		pthread_create(&threads[t], NULL, writer, (void*)t);
+	writing = true;
+	while (writing)
+	{
+		for (size_t t = 0; t < TEST_THREADS; t++)
+			last[t] = UINT32_MAX;
+		len = traceDump(dump, sizeof(dump));
+		errors += parse(len, &header, records) || check(&header, records, last);
+		dumps++;
+		records_seen += header.count;
+		writing = header.written < TEST_THREADS * TEST_RECORDS;
+	}
+	for (size_t t = 0; t < TEST_THREADS; t++)
+		pthread_join(threads[t], NULL);
+	for (size_t t = 0; t < TEST_THREADS; t++)
+		last[t] = UINT32_MAX;
+	len = traceDump(dump, sizeof(dump));
+	errors += parse(len, &header, records) || check(&header, records, last) || (header.count != TRACE_RECORDS) || (header.written != TEST_THREADS * TEST_RECORDS);
+	printf("Threads: %d x %lu records, %lu dumps meanwhile, %.1f records each, errors: %lu\n",
+		   TEST_THREADS, TEST_RECORDS, dumps, (double)records_seen / dumps, errors - before);
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	for (unsigned long i = 0; i < TEST_BENCH; i++)
+		traceRecord(TRACE_ADC_ISR, TRACE_KIND_BEGIN, i);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	spent = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+	printf("Cost: %.1f ns per record\n", 1e9 * spent / TEST_BENCH);
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,140 @@
+/***************************************************************************//**
+  @file     uart_baud_test.c
+  @brief    UART Testbench: baud rate divisor solver, every rate of both clocks
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -DCPU_MK64FN1M0VLL12 -Imock -I.. -I../../SDK/startup -I../../SDK/CMSIS
+                        uart_baud_test.c ../uart.c ../cqueue.c ../dmaring.c -lm
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+
+#include "dma.h"
+#include "hardware.h"
+#include "pisr.h"
+#include "uart.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define DIVISOR_MAX		((UART_SBR_MAX << 5) | 0x1F)							// In 1/32 steps
+
+/*******************************************************************************
+ * GLOBAL VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+SIM_Type mockSIM;
+PORT_Type mockPORT[5];
+UART_Type mockUART[6];
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const uint32_t clocks[] = { __CORE_CLOCK__, __CORE_CLOCK__ >> 1 };		// UART0/1, UART2-5
+static const uint32_t rates[] = { 9600, 115200, 230400, 460800, 921600, 1000000, 1500000, 2000000, 3000000 };
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+// Stubs ///////////////////////////////////////////////////////////////////////
+
+bool pisrRegisterHz (pisr_callback_t fun, uint32_t hz) { return true; }
+
+bool DMA_Init (dma_channel_t ch, dma_cfg_t cfg) { return false; }
+void DMA_SetTransfer (dma_channel_t ch, uint32_t saddr, uint32_t daddr, uint16_t count) {}
+void DMA_Start (dma_channel_t ch) {}
+uint16_t DMA_GetCount (dma_channel_t ch) { return 0; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+static double rate (uint32_t clock, uint32_t divisor)							// Exact generator output
+{
+	return 2.0 * clock / divisor;
+}
+
+static double best (uint32_t clock, uint32_t br)								// Reference: smallest error of any divisor, -1 if none
+{
+	double exact = 2.0 * clock / br, error, min = -1;
+
+	for (long d = (long)exact - 1; d <= (long)exact + 2; d++)
+		if ((d >= 32) && (d <= DIVISOR_MAX))
+		{
+			error = fabs(rate(clock, d) - br) / br;
+			if ((min < 0) || (error < min))
+				min = error;
+		}
+
+	return min;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	unsigned long errors = 0, checked = 0;
+
+	for (uint8_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++)
+	{
+		uint32_t clock = clocks[c], max = clock / 16 + 1000, min = 0;
+		double worst = 0;
+
+		for (uint32_t br = 1; br <= max; br++)
+		{
+			uart_baud_t solution = uartSolveBaudRate(clock, br);
+			double reference = best(clock, br);
+			uint32_t divisor = (solution.sbr << 5) | solution.brfa;
+
+			checked++;
+			if (reference < 0)
+			{
+				errors += solution.baudrate != 0;								// Out of range must be reported
+				continue;
+			}
+			if (!solution.baudrate || (solution.sbr == 0) || (solution.brfa > 0x1F))
+			{
+				errors++;
+				continue;
+			}
+
+			double error = fabs(rate(clock, divisor) - br) / br;
+			errors += error > reference * (1 + 1e-9);							// Not the closest divisor
+			errors += fabs(rate(clock, divisor) - solution.baudrate) > 0.5;	// Achieved rate misreported
+			errors += fabs(100.0 * (rate(clock, divisor) - br) / br - solution.error) > 1e-4;
+			if ((br >= 1200) && (br <= 3000000) && (error > worst))
+				worst = error;
+			if (!min)
+				min = br;
+		}
+
+		printf("Clock %lu Hz: range %lu..%lu baud, worst error 1200..3000000 baud %.3f%%\n", (unsigned long)clock,
+			   (unsigned long)min, (unsigned long)clock / 16, 100 * worst);
+		for (uint8_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+		{
+			uart_baud_t solution = uartSolveBaudRate(clock, rates[r]);
+			printf("  %8lu -> SBR %4u BRFA %2u: %8lu baud (%+.3f%%)\n", (unsigned long)rates[r], solution.sbr, solution.brfa,
+				   (unsigned long)solution.baudrate, solution.error);
+		}
+	}
+
+	printf("Rates checked: %lu, errors: %lu\n", checked, errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -0,0 +1,234 @@
+/***************************************************************************//**
+  @file     uart_test.c
+  @brief    UART Testbench: every port at once over a mocked register file
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -DCPU_MK64FN1M0VLL12 -Imock -I.. -I../../SDK/startup -I../../SDK/CMSIS
+                        uart_test.c ../uart.c ../cqueue.c ../dmaring.c -lpthread
+            UART0-3 run in IRQ mode, each vector hammered by its own thread
+            (nested, unrelated interrupts); UART4-5 are polled by the PISR.
+            Tx goes through the byte queue first, then zero-copy descriptors.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "dma.h"
+#include "hardware.h"
+#include "pisr.h"
+#include "uart.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_BYTES		200000UL												// Per port and direction
+#define TEST_TIMEOUT_S	60
+#define TEST_IRQ_IDS	4
+#define TEST_FRAMES		2000UL													// Per port, after TEST_BYTES
+#define TEST_FRAME_LEN	333U
+#define TEST_TX_BYTES	(TEST_BYTES + TEST_FRAMES * TEST_FRAME_LEN)
+
+#define RX_BYTE(n)		((uchar_t)((n) & 0x7F))									// Rx and Tx share D, keep them apart
+#define TX_BYTE(n)		((uchar_t)(0x80 | ((n) & 0x7F)))
+#define RX_FIFO(id, n)	(*(volatile uint8_t*)&mockUART[id].RCFIFO = (n))		// Read-only for the driver
+
+/*******************************************************************************
+ * GLOBAL VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+SIM_Type mockSIM;
+PORT_Type mockPORT[5];
+UART_Type mockUART[6];
+
+void UART0_RX_TX_IRQHandler (void);
+void UART1_RX_TX_IRQHandler (void);
+void UART2_RX_TX_IRQHandler (void);
+void UART3_RX_TX_IRQHandler (void);
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static void (* const vectors[TEST_IRQ_IDS])(void) = { UART0_RX_TX_IRQHandler, UART1_RX_TX_IRQHandler,
+													  UART2_RX_TX_IRQHandler, UART3_RX_TX_IRQHandler };
+
+static pisr_callback_t pisr;
+static unsigned pisr_registrations;
+
+static volatile unsigned long rx_sent[UART_CANT_IDS], tx_seen[UART_CANT_IDS];
+static volatile unsigned long frames_done[UART_CANT_IDS];
+static uchar_t frames[UART_CANT_IDS][UART_DESC_CANT][TEST_FRAME_LEN];
+static volatile unsigned long errors;
+static volatile bool timeout;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+// Stubs ///////////////////////////////////////////////////////////////////////
+
+bool pisrRegisterHz (pisr_callback_t fun, uint32_t hz) { pisr = fun; pisr_registrations++; return true; }
+
+bool DMA_Init (dma_channel_t ch, dma_cfg_t cfg) { return false; }
+void DMA_SetTransfer (dma_channel_t ch, uint32_t saddr, uint32_t daddr, uint16_t count) {}
+void DMA_Start (dma_channel_t ch) {}
+uint16_t DMA_GetCount (dma_channel_t ch) { return 0; }
+
+// Mock hardware ///////////////////////////////////////////////////////////////
+
+static bool hwRequest (uart_id_t id)											// Latch a received byte, true if an IRQ is due
+{
+	bool rx = (rx_sent[id] < TEST_BYTES) && (uartGetRxMsgLength(id) < UART_BUFFER_SIZE);
+
+	mockUART[id].D = RX_BYTE(rx_sent[id]);
+	RX_FIFO(id, rx);
+
+	return rx || (mockUART[id].C2 & UART_C2_TIE_MASK);
+}
+
+static void hwCheck (uart_id_t id)												// After the ISR: the FIFO was drained, collect the Tx byte
+{
+	rx_sent[id] += mockUART[id].RCFIFO;
+	RX_FIFO(id, 0);
+
+	if (mockUART[id].D & 0x80)
+		errors += mockUART[id].D != TX_BYTE(tx_seen[id]++);
+}
+
+static bool done (uart_id_t id)
+{
+	return (rx_sent[id] >= TEST_BYTES) && (tx_seen[id] >= TEST_TX_BYTES);
+}
+
+static void frameDone (uart_id_t id, const uchar_t* msg)						// From the ISR, the slot can be reused
+{
+	errors += msg != frames[id][frames_done[id] % UART_DESC_CANT];
+	frames_done[id]++;
+}
+
+static unsigned long writeFrames (uart_id_t id, unsigned long queued)
+{
+	unsigned long first = (queued - TEST_BYTES) / TEST_FRAME_LEN, frame;
+
+	for (frame = first; (frame < TEST_FRAMES) && (frame - frames_done[id] < UART_DESC_CANT); frame++)
+	{
+		uchar_t* slot = frames[id][frame % UART_DESC_CANT];
+		for (uint16_t i = 0; i < TEST_FRAME_LEN; i++)
+			slot[i] = TX_BYTE(queued + (frame - first) * TEST_FRAME_LEN + i);
+		if (!uartWriteDesc(id, slot, TEST_FRAME_LEN, frameDone))
+			break;
+	}
+
+	return (frame - first) * TEST_FRAME_LEN;
+}
+
+static void* irqThread (void* arg)
+{
+	uart_id_t id = (uart_id_t)(long)arg;
+
+	while (!done(id) && !timeout)
+	{
+		if (hwRequest(id))
+		{
+			vectors[id]();
+			hwCheck(id);
+		}
+		sched_yield();
+	}
+
+	return NULL;
+}
+
+static void* pisrThread (void* arg)
+{
+	while (!(done(UART4_ID) && done(UART5_ID)) && !timeout)
+	{
+		hwRequest(UART4_ID);
+		hwRequest(UART5_ID);
+		pisr();
+		hwCheck(UART4_ID);
+		hwCheck(UART5_ID);
+		sched_yield();
+	}
+
+	return NULL;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	uart_cfg_t config = { 115200, UART_MODE_8, UART_PARITY_NONE, UART_STOPS_1, UART_RX_TX_ENABLED, UART_FIFO_DISABLED, UART_ISR_IRQ };
+	unsigned long rx_recv[UART_CANT_IDS] = { 0 }, tx_queued[UART_CANT_IDS] = { 0 };
+	uchar_t buffer[UART_BUFFER_SIZE];
+	pthread_t threads[TEST_IRQ_IDS + 1];
+	time_t start = time(NULL);
+	bool finished = false;
+
+	for (uart_id_t id = UART0_ID; id < UART_CANT_IDS; id++)
+	{
+		for (uint8_t i = 0; i < sizeof(mockUART[id]); i++)
+			((volatile uint8_t*)&mockUART[id])[i] = 0;
+		config.isr = (id < TEST_IRQ_IDS) ? UART_ISR_IRQ : UART_ISR_PERIODIC;
+		if (!uartInit(id, config))
+			errors++;
+	}
+
+	for (long i = 0; i < TEST_IRQ_IDS; i++)
+		pthread_create(&threads[i], NULL, irqThread, (void*)i);
+	pthread_create(&threads[TEST_IRQ_IDS], NULL, pisrThread, NULL);
+
+	while (!finished && !timeout)												// Application side, all ports interleaved
+	{
+		finished = true;
+		for (uart_id_t id = UART0_ID; id < UART_CANT_IDS; id++)
+		{
+			uint8_t count = uartReadMsg(id, buffer, sizeof(buffer));
+			for (uint8_t i = 0; i < count; i++)
+				errors += buffer[i] != RX_BYTE(rx_recv[id]++);
+
+			if (tx_queued[id] < TEST_BYTES)
+			{
+				for (count = 0; (count < sizeof(buffer)) && (tx_queued[id] + count < TEST_BYTES); count++)
+					buffer[count] = TX_BYTE(tx_queued[id] + count);
+				tx_queued[id] += uartWriteMsg(id, buffer, count);
+			}
+			else
+				tx_queued[id] += writeFrames(id, tx_queued[id]);
+
+			finished = finished && done(id) && (rx_recv[id] == TEST_BYTES) && uartIsTxMsgComplete(id);
+		}
+		timeout = time(NULL) - start > TEST_TIMEOUT_S;
+		sched_yield();
+	}
+
+	for (uint8_t i = 0; i <= TEST_IRQ_IDS; i++)
+		pthread_join(threads[i], NULL);
+
+	errors += pisr_registrations != 1;
+	for (uart_id_t id = UART0_ID; id < UART_CANT_IDS; id++)
+	{
+		errors += frames_done[id] != TEST_FRAMES;
+		printf("UART%d: rx %lu, tx %lu (%lu frames)\n", id, rx_recv[id], tx_seen[id], frames_done[id]);
+	}
+	printf("PISR registrations: %u, timeout: %s, errors: %lu\n", pisr_registrations, timeout ? "yes" : "no", errors);
+
+	return (errors != 0) || timeout;
+}
+
+/******************************************************************************/
@@ -0,0 +1,203 @@
+/***************************************************************************//**
+  @file     wheel_test.c
+  @brief    Timing Wheel Testbench: random timers on simulated time
+  @author   Group 4: - Oms, Mariano
+					 - Solari Raigoso, Agustín
+					 - Wickham, Tomás
+					 - Vieira, Valentin Ulises
+  @note     Host build: gcc -O2 -I.. wheel_test.c ../wheel.c
+            Every expiration is checked against the tick it was due at,
+            and every running timer against not having been missed.
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "wheel.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TEST_TIMERS		500
+#define TEST_STEPS		50000UL
+#define TEST_BENCH		2000000UL												// Ticks, one at a time
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef struct {																// Reference for each timer
+	bool			running;
+	uint32_t		expires;													// As started, plus the periods gone
+	uint32_t		due;														// Tick it should run at
+	uint32_t		period;
+	unsigned long	fired;
+} model_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static wheel_t wheel;
+static wheel_timer_t timers[TEST_TIMERS];
+static model_t model[TEST_TIMERS];
+static uint32_t now;
+static unsigned long errors, fired, late, early, meddled;
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static uint32_t delay (void)													// Mostly short, now and then past the wheel's range
+{
+	switch (rand() % 8)
+	{
+		case 0:		return 0;
+		case 1:		return rand() % (1U << 12);
+		case 2:		return rand() % (1U << 20);
+		case 3:		return (rand() % 16) ? rand() % (1U << 16) : WHEEL_RANGE + rand() % (1U << 20);
+		default:	return 1 + rand() % 64;
+	}
+}
+
+static void start (uint16_t i, uint32_t from);
+
+static void expired (void* arg)
+{
+	uint16_t i = (uint16_t)(size_t)arg;
+	uint32_t tick = wheel.now - 1;												// The tick being run
+
+	errors += !model[i].running;
+	late += (int32_t)(tick - model[i].due) > 0;
+	early += (int32_t)(tick - model[i].due) < 0;
+	model[i].fired++;
+	fired++;
+	if (model[i].period)
+	{
+		model[i].expires += model[i].period;
+		model[i].due = ((int32_t)(model[i].expires - wheel.now) < 0) ? wheel.now : model[i].expires;
+	}
+	else
+		model[i].running = false;
+
+	if (!(rand() % 16))															// Meddle: restart or cancel another, maybe in this very slot
+	{
+		uint16_t j = rand() % TEST_TIMERS;
+
+		if (rand() & 1)
+			start(j, wheel.now);
+		else
+		{
+			errors += wheelCancel(&wheel, &timers[j]) != model[j].running;
+			model[j].running = false;
+		}
+		meddled++;
+	}
+}
+
+static void start (uint16_t i, uint32_t from)
+{
+	uint32_t after = delay(), period = (rand() % 3) ? 0 : 1 + delay() % 5000;
+
+	wheelStart(&wheel, &timers[i], from + after, period, expired, (void*)(size_t)i);
+	model[i] = (model_t){ true, from + after, from + after, period, model[i].fired };
+	if ((int32_t)(model[i].due - wheel.now) < 0)								// Past: the next tick run
+		model[i].due = wheel.now;
+}
+
+static void counter (void* arg)
+{
+	(*(unsigned long*)arg)++;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+int main (void)
+{
+	unsigned long missed = 0, calls = 0, expected = 0, ticks = 0;
+	wheel_timer_t bench[TEST_TIMERS] = { 0 }, once = { 0 };
+	clock_t begin;
+	double spent;
+
+	srand(1);
+	now = 0xFFFF0000U;															// Wraps halfway
+	wheelInit(&wheel, now);
+	for (uint16_t i = 0; i < TEST_TIMERS; i++)
+		start(i, now);
+
+	for (unsigned long step = 0; step < TEST_STEPS; step++)
+	{
+		now += (rand() % 100) ? rand() % 64 : rand() % 20000;					// Main loop late now and then
+		wheelAdvance(&wheel, now);
+		ticks++;
+
+		for (uint16_t i = 0; i < TEST_TIMERS; i++)
+		{
+			missed += model[i].running && ((int32_t)(model[i].due - now) <= 0);
+			errors += wheelRunning(&timers[i]) != model[i].running;
+		}
+		if (!(rand() % 4))
+		{
+			uint16_t i = rand() % TEST_TIMERS;
+
+			if (rand() % 4)
+				start(i, now);
+			else
+			{
+				errors += wheelCancel(&wheel, &timers[i]) != model[i].running;
+				model[i].running = false;
+			}
+		}
+		if ((int32_t)(wheelNext(&wheel) - now) <= 0)
+			errors++;																// Everything up to now was run
+	}
+	for (uint16_t i = 0; i < TEST_TIMERS; i++)
+		expected += model[i].running;
+	errors += missed || late || early || (wheel.count != expected);
+	printf("Random: %lu advances, %lu expirations, %lu restarts or cancels from callbacks, %lu late, %lu early, %lu missed, errors: %lu\n",
+		   ticks, fired, meddled, late, early, missed, errors);
+
+	wheelInit(&wheel, 0);														// Zero and past delays: the next tick run
+	wheelStart(&wheel, &once, 0, 0, counter, &calls);
+	errors += (wheelAdvance(&wheel, 0) != 1) || calls != 1 || wheelRunning(&once);
+	wheelStart(&wheel, &once, 5, 0, counter, &calls);
+	errors += wheelAdvance(&wheel, 4) || (wheelNext(&wheel) != 5) || (wheelAdvance(&wheel, 100) != 1);
+	wheelStart(&wheel, &once, 50, 0, counter, &calls);
+	errors += !wheelCancel(&wheel, &once) || wheelCancel(&wheel, &once) || wheelAdvance(&wheel, 1000) || wheel.count;
+	printf("One-shot: %lu calls, errors: %lu\n", calls, errors);
+
+	for (uint32_t period = 2000; period <= 200000; period *= 100)				// Cost per tick, hundreds of periodic timers
+	{
+		wheelInit(&wheel, 0);
+		calls = 0;
+		for (uint16_t i = 0; i < TEST_TIMERS; i++)
+		{
+			bench[i] = (wheel_timer_t){ 0 };										// Nothing to do with the last wheel
+			wheelStart(&wheel, &bench[i], 1 + rand() % period, period / 2 + rand() % period, counter, &calls);
+		}
+		begin = clock();
+		for (uint32_t t = 0; t < TEST_BENCH; t++)
+			wheelAdvance(&wheel, t);
+		spent = (double)(clock() - begin) / CLOCKS_PER_SEC;
+		printf("Cost: %u timers every %6u ticks or so, %7lu expirations in %lu ticks, %.1f ns per tick\n",
+			   TEST_TIMERS, period, calls, TEST_BENCH, 1e9 * spent / TEST_BENCH);
+		errors += !calls;
+	}
+	printf("Errors: %lu\n", errors);
+
+	return errors != 0;
+}
+
+/******************************************************************************/
@@ -1,6 +1,6 @@
 /***************************************************************************//**
   @file     timer.c
-  @brief    Timer driver. Simple implementation, support multiple timers
+  @brief    Timer driver. Tick counter, and callback timers on a timing wheel
   @author   Group 4: - Oms, Mariano
                      - Solari Raigoso, Agustín
                      - Wickham, Tomás
@@ -12,9 +12,17 @@
  * INCLUDE HEADER FILES
  ******************************************************************************/
 
+#include <stddef.h>
+
 #include "debug.h"
-#include "pisr.h"
+#include "hardware.h"
 #include "timer.h"
+#include "wheel.h"
+#if TIMER_TICKLESS
+#include "clock.h"
+#else
+#include "pisr.h"
+#endif
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -25,20 +33,54 @@
 #define TIMER_FREQUENCY_HZ		(1000000/TIMER_TICK_US)
 #define TIMER_TICKS2MS(ticks)	((ticks)*TIMER_TICK_US/1000)
 
+#if TIMER_TICKLESS
+#define TIMER_TICK_COUNTS		CLOCK_US2COUNTS(TIMER_TICK_US)
+#define TIMER_NOW()				((ticks_t)(clockNow() / TIMER_TICK_COUNTS))
+#else
+#define TIMER_NOW()				(timer_main_counter)
+#endif
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
+#if TIMER_TICKLESS
+/**
+ * @brief Deadline service, the wheel has work
+ * @param arg Unused
+ */
+static void timer_isr(void* arg);
+
+/**
+ * @brief Deadline service, timerDelay is over
+ * @param arg Unused
+ */
+static void timer_wakeup(void* arg);
+#else
 /**
  * @brief Periodic service
  */
 static void timer_isr(void);
+#endif
+
+/**
+ * @brief Let the tick interrupt know when the wheel next has work
+ */
+static void timer_rewake(void);
 
 /*******************************************************************************
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
+#if TIMER_TICKLESS
+static ticks_t timer_mark;
+static deadline_t timer_deadline;                                               // First tick the wheel has work at
+#else
 static volatile ticks_t timer_main_counter, timer_mark;
+static volatile ticks_t timer_wake;											// First tick the wheel has work at
+#endif
+static void (* timer_notify)(void);
+static wheel_t wheel;															// Only touched from the main loop
 
 /*******************************************************************************
  *******************************************************************************
@@ -46,13 +88,21 @@ static volatile ticks_t timer_main_counter, timer_mark;
  *******************************************************************************
  ******************************************************************************/
 
-void timerInit(void)
+void timerInit(void (* notify)(void))
 {
     static bool yaInit = false;
     if (yaInit)
         return;
     
-    pisrRegister(timer_isr, PISR_FREQUENCY_HZ / TIMER_FREQUENCY_HZ); // init peripheral
+    timer_notify = notify;
+#if TIMER_TICKLESS
+    clockInit(); // init peripheral, nothing periodic
+#endif
+    wheelInit(&wheel, TIMER_NOW());
+    timer_rewake();
+#if !TIMER_TICKLESS
+    pisrRegisterHz(timer_isr, TIMER_FREQUENCY_HZ); // init peripheral
+#endif
     
     yaInit = true;
 }
@@ -65,7 +115,7 @@ ticks_t timerStart(ticks_t ticks)
         ticks = 0; // truncate min wait time
     
     //disable_interrupts();
-    now_copy = timer_main_counter; // esta copia debe ser atomic!!
+    now_copy = TIMER_NOW(); // esta copia debe ser atomic!!
     //enable_interrupts();
 
     now_copy += ticks;
@@ -78,7 +128,7 @@ bool timerExpired(ticks_t timeout)
     ticks_t now_copy;
 
     //disable_interrupts();
-    now_copy = timer_main_counter; // esta copia debe ser atomic!!
+    now_copy = TIMER_NOW(); // esta copia debe ser atomic!!
     //enable_interrupts();
 
     now_copy -= timeout;
@@ -90,17 +140,54 @@ void timerDelay(ticks_t ticks)
     ticks_t tim;
     
     tim = timerStart(ticks);
+#if TIMER_TICKLESS
+    static deadline_t delay;
+
+    clockAt(&delay, clockNow() + (uint64_t)(ticks > 0 ? ticks : 0) * TIMER_TICK_COUNTS, timer_wakeup, NULL); // no ticks: a deadline wakes it up
+#endif
     while (!timerExpired(tim))
-    {
-        // wait...
-    }
+        __WFI(); // sleep, the next tick wakes it up
+}
+
+void timerOnce(wheel_timer_t* timer, ticks_t ticks, wheel_callback_t callback, void* arg)
+{
+    wheelStart(&wheel, timer, timerStart(ticks), 0, callback, arg);
+    timer_rewake();
+}
+
+void timerEvery(wheel_timer_t* timer, ticks_t period, wheel_callback_t callback, void* arg)
+{
+    if (period < 1)
+        period = 1;
+    wheelStart(&wheel, timer, timerStart(period), period, callback, arg);
+    timer_rewake();
+}
+
+bool timerCancel(wheel_timer_t* timer)
+{
+    bool running = wheelCancel(&wheel, timer);
+
+    timer_rewake();                                                             // Later, or none: at worst one extra wake-up
+
+    return running;
+}
+
+bool timerRunning(const wheel_timer_t* timer)
+{
+    return wheelRunning(timer);
+}
+
+void timerUpdate(void)
+{
+    wheelAdvance(&wheel, TIMER_NOW());                                          // Every tick since the last update, in order
+    timer_rewake();
 }
 
 uint32_t timerCounter(void)
 {
-	ticks_t diff = timer_main_counter-timer_mark;
+	ticks_t now = TIMER_NOW(), diff = now-timer_mark;
 
-	timer_mark = timer_main_counter;
+	timer_mark = now;
 
 	return TIMER_TICKS2MS(diff);
 }
@@ -111,15 +198,60 @@ uint32_t timerCounter(void)
  *******************************************************************************
  ******************************************************************************/
 
+#if TIMER_TICKLESS
+static void timer_isr(void* arg)
+{
+    (void)arg;
+#if DEBUG_TIMER
+P_DEBUG_TP_SET
+#endif
+    timer_notify(); // the deadline is only set when the wheel has work
+#if DEBUG_TIMER
+P_DEBUG_TP_CLR
+#endif
+}
+
+static void timer_wakeup(void* arg)
+{
+    (void)arg;
+    // Nothing to do, the interrupt alone ends the WFI
+}
+
+static void timer_rewake(void)
+{
+    uint64_t now;
+    ticks_t ahead;
+
+    if (!timer_notify || !wheel.count)
+    {
+        clockCancel(&timer_deadline);
+        return;
+    }
+
+    now = clockNow() / TIMER_TICK_COUNTS;
+    ahead = (ticks_t)(wheelNext(&wheel) - (uint32_t)now); // ticks wrap, the clock does not
+    if (ahead < 0)
+        ahead = 0; // already due: right away
+    clockAt(&timer_deadline, (now + ahead) * TIMER_TICK_COUNTS, timer_isr, NULL);
+}
+#else
 static void timer_isr(void)
 {
 #if DEBUG_TIMER
 P_DEBUG_TP_SET
 #endif
     ++timer_main_counter; // update main counter
+    if (timer_notify && (ticks_t)((uint32_t)timer_main_counter - (uint32_t)timer_wake) >= 0)
+        timer_notify(); // only ticks with work wake the main loop up
 #if DEBUG_TIMER
 P_DEBUG_TP_CLR
 #endif
 }
 
+static void timer_rewake(void)
+{
+    timer_wake = wheelNext(&wheel);
+}
+#endif
+
 /******************************************************************************/
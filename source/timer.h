@@ -1,6 +1,6 @@
 /***************************************************************************//**
   @file     timer.h
-  @brief    Timer driver. Simple implementation, support multiple timers.
+  @brief    Timer driver. Tick counter, and callback timers on a timing wheel.
   @author   Group 4: - Oms, Mariano
                      - Solari Raigoso, Agustín
                      - Wickham, Tomás
@@ -18,6 +18,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "wheel.h"
+
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
@@ -25,6 +27,10 @@
 #define TIMER_TICK_US       500
 #define TIMER_MS2TICKS(ms)	((ms)*1000/TIMER_TICK_US)
 
+#ifndef TIMER_TICKLESS
+#define TIMER_TICKLESS      1   // Ticks read off the free-running clock, interrupts only when the wheel has work
+#endif
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
@@ -37,8 +43,48 @@ typedef int32_t ticks_t;
 
 /**
  * @brief Initialice timer and corresponding peripheral
+ * @param notify Called from the tick (or deadline) interrupt when timerUpdate has timers to run, NULL to poll
+ */
+void timerInit(void (* notify)(void));
+
+// Callback services ///////////////////////////////////////////////////////////
+
+/**
+ * @brief Call back once, after a delay
+ * @param timer Timer, zeroed (static) before its first start, restarted if running
+ * @param ticks Delay in ticks
+ * @param callback Called from timerUpdate
+ * @param arg Callback argument
+ */
+void timerOnce(wheel_timer_t* timer, ticks_t ticks, wheel_callback_t callback, void* arg);
+
+/**
+ * @brief Call back periodically, the first time one period from now
+ * @param timer Timer, zeroed (static) before its first start, restarted if running
+ * @param period Period in ticks, at least 1
+ * @param callback Called from timerUpdate
+ * @param arg Callback argument
+ */
+void timerEvery(wheel_timer_t* timer, ticks_t period, wheel_callback_t callback, void* arg);
+
+/**
+ * @brief Stop a timer
+ * @param timer Timer
+ * @return It was running
+ */
+bool timerCancel(wheel_timer_t* timer);
+
+/**
+ * @brief Check if a timer is running
+ * @param timer Timer
+ * @return Running
+ */
+bool timerRunning(const wheel_timer_t* timer);
+
+/**
+ * @brief Run the callbacks of the timers expired, from the main loop
  */
-void timerInit(void);
+void timerUpdate(void);
 
 // Non-Blocking services ///////////////////////////////////////////////////////
 
@@ -0,0 +1,202 @@
+/***************************************************************************//**
+  @file     trace.c
+  @brief    Event trace: timestamped binary records in a RAM ring, dumped
+            over serial on command or on a fault
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "trace.h"
+
+#if TRACE_EVENTS
+
+#if TRACE_HOST
+#include <time.h>
+#endif
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TRACE_MASK			(TRACE_RECORDS - 1)
+
+#define LOAD_ACQUIRE(x)		__atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define LOAD_RELAXED(x)		__atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define STORE_RELEASE(x, v)	__atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#define STORE_RELAXED(x, v)	__atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+
+#if TRACE_HOST
+#define CONTEXT()			0U
+#else
+#define CONTEXT()			(__get_IPSR() & 0x1FFU)
+#endif
+
+_Static_assert(!(TRACE_RECORDS & TRACE_MASK), "TRACE_RECORDS must be a power of 2");
+_Static_assert(sizeof(trace_record_t) == 16, "Records are dumped as they are");
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Copy a record out, checking it was not being written meanwhile
+ * @param index Record index
+ * @param record Place to store the copy
+ * @return The copy is whole and is that record
+ */
+static bool snapshot (uint32_t index, trace_record_t* record);
+
+#if !TRACE_HOST
+/**
+ * @brief Configurable fault: record it, dump the trace, stop
+ */
+static void fault (void);
+#endif
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static trace_record_t ring[TRACE_RECORDS];
+static uint32_t head;															// Free-running, next index to claim
+static uint32_t base;															// Index of the first record since the last reset
+#if !TRACE_HOST
+static trace_writer_t fault_writer;
+#endif
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void traceInit (trace_writer_t writer)
+{
+#if !TRACE_HOST
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;								// Trace clocked, DWT registers alive
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;										// Left running if profiling started it
+
+	fault_writer = writer;
+	SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk | SCB_SHCSR_USGFAULTENA_Msk;	// Their own handlers, not escalated to HardFault
+#else
+	(void)writer;
+#endif
+	traceReset();
+}
+
+#if TRACE_HOST
+uint32_t traceNow (void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint32_t)((uint64_t)now.tv_sec * 1000000000U + now.tv_nsec);
+}
+#endif
+
+void traceRecord (trace_event_t event, trace_kind_t kind, uint32_t arg)
+{
+	uint32_t index = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);			// Claimed: nested ISRs take the next ones
+	trace_record_t* record = &ring[index & TRACE_MASK];
+
+	STORE_RELAXED(record->seq, 0);
+	__atomic_thread_fence(__ATOMIC_RELEASE);									// Invalid before it changes
+	record->time = traceNow();
+	record->arg = arg;
+	record->event = event;
+	record->kind = kind;
+	record->context = CONTEXT();
+	STORE_RELEASE(record->seq, index + 1);
+}
+
+size_t traceDump (void* buffer, size_t size)
+{
+	trace_header_t header = { TRACE_MAGIC, TRACE_HZ, 0, 0 };
+	trace_record_t record;
+	uint32_t end = LOAD_ACQUIRE(head), start = LOAD_RELAXED(base), max;
+
+	if (size < sizeof(header))
+		return 0;
+
+	max = (size - sizeof(header)) / sizeof(record);
+	if (max > TRACE_RECORDS)
+		max = TRACE_RECORDS;
+	header.written = end - start;
+	if (header.written > max)
+		start = end - max;
+
+	for (uint32_t index = start; index != end; index++)						// Buffer may be unaligned: copied bytewise
+		if (snapshot(index, &record))
+			memcpy((uint8_t*)buffer + sizeof(header) + header.count++ * sizeof(record), &record, sizeof(record));
+	memcpy(buffer, &header, sizeof(header));
+
+	return sizeof(header) + header.count * sizeof(record);
+}
+
+void traceReset (void)
+{
+	STORE_RELAXED(base, LOAD_RELAXED(head));									// Claimed records stay, only older than base
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static bool snapshot (uint32_t index, trace_record_t* record)
+{
+	trace_record_t* slot = &ring[index & TRACE_MASK];
+	uint32_t seq = LOAD_ACQUIRE(slot->seq);
+
+	*record = *slot;
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);									// Copied before checking again
+
+	return (seq == index + 1) && (LOAD_RELAXED(slot->seq) == seq);
+}
+
+#if !TRACE_HOST
+
+// Fault Handlers //////////////////////////////////////////////////////////////
+
+__ISR__ MemManage_Handler (void) { fault(); }
+__ISR__ BusFault_Handler (void) { fault(); }
+__ISR__ UsageFault_Handler (void) { fault(); }
+
+static void fault (void)
+{
+	trace_header_t header = { TRACE_MAGIC, TRACE_HZ, 0, 0 };
+	uint32_t end, start;
+
+	traceRecord(TRACE_FAULT, TRACE_KIND_MARK, SCB->CFSR);
+
+	if (fault_writer)															// Nothing else runs: the ring as it is, the decoder skips torn records
+	{
+		end = head;
+		start = base;
+		header.written = end - start;
+		if (header.written > TRACE_RECORDS)
+			start = end - TRACE_RECORDS;
+		header.count = end - start;
+		fault_writer((const uint8_t*)&header, sizeof(header));
+		for (uint32_t index = start; index != end; index++)
+			fault_writer((const uint8_t*)&ring[index & TRACE_MASK], sizeof(trace_record_t));
+	}
+
+	__FOREVER__;
+}
+
+#endif // !TRACE_HOST
+
+#endif // TRACE_EVENTS
+
+/******************************************************************************/
@@ -0,0 +1,189 @@
+/***************************************************************************//**
+  @file     trace.h
+  @brief    Event trace: timestamped binary records in a RAM ring, dumped
+            over serial on command or on a fault
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     Any context records without locking: a slot is claimed with one
+            atomic increment, then filled. Each module records only while
+            its TRACE_* switch in debug.h is on, the calls compile out
+            otherwise. tests/trace_decode.py turns a dump into Chrome trace
+            JSON (chrome://tracing, Perfetto), one track per ISR.
+ ******************************************************************************/
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "debug.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#ifndef TRACE_HOST
+#ifdef __arm__
+#define TRACE_HOST			0
+#else
+#define TRACE_HOST			1													// Off the board: a monotonic clock stands in for the cycle counter
+#endif
+#endif
+
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS		(!TRACE_HOST)										// 1 to record, 0 compiles every module's events out
+#endif
+
+#if !TRACE_HOST
+#include "hardware.h"
+#endif
+
+#ifndef TRACE_RECORDS
+#define TRACE_RECORDS		256													// Ring size, a power of 2: 16 bytes each
+#endif
+
+#define TRACE_MAGIC			0x31435254UL										// "TRC1" in memory, little endian
+#if TRACE_HOST
+#define TRACE_HZ			1000000000UL										// Timestamp rate
+#else
+#define TRACE_HZ			__CORE_CLOCK__
+#endif
+
+#if TRACE_EVENTS
+#define TRACE_BEGIN(module, event, arg)	do { if (module) traceRecord((event), TRACE_KIND_BEGIN, (arg)); } while (0)
+#define TRACE_END(module, event, arg)	do { if (module) traceRecord((event), TRACE_KIND_END, (arg)); } while (0)
+#define TRACE_MARK(module, event, arg)	do { if (module) traceRecord((event), TRACE_KIND_MARK, (arg)); } while (0)
+#else
+#define TRACE_BEGIN(module, event, arg)	((void)0)
+#define TRACE_END(module, event, arg)	((void)0)
+#define TRACE_MARK(module, event, arg)	((void)0)
+#endif
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef enum {																	// Keep tests/trace_decode.py in step
+	TRACE_ADC_ISR,
+	TRACE_DMA_ISR,
+	TRACE_GPIO_ISR,																// Port
+	TRACE_PDB_ISR,
+	TRACE_PIT_ISR,
+	TRACE_SYSTICK_ISR,
+	TRACE_UART_UPDATE,															// UART
+	TRACE_QUEUE_FULL,															// Queue, push dropped
+	TRACE_SPSC_FULL,															// Ring address, push dropped
+	TRACE_FSM_STATE,															// Event << 16 | state entered
+	TRACE_FAULT,																// CFSR
+	TRACE_CANT
+} trace_event_t;
+
+typedef enum {
+	TRACE_KIND_BEGIN,
+	TRACE_KIND_END,
+	TRACE_KIND_MARK																// Instant
+} trace_kind_t;
+
+/**
+ * @brief Trace record, as dumped
+ * @param time Timestamp, TRACE_HZ counts, wrapping
+ * @param arg Event argument
+ * @param seq Record index + 1 once complete, anything else while being written
+ * @param event Event, trace_event_t
+ * @param kind Kind, trace_kind_t
+ * @param context Exception number running (0 for thread mode, 15 for SysTick, 16 + IRQn)
+ */
+typedef struct {
+	uint32_t	time;
+	uint32_t	arg;
+	uint32_t	seq;
+	uint8_t		event;
+	uint8_t		kind;
+	uint16_t	context;
+} trace_record_t;
+
+/**
+ * @brief Dump header, records follow oldest first
+ * @param magic TRACE_MAGIC
+ * @param hz Timestamp rate
+ * @param count Records following
+ * @param written Records written since the last reset, the ring kept the last ones
+ */
+typedef struct {
+	uint32_t	magic;
+	uint32_t	hz;
+	uint32_t	count;
+	uint32_t	written;
+} trace_header_t;
+
+/**
+ * @brief Fault dump output, polled: interrupts are not running
+ * @param data Bytes
+ * @param len Number of bytes
+ */
+typedef void (*trace_writer_t)(const uint8_t* data, uint32_t len);
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+#if TRACE_EVENTS
+
+/**
+ * @brief Start the cycle counter and catch the configurable faults
+ * @param writer Where the trace goes on a fault, NULL to only stop there
+ */
+void traceInit (trace_writer_t writer);
+
+/**
+ * @brief Read the timestamp clock
+ * @return Cycles, or nanoseconds on the host, wrapping
+ */
+#if TRACE_HOST
+uint32_t traceNow (void);
+#else
+static inline uint32_t traceNow (void) { return DWT->CYCCNT; }
+#endif
+
+/**
+ * @brief Record an event, from any context, overwriting the oldest
+ * @param event Event
+ * @param kind Kind
+ * @param arg Argument
+ */
+void traceRecord (trace_event_t event, trace_kind_t kind, uint32_t arg);
+
+/**
+ * @brief Copy the trace out, while it keeps recording
+ * @param buffer Header, then the latest records that fit
+ * @param size Buffer size
+ * @return Bytes written, 0 if not even the header fits
+ * @note Records being written meanwhile are left out
+ */
+size_t traceDump (void* buffer, size_t size);
+
+/**
+ * @brief Forget every record
+ */
+void traceReset (void);
+
+#else
+
+static inline void traceInit (trace_writer_t writer) { (void)writer; }
+static inline size_t traceDump (void* buffer, size_t size) { (void)buffer; (void)size; return 0; }
+static inline void traceReset (void) {}
+
+#endif // TRACE_EVENTS
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _TRACE_H_
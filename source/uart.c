@@ -14,8 +14,13 @@
 
 #include "board.h"
 #include "debug.h"
+#include "dma.h"
+#include "dmaring.h"
 #include "hardware.h"
+#include "macros.h"
 #include "pisr.h"
+#include "prof.h"
+#include "trace.h"
 #include "uart.h"
 
 /*******************************************************************************
@@ -26,21 +31,48 @@
 
 #define PORT_REG(port, reg)					(PORT_Ptrs[port]->reg)
 
-#define UART_MAX_BAUDRATE					(__CORE_CLOCK__ / 16)
+#define UART_BUS_CLOCK						(__CORE_CLOCK__ >> 1)
+#define UART_CLOCK(id)						((((id) == UART0_ID) || ((id) == UART1_ID)) ? __CORE_CLOCK__ : UART_BUS_CLOCK)
 #define UART_HAL_DEFAULT_BAUDRATE			9600
 #define UART_REG(id, reg)					(UART_Ptrs[id]->reg)
 
+#define UART_FIFO_DEPTH(size)				((size) ? (2 << (size)) : 1)		// PFIFO xxFIFOSIZE field to words
+#define UART_FIFO_MAX_DEPTH					128
+
+#define UART_DMA_CANT_IDS					(UART3_ID + 1)						// UART4 and UART5 share a DMAMUX source
+#define UART_DMA_RX_CH(id)					((dma_channel_t)(2 * (id)))
+#define UART_DMA_TX_CH(id)					((dma_channel_t)(2 * (id) + 1))
+#define UART_DMA_SOURCE(req)				((req) & 0xFF)						// Strip the SDK's DMAMUX instance bit
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/**
+ * @brief Transmit descriptor, see uartWriteDesc
+ * @param data Caller-owned bytes
+ * @param len Number of bytes
+ * @param cb Completion callback
+ */
+typedef struct {
+	const uchar_t*	data;
+	uint32_t		len;
+	uart_callback_t	cb;
+} uart_desc_t;
+
+QUEUE_STATIC_DEFINE(desc_queue, uart_desc_t, UART_DESC_CANT);
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
 /**
- * @brief UARTx ISR Handler (IRQ and Periodic)
+ * @brief PISR Handler, updates the periodic UARTs only
  */
 static void handler (void);
 
 /**
- * @brief Update the queues with the received data
+ * @brief Update the queues with the received data (UARTx ISR, one instance)
  * @param id UART ID
  */
 static void update (uart_id_t id);
@@ -59,6 +91,45 @@ static void setBaudRate (uart_id_t id, uint32_t br);
  */
 static void configFIFO (uart_id_t id, uart_fifo_t fifo);
 
+/**
+ * @brief Configure the DMA channels for UARTx, Rx circular and Tx one-shot
+ * @param id UART ID
+ * @return Configuration succeed
+ */
+static bool configDMA (uart_id_t id);
+
+/**
+ * @brief Current write position of the circular Rx DMA transfer
+ * @param id UART ID
+ * @return Free-running byte count, see dmaRingHead
+ */
+static uint32_t rxHead (uart_id_t id);
+
+/**
+ * @brief Get the Tx path going after a write (DMA transfer or Tx watermark IRQ)
+ * @param id UART ID
+ */
+static void txStart (uart_id_t id);
+
+/**
+ * @brief Start a Tx DMA transfer of the queued bytes or pending buffer, if idle
+ * @param id UART ID
+ */
+static void txKick (uart_id_t id);
+
+/**
+ * @brief Retire the front descriptor and call its callback
+ * @param id UART ID
+ */
+static void txDescDone (uart_id_t id);
+
+/**
+ * @brief DMA major loop callbacks
+ * @param ch DMA channel
+ */
+static void rxLap (dma_channel_t ch);
+static void txDone (dma_channel_t ch);
+
 /*******************************************************************************
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
@@ -77,6 +148,10 @@ static uint32_t const	UART_Clks[]	= { SIM_SCGC4_UART0_MASK,
 										SIM_SCGC1_UART4_MASK,
 										SIM_SCGC1_UART5_MASK };
 static uint8_t const	UART_IRQn[]	=   UART_RX_TX_IRQS;
+static uint8_t const	UART_DMA_Srcs[][2] = {	{ UART_DMA_SOURCE(kDmaRequestMux0UART0Rx), UART_DMA_SOURCE(kDmaRequestMux0UART0Tx) },
+												{ UART_DMA_SOURCE(kDmaRequestMux0UART1Rx), UART_DMA_SOURCE(kDmaRequestMux0UART1Tx) },
+												{ UART_DMA_SOURCE(kDmaRequestMux0UART2Rx), UART_DMA_SOURCE(kDmaRequestMux0UART2Tx) },
+												{ UART_DMA_SOURCE(kDmaRequestMux0UART3Rx), UART_DMA_SOURCE(kDmaRequestMux0UART3Tx) } };
 static pin_t const		UART_PINS[]	= { UART0_RX_PIN, UART0_TX_PIN,
 									 	UART1_RX_PIN, UART1_TX_PIN,
 									 	UART2_RX_PIN, UART2_TX_PIN,
@@ -84,10 +159,24 @@ static pin_t const		UART_PINS[]	= { UART0_RX_PIN, UART0_TX_PIN,
 									 	UART4_RX_PIN, UART4_TX_PIN,
 									 	UART5_RX_PIN, UART5_TX_PIN };
 
+static uchar_t rx_items[UART_CANT_IDS][UART_BUFFER_SIZE + 1];					// Static queue storage, see QUEUE_STORAGE
+static uchar_t tx_items[UART_CANT_IDS][UART_BUFFER_SIZE + 1];
+
 static bool init[UART_CANT_IDS];
 static queue_id_t rx_queue[UART_CANT_IDS];
 static queue_id_t tx_queue[UART_CANT_IDS];
-static uart_id_t irq = UART_CANT_IDS;
+static uint8_t periodic;														// Bitmap of UART_ISR_PERIODIC ports, by ID
+static uart_isr_t isr[UART_CANT_IDS];
+static uart_baud_t baud[UART_CANT_IDS];
+static volatile bool rx_idle[UART_CANT_IDS];
+static desc_queue_t tx_desc[UART_CANT_IDS];
+static uint32_t tx_desc_sent[UART_CANT_IDS];									// Bytes of the front descriptor handed to the FIFO or DMA
+
+static uint8_t rx_dma_items[UART_DMA_CANT_IDS][UART_DMA_RX_SIZE];				// Written circularly by the Rx channel
+static dma_ring_t rx_ring[UART_DMA_CANT_IDS];
+static volatile uint32_t rx_laps[UART_DMA_CANT_IDS];
+static volatile uint16_t tx_dma_len[UART_DMA_CANT_IDS];							// Bytes in flight, 0 when the Tx channel is idle
+static bool tx_dma_desc[UART_DMA_CANT_IDS];										// In flight bytes come from a descriptor, not the queue
 
 /*******************************************************************************
  *******************************************************************************
@@ -97,7 +186,7 @@ static uart_id_t irq = UART_CANT_IDS;
 
 bool uartInit (uart_id_t id, uart_cfg_t config)
 {
-	if(!init[id])
+	if(!init[id] && ((config.isr != UART_ISR_DMA) || (id < UART_DMA_CANT_IDS)))
 	{
 		PINData_t pinRx = { PIN2PORT(UART_PINS[id * 2]), PIN2NUM(UART_PINS[id * 2]) };
 		PINData_t pinTx = { PIN2PORT(UART_PINS[id * 2 + 1]), PIN2NUM(UART_PINS[id * 2 + 1]) };
@@ -113,7 +202,8 @@ bool uartInit (uart_id_t id, uart_cfg_t config)
 
 		/* Configure the mode and parity for UARTx */
 		UART_REG(id, C1) = UART_C1_M(config.mode) |
-						   UART_C1_PE(config.parity != UART_PARITY_NONE) | UART_C1_PT(config.parity);
+						   UART_C1_PE(config.parity != UART_PARITY_NONE) | UART_C1_PT(config.parity) |
+						   UART_C1_ILT(config.isr != UART_ISR_PERIODIC);				// Idle counted after the stop bit
 
 		/* Set UARTx to default speed */
 		setBaudRate(id, UART_HAL_DEFAULT_BAUDRATE);
@@ -132,22 +222,46 @@ bool uartInit (uart_id_t id, uart_cfg_t config)
 		/* Enable FIFO and configure watermarks */
 		configFIFO(id, config.fifo);
 
-		/* Enable Tx and Rx IRQs for UARTx */
-		NVIC_EnableIRQ(UART_IRQn[id]);
-
-		/* Enable UARTx Rx and Tx (and interrupts) */
-		if(config.RxTx != UART_RX_ENABLED)
-			UART_REG(id, C2) |= (UART_C2_TE_MASK | (UART_C2_TIE_MASK & (config.isr == UART_ISR_IRQ)));
-		if(config.RxTx != UART_TX_ENABLED)
-			UART_REG(id, C2) |= (UART_C2_RE_MASK | (UART_C2_RIE_MASK & (config.isr == UART_ISR_IRQ)));
-
-		/* Create queues for UARTx */
-		rx_queue[id] = queueInit();
-		tx_queue[id] = queueInit();
-
-		/* Register PISR to update the queues */
+		/* Create queues for UARTx, before any IRQ can use them */
+		rx_queue[id] = queueInitStatic(rx_items[id], UART_BUFFER_SIZE, sizeof(uchar_t));
+		tx_queue[id] = queueInitStatic(tx_items[id], UART_BUFFER_SIZE, sizeof(uchar_t));
+		isr[id] = config.isr;
+
+		if(config.isr == UART_ISR_DMA)
+		{
+			/* Route Rx data full and Tx data empty flags to the DMA instead of the IRQ */
+			if(!configDMA(id))
+				return false;
+			UART_REG(id, RWFIFO) = UART_RWFIFO_RXWATER(1);						// Every byte requests a transfer
+			UART_REG(id, C5) |= UART_C5_TDMAS_MASK | UART_C5_RDMAS_MASK;
+			if(config.RxTx != UART_RX_ENABLED)
+				UART_REG(id, C2) |= UART_C2_TE_MASK | UART_C2_TIE_MASK;
+			if(config.RxTx != UART_TX_ENABLED)
+			{
+				UART_REG(id, C2) |= UART_C2_RE_MASK | UART_C2_RIE_MASK | UART_C2_ILIE_MASK;	// Only idle line reaches the IRQ
+				DMA_Start(UART_DMA_RX_CH(id));
+			}
+			NVIC_EnableIRQ(UART_IRQn[id]);
+		}
+		else
+		{
+			/* Enable Tx and Rx IRQs for UARTx */
+			NVIC_EnableIRQ(UART_IRQn[id]);
+
+			/* Enable UARTx Rx and Tx (and interrupts), Tx watermark IRQ is enabled while there is data to send */
+			if(config.RxTx != UART_RX_ENABLED)
+				UART_REG(id, C2) |= UART_C2_TE_MASK;
+			if(config.RxTx != UART_TX_ENABLED)
+				UART_REG(id, C2) |= UART_C2_RE_MASK | ((config.isr == UART_ISR_IRQ) ? (UART_C2_RIE_MASK | UART_C2_ILIE_MASK) : 0);
+		}
+
+		/* Register PISR to update the queues, once for all periodic ports */
 		if(config.isr == UART_ISR_PERIODIC)
-			pisrRegister(handler, PISR_FREQUENCY_HZ / UART_FREQUENCY_HZ);
+		{
+			if(!periodic)
+				pisrRegisterHz(handler, UART_FREQUENCY_HZ);
+			periodic |= 1U << id;
+		}
 
 		init[id] = true;
 	}
@@ -155,39 +269,129 @@ bool uartInit (uart_id_t id, uart_cfg_t config)
 	return init[id];
 }
 
+uart_baud_t uartSolveBaudRate (uint32_t clock, uint32_t br)
+{
+	uart_baud_t solution = { 0, 0, 0, 0 };
+	uint64_t twice = (uint64_t)clock << 1, divisor = 0;							// Divisor in 1/32 steps: 32 * clock / (16 * br)
+	int64_t miss;
+
+	if(br)
+	{
+		for(uint64_t d = twice / br; d <= twice / br + 1; d++)				// The best is either side of the exact one
+		{
+			if((d < 32) || (d > ((UART_SBR_MAX << 5) | 0x1F)))					// SBR 0 disables the generator
+				continue;
+			miss = (int64_t)twice - (int64_t)(br * d);							// Rate error is miss / (br * d), compared exactly
+			if(!divisor || ((uint64_t)ABS(miss) * divisor < (uint64_t)ABS((int64_t)twice - (int64_t)(br * divisor)) * d))
+				divisor = d;
+		}
+	}
+
+	if(divisor)
+	{
+		solution.sbr = divisor >> 5;
+		solution.brfa = divisor & 0x1F;
+		solution.baudrate = (twice + (divisor >> 1)) / divisor;
+		solution.error = 100.0f * ((float)twice / divisor - br) / br;
+	}
+
+	return solution;
+}
+
+uart_baud_t uartGetBaudRate (uart_id_t id)
+{
+	return baud[id];
+}
+
 // Main Services ///////////////////////////////////////////////////////////////
 
 uint8_t uartIsRxMsg (uart_id_t id)
 {
-	return !queueIsEmpty(rx_queue[id]);
+	return (isr[id] == UART_ISR_DMA) ? dmaRingAvailable(&rx_ring[id], rxHead(id)) != 0 : !queueIsEmpty(rx_queue[id]);
 }
 
 uint8_t uartGetRxMsgLength (uart_id_t id)
 {
-	return queueSize(rx_queue[id]);
+	return (isr[id] == UART_ISR_DMA) ? MIN(dmaRingAvailable(&rx_ring[id], rxHead(id)), UINT8_MAX) : queueSize(rx_queue[id]);
+}
+
+uint8_t uartIsRxMsgComplete (uart_id_t id)
+{
+	bool complete = rx_idle[id];
+
+	if(complete)
+		rx_idle[id] = false;
+
+	return complete;
 }
 
 uint8_t uartReadMsg (uart_id_t id, uchar_t* msg, uint8_t cant)
 {
-	uint8_t i = 0;
-	while (i < cant && !queueIsEmpty(rx_queue[id]))
-		msg[i++] = queuePop(rx_queue[id]);
+	return (isr[id] == UART_ISR_DMA) ? dmaRingRead(&rx_ring[id], rxHead(id), msg, cant) : queuePopN(rx_queue[id], msg, cant);
+}
+
+uint32_t uartRxPeek (uart_id_t id, uint32_t offset, const uchar_t** msg)
+{
+	return (isr[id] == UART_ISR_DMA) ? dmaRingPeekAt(&rx_ring[id], rxHead(id), offset, (uint8_t**)msg) : 0;
+}
+
+void uartRxConsume (uart_id_t id, uint32_t cant)
+{
+	if(isr[id] == UART_ISR_DMA)
+		dmaRingConsume(&rx_ring[id], cant);
+}
 
-	return i;
+uint32_t uartRxOverruns (uart_id_t id)
+{
+	if(isr[id] != UART_ISR_DMA)
+		return 0;
+
+	dmaRingAvailable(&rx_ring[id], rxHead(id));									// Notices a lap not peeked at yet
+
+	return rx_ring[id].overruns;
 }
 
 uint8_t uartWriteMsg (uart_id_t id, const uchar_t* msg, uint8_t cant)
 {
-	uint8_t i = 0;
-	while (i < cant && !queueIsFull(tx_queue[id]))
-		queuePush(tx_queue[id], msg[i++]);
+	uint8_t count = queuePushN(tx_queue[id], msg, cant);
+
+	if(count)
+		txStart(id);
 
-	return i;
+	return count;
 }
 
 uint8_t uartIsTxMsgComplete (uart_id_t id)
 {
-	return queueIsEmpty(tx_queue[id]);
+	return queueIsEmpty(tx_queue[id]) && desc_queueIsEmpty(&tx_desc[id]) && ((isr[id] != UART_ISR_DMA) || !tx_dma_len[id]);
+}
+
+bool uartWriteDesc (uart_id_t id, const uchar_t* msg, uint32_t cant, uart_callback_t cb)
+{
+	uart_desc_t desc = { msg, cant, cb };
+	bool status = init[id] && cant && desc_queuePush(&tx_desc[id], desc);
+
+	if(status)
+		txStart(id);
+
+	return status;
+}
+
+bool uartWritePolled (uart_id_t id, const uchar_t* msg, uint32_t cant)
+{
+	if(!init[id])
+		return false;
+
+	UART_REG(id, C2) &= ~(UART_C2_TIE_MASK | UART_C2_TCIE_MASK);				// Nothing else feeds the Tx FIFO from now on
+	UART_REG(id, C5) &= ~UART_C5_TDMAS_MASK;
+	for(uint32_t i = 0; i < cant; i++)
+	{
+		while(!(UART_REG(id, S1) & UART_S1_TDRE_MASK));
+		UART_REG(id, D) = msg[i];
+	}
+	while(!(UART_REG(id, S1) & UART_S1_TC_MASK));
+
+	return true;
 }
 
 // bool uartDeinit (uart_id_t id)
@@ -234,72 +438,111 @@ uint8_t uartIsTxMsgComplete (uart_id_t id)
 
 // ISR Functions ///////////////////////////////////////////////////////////////
 
-__ISR__ UART0_RX_TX_IRQHandler (void) {	irq = UART0_ID; handler(); }
-__ISR__ UART1_RX_TX_IRQHandler (void) {	irq = UART1_ID; handler(); }
-__ISR__ UART2_RX_TX_IRQHandler (void) {	irq = UART2_ID; handler(); }
-__ISR__ UART3_RX_TX_IRQHandler (void) {	irq = UART3_ID; handler(); }
-__ISR__ UART4_RX_TX_IRQHandler (void) {	irq = UART4_ID; handler(); }
-__ISR__ UART5_RX_TX_IRQHandler (void) {	irq = UART5_ID; handler(); }
+__ISR__ UART0_RX_TX_IRQHandler (void) { update(UART0_ID); }
+__ISR__ UART1_RX_TX_IRQHandler (void) { update(UART1_ID); }
+__ISR__ UART2_RX_TX_IRQHandler (void) { update(UART2_ID); }
+__ISR__ UART3_RX_TX_IRQHandler (void) { update(UART3_ID); }
+__ISR__ UART4_RX_TX_IRQHandler (void) { update(UART4_ID); }
+__ISR__ UART5_RX_TX_IRQHandler (void) { update(UART5_ID); }
 
-static void handler (void)																// Separate so that it can be called from the PISR/timer as well
+static void handler (void)
 {
 #if DEBUG_UART
 P_DEBUG_TP_SET
 #endif
-	if(irq != UART_CANT_IDS)
-	{
-		update(irq);
-		irq = UART_CANT_IDS;
-	}
-	else
-		for(uint8_t id = 0; id < UART_CANT_IDS; id++)
-			if(init[id])
-				update(id);
+	for(uint8_t ports = periodic; ports; ports &= ports - 1)					// Skip straight to the next set bit
+		update(__builtin_ctz(ports));
 #if DEBUG_UART
 P_DEBUG_TP_CLR
 #endif
 }
 
-static void update (uart_id_t id)
+static void update (uart_id_t id)												// Only touches the state of its own instance, safe to nest
 {
-	uint8_t count, status = UART_REG(id, S1);									// Always needed (clears status register)
+#if DEBUG_UART
+D_DEBUG_TP_SET
+#endif
+	PROF_BEGIN(PROF_UART_UPDATE);
+	TRACE_BEGIN(TRACE_UART, TRACE_UART_UPDATE, id);
+	uchar_t buffer[UART_FIFO_MAX_DEPTH], * data;
+	uint8_t count, space, status = UART_REG(id, S1);									// Always needed (clears status register)
 
-	count = UART_REG(id, RCFIFO);
-	while(count-- && !queueIsFull(rx_queue[id]))
-		queuePush(rx_queue[id], UART_REG(id, D));
+	if(isr[id] != UART_ISR_DMA)													// Data moves by DMA otherwise, only idle line gets here
+	{
+		/* Drain the whole Rx FIFO (keeps RDRF from retriggering), bytes the queue cannot take are dropped */
+		count = UART_REG(id, RCFIFO);
+		for(uint8_t i = 0; i < count; i++)
+			buffer[i] = UART_REG(id, D);
+		queuePushN(rx_queue[id], buffer, count);
+
+		/* Fill the Tx FIFO free space straight from the queue storage, then from the caller buffers */
+		space = UART_FIFO_DEPTH(REG_READ(uint8_t, UART_PFIFO_TXFIFOSIZE_SHIFT, UART_PFIFO_TXFIFOSIZE_MASK, UART_REG(id, PFIFO))) - UART_REG(id, TCFIFO);
+		while(space)
+		{
+			if(!tx_desc_sent[id] && (count = MIN(space, queuePeekContiguous(tx_queue[id], (data_t*)&data))))	// Never inside a started buffer, it would split its frame
+			{
+				for(uint8_t i = 0; i < count; i++)
+					UART_REG(id, D) = data[i];
+				queueConsume(tx_queue[id], count);
+			}
+			else if(!desc_queueIsEmpty(&tx_desc[id]))
+			{
+				uart_desc_t* desc = desc_queueFront(&tx_desc[id]);
+				count = MIN(space, desc->len - tx_desc_sent[id]);
+				for(uint8_t i = 0; i < count; i++)
+					UART_REG(id, D) = desc->data[tx_desc_sent[id] + i];
+				tx_desc_sent[id] += count;
+				if(tx_desc_sent[id] == desc->len)
+					txDescDone(id);
+			}
+			else
+				break;
+			space -= count;
+		}
+
+		/* Nothing left to send, stop the Tx watermark interrupt until the next write */
+		if((isr[id] == UART_ISR_IRQ) && queueIsEmpty(tx_queue[id]) && desc_queueIsEmpty(&tx_desc[id]))
+			UART_REG(id, C2) &= ~UART_C2_TIE_MASK;
+	}
 
-	count = UART_REG(id, TCFIFO);
-	while((count++ != ((UART_REG(id, PFIFO) & UART_PFIFO_TXFIFOSIZE_MASK) >> UART_PFIFO_TXFIFOSIZE_SHIFT))
-		&& !queueIsEmpty(tx_queue[id])) UART_REG(id, D) = queuePop(tx_queue[id]);
+	/* End of burst: the partial Rx FIFO was flushed above (or by the DMA) */
+	if(status & UART_S1_IDLE_MASK)
+	{
+		if(!UART_REG(id, RCFIFO))												// IDLE clears reading S1 then D, a D read on an empty FIFO underflows it
+		{
+			(void)UART_REG(id, D);
+			UART_REG(id, CFIFO) |= UART_CFIFO_RXFLUSH_MASK;
+			UART_REG(id, SFIFO) = UART_SFIFO_RXUF_MASK;
+		}
+		rx_idle[id] = true;
+	}
+	TRACE_END(TRACE_UART, TRACE_UART_UPDATE, id);
+	PROF_END(PROF_UART_UPDATE);
+#if DEBUG_UART
+D_DEBUG_TP_CLR
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 static void setBaudRate (uart_id_t id, uint32_t br)
 {
-	uint8_t brfa;
-	uint16_t sbr;
-	uint32_t clock;
-
-	clock = ((id == UART0_ID) || (id == UART1_ID)) ? (__CORE_CLOCK__) : (__CORE_CLOCK__ >> 1);
+	/* Calculate baud settings for this UART's clock, falling back to the default if out of range */
+	uart_baud_t solution = uartSolveBaudRate(UART_CLOCK(id), br);
 
-	if ((br == 0) || (br > UART_MAX_BAUDRATE))
-		br = UART_HAL_DEFAULT_BAUDRATE;
-
-	/* Calculate baud settings */
-	sbr = (uint16_t)(clock / (br << 4)); // sbr = clock / (baudrate * 16)
-
-	/* Determine if a fractional divider is needed to get closer to the baud rate */
-	brfa = (uint8_t)((uint16_t)((clock << 1) / br) - (sbr << 5)); // brfa = 2 * clock / baudrate - 32 * sbr
+	if (!solution.baudrate)
+		solution = uartSolveBaudRate(UART_CLOCK(id), UART_HAL_DEFAULT_BAUDRATE);
 
 	/* Save off the current value of the UARTx_BDH except for the SBR */
-	UART_REG(id, BDH) = (UART_REG(id, BDH) & ~UART_BDH_SBR_MASK) | UART_BDH_SBR(sbr >> 8);
+	UART_REG(id, BDH) = (UART_REG(id, BDH) & ~UART_BDH_SBR_MASK) | UART_BDH_SBR(solution.sbr >> 8);
 
 	/* Write the sbr to the UARTx_BDL */
-	UART_REG(id, BDL) = UART_BDL_SBR(sbr);
+	UART_REG(id, BDL) = UART_BDL_SBR(solution.sbr);
 
 	/* Save off the current value of the UARTx_C4 register except for the BRFA */
-	UART_REG(id, C4) = (UART_REG(id, C4) & ~UART_C4_BRFA_MASK) | UART_C4_BRFA(brfa);
+	UART_REG(id, C4) = (UART_REG(id, C4) & ~UART_C4_BRFA_MASK) | UART_C4_BRFA(solution.brfa);
+
+	baud[id] = solution;
 }
 
 static void configFIFO (uart_id_t id, uart_fifo_t fifo)
@@ -309,18 +552,123 @@ static void configFIFO (uart_id_t id, uart_fifo_t fifo)
 	{
 		UART_REG(id, PFIFO) |= UART_PFIFO_RXFE_MASK;
 		uint8_t depth = (UART_REG(id, PFIFO) & UART_PFIFO_RXFIFOSIZE_MASK) >> UART_PFIFO_RXFIFOSIZE_SHIFT;
-		UART_REG(id, RWFIFO) = UART_RWFIFO_RXWATER((85 * (depth ? (2 << depth) : 1)) / 100);
+		UART_REG(id, RWFIFO) = UART_RWFIFO_RXWATER((85 * UART_FIFO_DEPTH(depth)) / 100);
 	}
 	if(fifo == UART_FIFO_TX_ENABLED || fifo == UART_FIFO_RX_TX_ENABLED)
 	{
 		UART_REG(id, PFIFO) |= UART_PFIFO_TXFE_MASK;
 		uint8_t depth = (UART_REG(id, PFIFO) & UART_PFIFO_TXFIFOSIZE_MASK) >> UART_PFIFO_TXFIFOSIZE_SHIFT;
-		UART_REG(id, TWFIFO) = UART_TWFIFO_TXWATER(((15 * (depth ? (2 << depth) : 1)) / 100) + 1);
+		UART_REG(id, TWFIFO) = UART_TWFIFO_TXWATER(((15 * UART_FIFO_DEPTH(depth)) / 100) + 1);
 	}
 	if(fifo == UART_FIFO_DISABLED)
 		UART_REG(id, PFIFO) &= ~(UART_PFIFO_RXFE_MASK | UART_PFIFO_TXFE_MASK);
 }
 
+static bool configDMA (uart_id_t id)
+{
+	dma_cfg_t rx = { UART_DMA_Srcs[id][0], (uint32_t)&UART_REG(id, D), (uint32_t)rx_dma_items[id], 0, 1, DMA_SIZE_8,
+					 1, UART_DMA_RX_SIZE, 0, -(int32_t)UART_DMA_RX_SIZE, true, rxLap };
+	dma_cfg_t tx = { UART_DMA_Srcs[id][1], 0, (uint32_t)&UART_REG(id, D), 1, 0, DMA_SIZE_8,
+					 1, 1, 0, 0, false, txDone };						// Addresses and count loaded per transfer
+
+	dmaRingInit(&rx_ring[id], rx_dma_items[id], UART_DMA_RX_SIZE);
+	rx_laps[id] = 0;
+	tx_dma_len[id] = 0;
+
+	return DMA_Init(UART_DMA_RX_CH(id), rx) && DMA_Init(UART_DMA_TX_CH(id), tx);
+}
+
+static uint32_t rxHead (uart_id_t id)
+{
+	uint32_t laps, head;
+	uint16_t remaining;
+
+	do {																		// Retry if a lap completed in between
+		laps = rx_laps[id];
+		remaining = DMA_GetCount(UART_DMA_RX_CH(id));
+	} while(laps != rx_laps[id]);
+
+	head = dmaRingHead(laps, UART_DMA_RX_SIZE, remaining);
+	if((int32_t)(head - rx_ring[id].tail) < 0)									// CITER already reloaded, lap ISR still pending
+		head += UART_DMA_RX_SIZE;
+
+	return head;
+}
+
+static void txStart (uart_id_t id)
+{
+	uint32_t primask;
+
+	if(isr[id] == UART_ISR_DMA)
+		txKick(id);
+	else if(isr[id] == UART_ISR_IRQ)
+	{
+		primask = __get_PRIMASK();												// C2 is also written by the ISR
+		__disable_irq();
+		UART_REG(id, C2) |= UART_C2_TIE_MASK;
+		__set_PRIMASK(primask);
+	}
+}
+
+static void txKick (uart_id_t id)
+{
+	uchar_t* data;
+	uart_desc_t* desc;
+	uint32_t count = 0, primask = __get_PRIMASK();								// Also called from txDone, keep the caller's mask
+
+	__disable_irq();
+	if(!tx_dma_len[id])
+	{
+		if(!tx_desc_sent[id] && (count = queuePeekContiguous(tx_queue[id], (data_t*)&data)))	// A buffer started goes on: bytes in between would split its frame
+			tx_dma_desc[id] = false;
+		else if(!desc_queueIsEmpty(&tx_desc[id]))								// Long buffers go out in DMA_MAX_COUNT chunks
+		{
+			desc = desc_queueFront(&tx_desc[id]);
+			data = (uchar_t*)desc->data + tx_desc_sent[id];
+			count = MIN(desc->len - tx_desc_sent[id], DMA_MAX_COUNT);
+			tx_dma_desc[id] = true;
+		}
+		if(count)
+		{
+			tx_dma_len[id] = count;
+			DMA_SetTransfer(UART_DMA_TX_CH(id), (uint32_t)data, (uint32_t)&UART_REG(id, D), count);
+			DMA_Start(UART_DMA_TX_CH(id));
+		}
+	}
+	__set_PRIMASK(primask);
+}
+
+static void txDescDone (uart_id_t id)
+{
+	uart_desc_t desc;
+
+	tx_desc_sent[id] = 0;
+	if(desc_queuePop(&tx_desc[id], &desc) && (desc.cb != NULL))
+		desc.cb(id, desc.data);
+}
+
+static void rxLap (dma_channel_t ch)
+{
+	rx_laps[ch / 2]++;
+}
+
+static void txDone (dma_channel_t ch)
+{
+	uart_id_t id = ch / 2;
+
+	if(tx_dma_desc[id])
+	{
+		tx_desc_sent[id] += tx_dma_len[id];
+		if(tx_desc_sent[id] == desc_queueFront(&tx_desc[id])->len)
+			txDescDone(id);
+	}
+	else
+		queueConsume(tx_queue[id], tx_dma_len[id]);
+
+	tx_dma_len[id] = 0;
+	txKick(id);																	// Stream whatever was queued meanwhile
+}
+
 /*
 void uartSetParity (uart_id_t id, uart_parity_t parity)
 {
@@ -27,6 +27,9 @@
 #define UART_MAX_IDS		UART_CANT_IDS
 #define UART_FREQUENCY_HZ	1500U
 #define UART_BUFFER_SIZE	QUEUE_MAX_SIZE
+#define UART_DMA_RX_SIZE	512U												// Circular DMA Rx buffer, per UART
+#define UART_SBR_MAX		0x1FFFU												// 13-bit SBR field
+#define UART_DESC_CANT		8U													// Pending uartWriteDesc transfers, per UART
 
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
@@ -65,8 +68,9 @@ typedef enum {
 } uart_fifo_t;
 
 typedef enum {
-	UART_ISR_IRQ,
-	UART_ISR_PERIODIC
+	UART_ISR_IRQ,																// Rx watermark, Tx watermark and idle line interrupts
+	UART_ISR_PERIODIC,
+	UART_ISR_DMA																// UART0 to UART3 only (UART4/5 share one DMA request)
 } uart_isr_t;
 
 typedef enum {
@@ -80,6 +84,22 @@ typedef enum {
 	UART_CANT_IDS
 } uart_id_t;
 
+typedef void (*uart_callback_t)(uart_id_t id, const uchar_t* msg);
+
+/**
+ * @brief Baud rate generator settings, baudrate = clock / (16 * (sbr + brfa / 32))
+ * @param sbr Integer divisor
+ * @param brfa Fractional divisor, in 1/32
+ * @param baudrate Achieved baud rate, 0 if the requested one is out of range
+ * @param error Deviation from the requested baud rate, in percent
+ */
+typedef struct {
+	uint16_t		sbr;
+	uint8_t			brfa;
+	uint32_t		baudrate;
+	float			error;
+} uart_baud_t;
+
 typedef struct {
     uint32_t		baudrate;
 	uart_mode_t		mode;
@@ -102,6 +122,21 @@ typedef struct {
 */
 bool uartInit (uart_id_t id, uart_cfg_t config);
 
+/**
+ * @brief Find the divisor closest to a baud rate
+ * @param clock UART module clock (core clock for UART0/1, bus clock for the rest)
+ * @param br Desired baud rate
+ * @return Divisor, achieved baud rate and error
+*/
+uart_baud_t uartSolveBaudRate (uint32_t clock, uint32_t br);
+
+/**
+ * @brief Get the baud rate UARTx actually runs at
+ * @param id UART's number
+ * @return Divisor, achieved baud rate and error against the configured one
+*/
+uart_baud_t uartGetBaudRate (uart_id_t id);
+
 // Non-Blocking Services ///////////////////////////////////////////////////////
 
 /**
@@ -118,6 +153,13 @@ uint8_t uartIsRxMsg (uart_id_t id);
 */
 uint8_t uartGetRxMsgLength (uart_id_t id);
 
+/**
+ * @brief Check if the line went idle after a burst (end of message), clears the flag
+ * @param id UART's number
+ * @return A complete message is waiting (UART_ISR_IRQ and UART_ISR_DMA only)
+*/
+uint8_t uartIsRxMsgComplete (uart_id_t id);
+
 /**
  * @brief Read a received message. Non-Blocking
  * @param id UART's number
@@ -127,6 +169,30 @@ uint8_t uartGetRxMsgLength (uart_id_t id);
 */
 uint8_t uartReadMsg (uart_id_t id, uchar_t* msg, uint8_t cant);
 
+/**
+ * @brief Access received bytes in place, without consuming them (UART_ISR_DMA only)
+ * @param id UART's number
+ * @param offset Received bytes to skip
+ * @param msg Place to store the address of the byte at offset
+ * @return Number of contiguous bytes from offset, 0 if there are none
+*/
+uint32_t uartRxPeek (uart_id_t id, uint32_t offset, const uchar_t** msg);
+
+/**
+ * @brief Release received bytes accessed in place (UART_ISR_DMA only)
+ * @param id UART's number
+ * @param cant Quantity of bytes to release
+*/
+void uartRxConsume (uart_id_t id, uint32_t cant);
+
+/**
+ * @brief Count the received bytes lost because the DMA lapped the reader (UART_ISR_DMA only)
+ * @param id UART's number
+ * @return Bytes lost since the UART was initialized, 0 when not in DMA mode
+ * @note Bytes accessed in place but not yet released may have been overwritten once it grows
+*/
+uint32_t uartRxOverruns (uart_id_t id);
+
 /**
  * @brief Write a message to be transmitted. Non-Blocking
  * @param id UART's number
@@ -143,6 +209,27 @@ uint8_t uartWriteMsg (uart_id_t id, const uchar_t* msg, uint8_t cant);
 */
 uint8_t uartIsTxMsgComplete (uart_id_t id);
 
+/**
+ * @brief Queue a caller-owned buffer, transmitted straight from memory (FIFO or DMA). Non-Blocking
+ * @param id UART's number
+ * @param msg Buffer with the bytes to be transfered, must stay valid until the callback
+ * @param cant Quantity of bytes to be transfered, any length
+ * @param cb Called from the ISR once the last byte is in the Tx FIFO, NULL for none
+ * @return Transfer queued (fails while UART_DESC_CANT transfers are pending)
+ * @note Bytes written with uartWriteMsg go out between buffers, never inside one in flight
+*/
+bool uartWriteDesc (uart_id_t id, const uchar_t* msg, uint32_t cant, uart_callback_t cb);
+
+/**
+ * @brief Send polling the Tx register, past the queues, DMA and interrupts. Blocking
+ * @param id UART's number
+ * @param msg Bytes to be transfered
+ * @param cant Quantity of bytes to be transfered
+ * @return UART was initialized
+ * @note For fault handlers: what was queued is abandoned, the Tx path stays off
+*/
+bool uartWritePolled (uart_id_t id, const uchar_t* msg, uint32_t cant);
+
 // Blocking Services ///////////////////////////////////////////////////////////
 
 /*******************************************************************************
@@ -0,0 +1,218 @@
+/***************************************************************************//**
+  @file     wheel.c
+  @brief    Hierarchical timing wheel: O(1) start and cancel, callbacks run
+            as the wheel is advanced to the current tick
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stddef.h>
+
+#include "wheel.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define SLOT_MASK			(WHEEL_SLOTS - 1)
+#define INDEX(tick, level)	(((tick) >> (WHEEL_BITS * (level))) & SLOT_MASK)
+
+_Static_assert(WHEEL_SLOTS <= 64, "Level 0 slot map is 64 bits");
+_Static_assert(WHEEL_BITS * WHEEL_LEVELS < 32, "Ticks are 32 bits");
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Put a timer in the slot its expiration falls in, from the current tick
+ * @param wheel Wheel
+ * @param timer Timer, not linked
+ */
+static void link (wheel_t* wheel, wheel_timer_t* timer);
+
+/**
+ * @brief Take a timer out of its slot
+ * @param wheel Wheel
+ * @param timer Timer, linked
+ */
+static void unlink (wheel_t* wheel, wheel_timer_t* timer);
+
+/**
+ * @brief Move a slot's timers down, they are due before this level wraps again
+ * @param wheel Wheel
+ * @param level Level, 1 or above
+ * @return Slot index moved, 0 when the next level is due as well
+ */
+static uint32_t cascade (wheel_t* wheel, uint8_t level);
+
+/*******************************************************************************
+ *******************************************************************************
+						GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void wheelInit (wheel_t* wheel, uint32_t now)
+{
+	*wheel = (wheel_t){ .now = now };
+}
+
+void wheelStart (wheel_t* wheel, wheel_timer_t* timer, uint32_t expires, uint32_t period, wheel_callback_t callback, void* arg)
+{
+	if (timer->pprev)
+		unlink(wheel, timer);
+	else
+		wheel->count++;
+
+	timer->expires = expires;
+	timer->period = period;
+	timer->callback = callback;
+	timer->arg = arg;
+	link(wheel, timer);
+}
+
+bool wheelCancel (wheel_t* wheel, wheel_timer_t* timer)
+{
+	if (!timer->pprev)
+		return false;
+
+	unlink(wheel, timer);
+	wheel->count--;
+
+	return true;
+}
+
+bool wheelRunning (const wheel_timer_t* timer)
+{
+	return timer->pprev != NULL;
+}
+
+uint32_t wheelAdvance (wheel_t* wheel, uint32_t now)
+{
+	wheel_timer_t* pending, * expired;
+	uint32_t next, count = 0;
+	uint8_t index;
+
+	while ((int32_t)(now - wheel->now) >= 0)
+	{
+		next = wheelNext(wheel);
+		if ((int32_t)(next - now) > 0)											// Nothing else to do up to now
+		{
+			wheel->now = now + 1;
+			break;
+		}
+		wheel->now = next;
+
+		index = INDEX(wheel->now, 0);
+		if (!index)
+			for (uint8_t level = 1; (level < WHEEL_LEVELS) && !cascade(wheel, level); level++) {}
+
+		pending = wheel->slots[0][index];										// Taken whole: what callbacks start now waits for the next tick
+		if (pending)
+			pending->pprev = &pending;											// Callbacks can still cancel the ones to go
+		wheel->slots[0][index] = NULL;
+		wheel->occupied &= ~(1ULL << index);
+		wheel->now++;
+
+		while ((expired = pending))
+		{
+			pending = expired->next;
+			if (pending)
+				pending->pprev = &pending;
+			expired->pprev = NULL;
+			if (expired->period)
+			{
+				expired->expires += expired->period;							// No drift, late ticks catch up one by one
+				link(wheel, expired);
+			}
+			else
+				wheel->count--;
+			expired->callback(expired->arg);									// Last: it may start or cancel this one
+			count++;
+		}
+	}
+
+	return count;
+}
+
+uint32_t wheelNext (const wheel_t* wheel)
+{
+	uint32_t index = INDEX(wheel->now, 0);
+	uint64_t ahead = wheel->occupied >> index;									// Rest of this level 0 lap
+
+	if (!wheel->count)
+		return wheel->now + WHEEL_RANGE;
+	if (index && ahead)
+		return wheel->now + __builtin_ctzll(ahead);
+	return (wheel->now + SLOT_MASK) & ~SLOT_MASK;								// Level 0 wraps, now if it is at the start: levels above move down
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void link (wheel_t* wheel, wheel_timer_t* timer)
+{
+	uint32_t delta = timer->expires - wheel->now, at = timer->expires;
+	uint8_t level = 0;
+
+	if ((int32_t)delta < 0)														// Past, the next tick run
+	{
+		delta = 0;
+		at = wheel->now;
+	}
+	else if (delta > WHEEL_RANGE)												// Too far, comes back down on the last level's lap
+	{
+		delta = WHEEL_RANGE;
+		at = wheel->now + WHEEL_RANGE;
+	}
+	while (delta >> (WHEEL_BITS * (level + 1)))
+		level++;
+
+	timer->level = level;
+	timer->slot = INDEX(at, level);
+	timer->next = wheel->slots[level][timer->slot];
+	if (timer->next)
+		timer->next->pprev = &timer->next;
+	timer->pprev = &wheel->slots[level][timer->slot];
+	wheel->slots[level][timer->slot] = timer;
+	if (!level)
+		wheel->occupied |= 1ULL << timer->slot;
+}
+
+static void unlink (wheel_t* wheel, wheel_timer_t* timer)
+{
+	*timer->pprev = timer->next;
+	if (timer->next)
+		timer->next->pprev = timer->pprev;
+	timer->pprev = NULL;
+	if (!timer->level && !wheel->slots[0][timer->slot])
+		wheel->occupied &= ~(1ULL << timer->slot);
+}
+
+static uint32_t cascade (wheel_t* wheel, uint8_t level)
+{
+	uint32_t index = INDEX(wheel->now, level);
+	wheel_timer_t* timer = wheel->slots[level][index];
+
+	wheel->slots[level][index] = NULL;
+	while (timer)
+	{
+		wheel_timer_t* moved = timer;
+
+		timer = timer->next;
+		link(wheel, moved);
+	}
+
+	return index;
+}
+
+/******************************************************************************/
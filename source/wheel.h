@@ -0,0 +1,132 @@
+/***************************************************************************//**
+  @file     wheel.h
+  @brief    Hierarchical timing wheel: O(1) start and cancel, callbacks run
+            as the wheel is advanced to the current tick
+  @author   Group 4: - Oms, Mariano
+                     - Solari Raigoso, Agustín
+                     - Wickham, Tomás
+                     - Vieira, Valentin Ulises
+  @note     WHEEL_LEVELS levels of WHEEL_SLOTS slots: a timer sits in the
+            level its delay fits and moves down as the lower level wraps,
+            at most once per level. Timers are caller-owned and linked in
+            place, nothing is allocated.
+ ******************************************************************************/
+
+#ifndef _WHEEL_H_
+#define _WHEEL_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define WHEEL_BITS			6													// Slots per level, log2
+#define WHEEL_SLOTS			(1U << WHEEL_BITS)
+#define WHEEL_LEVELS		4
+#define WHEEL_RANGE			((1UL << (WHEEL_BITS * WHEEL_LEVELS)) - 1)			// Longest delay in one go, longer ones go round again
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef void (* wheel_callback_t)(void* arg);
+
+/**
+ * @brief Timer, zeroed (static) before its first start
+ * @param next Next timer in the slot
+ * @param pprev Link pointing here, NULL when not running
+ * @param expires Tick it expires at
+ * @param period Ticks between expirations, 0 for one-shot
+ * @param callback Called once expired, may start or cancel any timer
+ * @param arg Callback argument
+ * @param level Level it sits in, to update the slot map on cancel
+ * @param slot Slot it sits in
+ */
+typedef struct wheel_timer {
+	struct wheel_timer*		next;
+	struct wheel_timer**	pprev;
+	uint32_t				expires;
+	uint32_t				period;
+	wheel_callback_t		callback;
+	void*					arg;
+	uint8_t					level;
+	uint8_t					slot;
+} wheel_timer_t;
+
+/**
+ * @brief Wheel
+ * @param now Next tick to run
+ * @param count Timers running
+ * @param occupied Level 0 slots holding timers, one bit each
+ * @param slots Timer lists
+ */
+typedef struct {
+	uint32_t		now;
+	uint32_t		count;
+	uint64_t		occupied;
+	wheel_timer_t*	slots[WHEEL_LEVELS][WHEEL_SLOTS];
+} wheel_t;
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Initialize a wheel, empty
+ * @param wheel Wheel
+ * @param now Current tick, the first one to run
+ */
+void wheelInit (wheel_t* wheel, uint32_t now);
+
+/**
+ * @brief Start a timer, restarting it if running
+ * @param wheel Wheel
+ * @param timer Timer
+ * @param expires Tick to expire at, the next tick run if already past
+ * @param period Ticks between expirations after the first, 0 for one-shot
+ * @param callback Called once expired
+ * @param arg Callback argument
+ */
+void wheelStart (wheel_t* wheel, wheel_timer_t* timer, uint32_t expires, uint32_t period, wheel_callback_t callback, void* arg);
+
+/**
+ * @brief Stop a timer
+ * @param wheel Wheel
+ * @param timer Timer
+ * @return It was running
+ */
+bool wheelCancel (wheel_t* wheel, wheel_timer_t* timer);
+
+/**
+ * @brief Check if a timer is running
+ * @param timer Timer
+ * @return Running
+ */
+bool wheelRunning (const wheel_timer_t* timer);
+
+/**
+ * @brief Run every tick up to now, expired timers call back
+ * @param wheel Wheel
+ * @param now Current tick
+ * @return Callbacks run
+ * @note Ticks without work are skipped, not walked
+ */
+uint32_t wheelAdvance (wheel_t* wheel, uint32_t now);
+
+/**
+ * @brief Get the first tick with work: a timer or moving timers down a level
+ * @param wheel Wheel
+ * @return Tick, no later than the first expiration
+ */
+uint32_t wheelNext (const wheel_t* wheel);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _WHEEL_H_